@@ -18,5 +18,7 @@ namespace ECS
         return Entity{world->entity(string.c_str())}.AddComponent<Transform>();
     }
 
+    Entity GetEntity(const uint64 id) { return Entity{flecs::entity{*world, id}}; }
+
     flecs::world& GetWorld() { return *world; }
 } // namespace ECS
\ No newline at end of file
@@ -3,11 +3,52 @@
 #include "Math.hpp"
 #include <flecs.h>
 
+#include <utility>
+
+namespace Spatial
+{
+    void MarkDirty(uint32 proxy);
+}
+
 class Transform
 {
   public:
     Transform() = default;
 
+    // A copy is another transform, it doesn't share the node of the original in the spatial hierarchy.
+    Transform(const Transform& other) : position{other.position}, rotation{other.rotation}, scale{other.scale}, matrix{other.matrix} {}
+
+    // The node belongs to the entity that is assigned to, it is kept and marked dirty.
+    Transform& operator=(const Transform& other)
+    {
+        position = other.position;
+        rotation = other.rotation;
+        scale = other.scale;
+        SetDirty();
+        return *this;
+    }
+
+    // Moves hand the node over, the ECS moves components between tables with them.
+    Transform(Transform&& other) noexcept :
+        position{other.position}, rotation{other.rotation}, scale{other.scale}, matrix{other.matrix},
+        spatial_proxy{std::exchange(other.spatial_proxy, NO_SPATIAL_PROXY)}
+    {
+    }
+
+    // The ECS fills the row of a removed entity by moving the last one into it, the row has no node then and takes over the one
+    // of the moved entity. A transform that has a node keeps it, like when it is copied to.
+    Transform& operator=(Transform&& other) noexcept
+    {
+        position = other.position;
+        rotation = other.rotation;
+        scale = other.scale;
+        matrix = other.matrix;
+
+        if (spatial_proxy == NO_SPATIAL_PROXY) { spatial_proxy = std::exchange(other.spatial_proxy, NO_SPATIAL_PROXY); }
+        else { SetDirty(); }
+        return *this;
+    }
+
     const Matrix4& GetMatrix() const
     {
         if (IsDirty())
@@ -44,8 +85,18 @@ class Transform
         SetDirty();
     }
 
+    static constexpr uint32 NO_SPATIAL_PROXY = ~0u;
+
+    // Node of this entity in the spatial hierarchy, only entities with a mesh have one (managed by the Spatial module).
+    [[nodiscard]] uint32 GetSpatialProxy() const { return spatial_proxy; }
+    void SetSpatialProxy(const uint32 proxy) { spatial_proxy = proxy; }
+
   private:
-    void SetDirty() const { matrix(3, 3) = 0.0f; }
+    void SetDirty() const
+    {
+        matrix(3, 3) = 0.0f;
+        if (spatial_proxy != NO_SPATIAL_PROXY) Spatial::MarkDirty(spatial_proxy);
+    }
     [[nodiscard]] bool IsDirty() const { return matrix(3, 3) == 0.0f; }
 
     float3 position{0.0f, 0.0f, 0.0f};
@@ -53,6 +104,8 @@ class Transform
     float3 scale{1.0f, 1.0f, 1.0f};
 
     mutable Matrix4 matrix{Math::Identity<Matrix4>()};
+
+    uint32 spatial_proxy{NO_SPATIAL_PROXY};
 };
 
 namespace ECS
@@ -64,6 +117,8 @@ namespace ECS
         Entity(flecs::entity&& entity) : flecs::entity{std::move(entity)} {}
 
         [[nodiscard]] std::string_view Name() const { return std::string_view{name().c_str(), name().size()}; }
+        [[nodiscard]] uint64 GetID() const { return id(); }
+        [[nodiscard]] bool IsValid() const { return is_valid(); }
 
         template <typename Type, typename... Args>
         const Entity& AddComponent(Args&&... args) const
@@ -79,6 +134,18 @@ namespace ECS
             return *this;
         }
 
+        template <typename Type>
+        void RemoveComponent() const
+        {
+            (void)remove<Type>();
+        }
+
+        template <typename Type>
+        [[nodiscard]] bool HasComponent() const
+        {
+            return has<Type>();
+        }
+
         template <typename Type>
         Type& GetComponent()
         {
@@ -98,5 +165,7 @@ namespace ECS
 
     Entity CreateEntity(const std::string& string);
 
+    [[nodiscard]] Entity GetEntity(uint64 id);
+
     [[nodiscard]] flecs::world& GetWorld();
 } // namespace ECS
\ No newline at end of file
@@ -0,0 +1,126 @@
+#include "Jobs.hpp"
+
+#include "Tools/Profiler.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace
+{
+    std::vector<std::thread> workers;
+
+    std::mutex mutex;
+    std::condition_variable work_available;
+    std::condition_variable work_done;
+
+    // Incremented for every ParallelFor(), lets sleeping workers know there is new work.
+    uint64 generation{0};
+    bool running{false};
+
+    const Jobs::RangeFunction* current_function{nullptr};
+    usize current_count{0};
+    usize current_batch_size{1};
+
+    std::atomic<usize> next_index{0};
+    std::atomic<uint32> active_workers{0};
+
+    void ExecuteRanges(const uint32 worker)
+    {
+        while (true)
+        {
+            const usize begin = next_index.fetch_add(current_batch_size);
+            if (begin >= current_count) return;
+
+            const usize end = std::min(begin + current_batch_size, current_count);
+            (*current_function)(begin, end, worker);
+        }
+    }
+
+    void WorkerLoop(const uint32 worker)
+    {
+        PROFILE_THREAD("Jobs worker");
+        uint64 last_generation = 0;
+
+        while (true)
+        {
+            {
+                std::unique_lock lock{mutex};
+                work_available.wait(lock, [&last_generation] { return !running || generation != last_generation; });
+
+                if (!running) return;
+                last_generation = generation;
+            }
+
+            {
+                PROFILE_ZONE("Jobs::ParallelFor");
+                ExecuteRanges(worker);
+            }
+
+            if (active_workers.fetch_sub(1) == 1)
+            {
+                std::lock_guard lock{mutex};
+                work_done.notify_one();
+            }
+        }
+    }
+} // namespace
+
+namespace Jobs
+{
+    void Init(uint32 worker_count)
+    {
+        if (worker_count == 0) worker_count = std::max(std::thread::hardware_concurrency(), 2u) - 1;
+
+        running = true;
+        workers.reserve(worker_count);
+        for (uint32 i = 0; i < worker_count; i++) { workers.emplace_back(WorkerLoop, i + 1); }
+    }
+
+    void Exit()
+    {
+        {
+            std::lock_guard lock{mutex};
+            running = false;
+        }
+        work_available.notify_all();
+
+        for (std::thread& worker : workers) { worker.join(); }
+        workers.clear();
+    }
+
+    uint32 GetWorkerCount() { return static_cast<uint32>(workers.size()) + 1; }
+
+    void ParallelFor(const usize count, const usize batch_size, const RangeFunction& function)
+    {
+        if (count == 0) return;
+
+        // Not worth waking up the workers for a single batch.
+        if (workers.empty() || count <= batch_size)
+        {
+            function(0, count, 0);
+            return;
+        }
+
+        {
+            std::lock_guard lock{mutex};
+            current_function = &function;
+            current_count = count;
+            current_batch_size = std::max<usize>(batch_size, 1);
+            next_index = 0;
+            active_workers = static_cast<uint32>(workers.size());
+            generation++;
+        }
+        work_available.notify_all();
+
+        ExecuteRanges(0);
+
+        // Workers might still be executing their last range, so wait until they all went back to sleep.
+        std::unique_lock lock{mutex};
+        work_done.wait(lock, [] { return active_workers == 0; });
+        current_function = nullptr;
+    }
+} // namespace Jobs
\ No newline at end of file
@@ -0,0 +1,22 @@
+#pragma once
+
+#include <functional>
+#include <Tools/Types.hpp>
+
+// Small thread pool for data parallel work on the main thread, like building draw lists.
+namespace Jobs
+{
+    // Called with a [begin, end) range and the index of the thread executing it, 0 is the calling thread.
+    using RangeFunction = std::function<void(usize begin, usize end, uint32 worker)>;
+
+    // Starts worker_count worker threads, 0 uses one less than the amount of hardware threads.
+    void Init(uint32 worker_count = 0);
+    void Exit();
+
+    // Amount of threads that execute work during ParallelFor(), including the calling thread.
+    [[nodiscard]] uint32 GetWorkerCount();
+
+    // Splits [0, count) into ranges of batch_size and executes them on all workers, returns when all ranges are done.
+    // Only one ParallelFor() can run at a time, ranges should not call it recursively.
+    void ParallelFor(usize count, usize batch_size, const RangeFunction& function);
+} // namespace Jobs
\ No newline at end of file
@@ -79,7 +79,7 @@ namespace Physics
         const Matrix4 view = Math::Inverse(camera_transform.GetMatrix());
         Renderer::SetUniform(1, view);
 
-        const Matrix4 projection = camera.GetProjection(*render_target);
+        const Matrix4 projection = camera.GetProjection(*GetTarget());
         Renderer::SetUniform(2, projection);
 
         for (const auto& [model, mesh] : debug_renderer->render_data)
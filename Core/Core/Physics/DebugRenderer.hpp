@@ -70,6 +70,7 @@ namespace Physics
         ~PhysicsDebugRenderPass() override = default;
 
         void Render() override;
+        [[nodiscard]] std::string_view GetName() const override { return "Physics debug"; }
     };
 
 } // namespace Physics
\ No newline at end of file
@@ -1,6 +1,7 @@
 #include "Physics.hpp"
 
 #include "Tools/Logging.hpp"
+#include "Tools/Profiler.hpp"
 #include "DebugRenderer.hpp"
 #include "Core/ECS.hpp"
 
@@ -299,12 +300,13 @@ namespace Physics
         );
 
         Handle<RenderPassInterface> debug_render_pass = std::make_shared<PhysicsDebugRenderPass>(graphics_pipeline, Renderer::main_target);
-        debug_render_pass->clear_render_targets = false;
         Renderer::render_passes.push_back(debug_render_pass);
+        Renderer::Instance().PrewarmPipeline(*debug_render_pass);
     }
 
     void Update(const float delta_time)
     {
+        PROFILE_ZONE("Physics::Update");
         JPH::BodyInterface& body_interface = physics_system.GetBodyInterface();
 
         const auto query = ECS::GetWorld().query_builder<Transform, const SphereCollider>().build();
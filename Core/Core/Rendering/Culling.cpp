@@ -0,0 +1,309 @@
+#include "Culling.hpp"
+
+#include "Tools/Logging.hpp"
+
+#include <bit>
+#include <chrono>
+#include <cmath>
+#include <random>
+
+#if defined(__AVX__)
+    #include <immintrin.h>
+    #define CULLING_AVX
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+    #include <emmintrin.h>
+    #define CULLING_SSE
+#endif
+
+namespace
+{
+    float4 NormalizePlane(const float4& plane) { return plane / plane.head<3>().norm(); }
+
+    bool SphereInside(const float4 (&planes)[Frustum::PLANE_COUNT], const float x, const float y, const float z, const float radius)
+    {
+        for (const float4& plane : planes)
+        {
+            if (plane.x() * x + plane.y() * y + plane.z() * z + plane.w() < -radius) return false;
+        }
+        return true;
+    }
+
+    void CullSpheresRange(const Frustum& frustum, const Culling::SphereBatch& batch, const usize begin, std::vector<uint32>& visible_indices)
+    {
+        for (usize i = begin; i < batch.Size(); i++)
+        {
+            if (SphereInside(frustum.planes, batch.x[i], batch.y[i], batch.z[i], batch.radius[i]))
+            {
+                visible_indices.push_back(static_cast<uint32>(i));
+            }
+        }
+    }
+} // namespace
+
+Frustum Frustum::FromMatrix(const Matrix4& view_projection, const bool zero_to_one_depth)
+{
+    // With row vectors clip = point * matrix, so each clip space component is the dot product with a matrix column.
+    const float4 x = view_projection.col(0).transpose();
+    const float4 y = view_projection.col(1).transpose();
+    const float4 z = view_projection.col(2).transpose();
+    const float4 w = view_projection.col(3).transpose();
+
+    Frustum frustum;
+    frustum.planes[LEFT_PLANE] = NormalizePlane(w + x);
+    frustum.planes[RIGHT_PLANE] = NormalizePlane(w - x);
+    frustum.planes[BOTTOM_PLANE] = NormalizePlane(w + y);
+    frustum.planes[TOP_PLANE] = NormalizePlane(w - y);
+    frustum.planes[NEAR_PLANE] = NormalizePlane(zero_to_one_depth ? z : w + z);
+    frustum.planes[FAR_PLANE] = NormalizePlane(w - z);
+
+    return frustum;
+}
+
+bool Frustum::Intersects(const BoundingSphere& sphere) const
+{
+    return SphereInside(planes, sphere.center.x(), sphere.center.y(), sphere.center.z(), sphere.radius);
+}
+
+bool Frustum::Intersects(const BoundingBox& box) const
+{
+    const float3 center = box.GetCenter();
+    const float3 extents = box.GetExtents();
+
+    for (const float4& plane : planes)
+    {
+        const float3 normal = plane.head<3>();
+        const float radius = extents.dot(normal.cwiseAbs());
+        if (normal.dot(center) + plane.w() < -radius) return false;
+    }
+    return true;
+}
+
+namespace Culling
+{
+    void SphereBatch::Clear()
+    {
+        x.clear();
+        y.clear();
+        z.clear();
+        radius.clear();
+    }
+
+    void SphereBatch::Reserve(const usize count)
+    {
+        x.reserve(count);
+        y.reserve(count);
+        z.reserve(count);
+        radius.reserve(count);
+    }
+
+    void SphereBatch::Add(const BoundingSphere& sphere)
+    {
+        x.push_back(sphere.center.x());
+        y.push_back(sphere.center.y());
+        z.push_back(sphere.center.z());
+        radius.push_back(sphere.radius);
+    }
+
+    BoundingBox ComputeBoundingBox(const float3* positions, const usize count, const usize stride)
+    {
+        if (count == 0) return {};
+
+        const auto* bytes = reinterpret_cast<const uint8*>(positions);
+
+        BoundingBox box{*positions, *positions};
+        for (usize i = 1; i < count; i++)
+        {
+            const float3& position = *reinterpret_cast<const float3*>(bytes + i * stride);
+            box.min = box.min.cwiseMin(position);
+            box.max = box.max.cwiseMax(position);
+        }
+
+        return box;
+    }
+
+    BoundingSphere ComputeBoundingSphere(const BoundingBox& box, const float3* positions, const usize count, const usize stride)
+    {
+        const auto* bytes = reinterpret_cast<const uint8*>(positions);
+
+        // Centering on the box and taking the furthest vertex is tighter than using the box diagonal for most meshes.
+        BoundingSphere sphere{box.GetCenter(), 0.0f};
+        for (usize i = 0; i < count; i++)
+        {
+            const float3& position = *reinterpret_cast<const float3*>(bytes + i * stride);
+            sphere.radius = Math::Max(sphere.radius, (position - sphere.center).squaredNorm());
+        }
+        sphere.radius = std::sqrt(sphere.radius);
+
+        return sphere;
+    }
+
+    BoundingSphere TransformSphere(const BoundingSphere& sphere, const Matrix4& matrix)
+    {
+        const float scale_squared = Math::Max(
+            matrix.row(0).head<3>().squaredNorm(), Math::Max(matrix.row(1).head<3>().squaredNorm(), matrix.row(2).head<3>().squaredNorm())
+        );
+
+        return BoundingSphere{Math::TransformPoint(sphere.center, matrix), sphere.radius * std::sqrt(scale_squared)};
+    }
+
+    BoundingBox TransformBox(const BoundingBox& box, const Matrix4& matrix)
+    {
+        const float3 center = Math::TransformPoint(box.GetCenter(), matrix);
+        const float3 extents = box.GetExtents() * matrix.topLeftCorner<3, 3>().cwiseAbs();
+
+        return BoundingBox{center - extents, center + extents};
+    }
+
+    usize CullSpheres(const Frustum& frustum, const SphereBatch& batch, std::vector<uint32>& visible_indices)
+    {
+        visible_indices.clear();
+        const usize count = batch.Size();
+        usize index = 0;
+
+#if defined(CULLING_AVX)
+        __m256 plane_x[Frustum::PLANE_COUNT];
+        __m256 plane_y[Frustum::PLANE_COUNT];
+        __m256 plane_z[Frustum::PLANE_COUNT];
+        __m256 plane_w[Frustum::PLANE_COUNT];
+        for (usize i = 0; i < Frustum::PLANE_COUNT; i++)
+        {
+            plane_x[i] = _mm256_set1_ps(frustum.planes[i].x());
+            plane_y[i] = _mm256_set1_ps(frustum.planes[i].y());
+            plane_z[i] = _mm256_set1_ps(frustum.planes[i].z());
+            plane_w[i] = _mm256_set1_ps(frustum.planes[i].w());
+        }
+
+        const __m256 sign_mask = _mm256_set1_ps(-0.0f);
+        for (; index + 8 <= count; index += 8)
+        {
+            const __m256 x = _mm256_loadu_ps(&batch.x[index]);
+            const __m256 y = _mm256_loadu_ps(&batch.y[index]);
+            const __m256 z = _mm256_loadu_ps(&batch.z[index]);
+            const __m256 negative_radius = _mm256_xor_ps(_mm256_loadu_ps(&batch.radius[index]), sign_mask);
+
+            __m256 inside = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+            for (usize i = 0; i < Frustum::PLANE_COUNT; i++)
+            {
+                __m256 distance = _mm256_add_ps(_mm256_mul_ps(plane_x[i], x), plane_w[i]);
+                distance = _mm256_add_ps(_mm256_mul_ps(plane_y[i], y), distance);
+                distance = _mm256_add_ps(_mm256_mul_ps(plane_z[i], z), distance);
+                inside = _mm256_and_ps(inside, _mm256_cmp_ps(distance, negative_radius, _CMP_GE_OQ));
+            }
+
+            uint32 mask = static_cast<uint32>(_mm256_movemask_ps(inside));
+            while (mask != 0)
+            {
+                const uint32 bit = std::countr_zero(mask);
+                visible_indices.push_back(static_cast<uint32>(index + bit));
+                mask &= mask - 1;
+            }
+        }
+#elif defined(CULLING_SSE)
+        __m128 plane_x[Frustum::PLANE_COUNT];
+        __m128 plane_y[Frustum::PLANE_COUNT];
+        __m128 plane_z[Frustum::PLANE_COUNT];
+        __m128 plane_w[Frustum::PLANE_COUNT];
+        for (usize i = 0; i < Frustum::PLANE_COUNT; i++)
+        {
+            plane_x[i] = _mm_set1_ps(frustum.planes[i].x());
+            plane_y[i] = _mm_set1_ps(frustum.planes[i].y());
+            plane_z[i] = _mm_set1_ps(frustum.planes[i].z());
+            plane_w[i] = _mm_set1_ps(frustum.planes[i].w());
+        }
+
+        const __m128 sign_mask = _mm_set1_ps(-0.0f);
+        for (; index + 4 <= count; index += 4)
+        {
+            const __m128 x = _mm_loadu_ps(&batch.x[index]);
+            const __m128 y = _mm_loadu_ps(&batch.y[index]);
+            const __m128 z = _mm_loadu_ps(&batch.z[index]);
+            const __m128 negative_radius = _mm_xor_ps(_mm_loadu_ps(&batch.radius[index]), sign_mask);
+
+            __m128 inside = _mm_castsi128_ps(_mm_set1_epi32(-1));
+            for (usize i = 0; i < Frustum::PLANE_COUNT; i++)
+            {
+                __m128 distance = _mm_add_ps(_mm_mul_ps(plane_x[i], x), plane_w[i]);
+                distance = _mm_add_ps(_mm_mul_ps(plane_y[i], y), distance);
+                distance = _mm_add_ps(_mm_mul_ps(plane_z[i], z), distance);
+                inside = _mm_and_ps(inside, _mm_cmpge_ps(distance, negative_radius));
+            }
+
+            uint32 mask = static_cast<uint32>(_mm_movemask_ps(inside));
+            while (mask != 0)
+            {
+                const uint32 bit = std::countr_zero(mask);
+                visible_indices.push_back(static_cast<uint32>(index + bit));
+                mask &= mask - 1;
+            }
+        }
+#endif
+
+        // Handle the remaining spheres that don't fill a whole SIMD register (or all of them without SIMD support).
+        CullSpheresRange(frustum, batch, index, visible_indices);
+
+        return visible_indices.size();
+    }
+
+    usize CullSpheresScalar(const Frustum& frustum, const SphereBatch& batch, std::vector<uint32>& visible_indices)
+    {
+        visible_indices.clear();
+        CullSpheresRange(frustum, batch, 0, visible_indices);
+
+        return visible_indices.size();
+    }
+
+    void RunBenchmark(const usize object_count, const uint32 iterations)
+    {
+        using Timer = std::chrono::high_resolution_clock;
+        using milliseconds = std::chrono::duration<float, std::milli>;
+
+        std::mt19937 generator{1337};
+        std::uniform_real_distribution position_distribution{-500.0f, 500.0f};
+        std::uniform_real_distribution radius_distribution{0.5f, 5.0f};
+
+        SphereBatch batch;
+        batch.Reserve(object_count);
+        for (usize i = 0; i < object_count; i++)
+        {
+            const float3 center{position_distribution(generator), position_distribution(generator), position_distribution(generator)};
+            batch.Add(BoundingSphere{center, radius_distribution(generator)});
+        }
+
+        const Matrix4 view = Math::LookAt(float3{0.0f, 0.0f, 0.0f}, Math::FORWARD, Math::UP);
+        const Matrix4 projection = Math::PerspectiveZO(Math::ToRadians(45.0f), 16.0f / 9.0f, 0.1f, 1000.0f);
+        const Frustum frustum = Frustum::FromMatrix(view * projection, true);
+
+        std::vector<uint32> visible_indices;
+        visible_indices.reserve(object_count);
+
+        usize scalar_visible = 0;
+        const auto scalar_start = Timer::now();
+        for (uint32 i = 0; i < iterations; i++)
+        {
+            scalar_visible = CullSpheresScalar(frustum, batch, visible_indices);
+        }
+        const float scalar_time = std::chrono::duration_cast<milliseconds>(Timer::now() - scalar_start).count() / static_cast<float>(iterations);
+
+        usize simd_visible = 0;
+        const auto simd_start = Timer::now();
+        for (uint32 i = 0; i < iterations; i++)
+        {
+            simd_visible = CullSpheres(frustum, batch, visible_indices);
+        }
+        const float simd_time = std::chrono::duration_cast<milliseconds>(Timer::now() - simd_start).count() / static_cast<float>(iterations);
+
+#if defined(CULLING_AVX)
+        constexpr const char* simd_name = "AVX";
+#elif defined(CULLING_SSE)
+        constexpr const char* simd_name = "SSE";
+#else
+        constexpr const char* simd_name = "none";
+#endif
+
+        Log::Log(
+            "Culling benchmark: {} objects, {} visible, scalar: {:.3f} ms, SIMD ({}): {:.3f} ms, speedup: {:.2f}x", object_count,
+            simd_visible, scalar_time, simd_name, simd_time, scalar_time / simd_time
+        );
+        if (scalar_visible != simd_visible) Log::Error("Culling benchmark mismatch, scalar: {}, SIMD: {}", scalar_visible, simd_visible);
+    }
+} // namespace Culling
\ No newline at end of file
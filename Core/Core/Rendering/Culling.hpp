@@ -0,0 +1,92 @@
+#pragma once
+
+#include "Core/Math.hpp"
+#include "Tools/Types.hpp"
+
+#include <vector>
+
+struct BoundingBox
+{
+    [[nodiscard]] float3 GetCenter() const { return (min + max) * 0.5f; }
+    [[nodiscard]] float3 GetExtents() const { return (max - min) * 0.5f; }
+
+    float3 min{0.0f, 0.0f, 0.0f};
+    float3 max{0.0f, 0.0f, 0.0f};
+};
+
+struct BoundingSphere
+{
+    float3 center{0.0f, 0.0f, 0.0f};
+    float radius{0.0f};
+};
+
+class Frustum
+{
+  public:
+    enum Plane : uint8
+    {
+        LEFT_PLANE,
+        RIGHT_PLANE,
+        BOTTOM_PLANE,
+        TOP_PLANE,
+        NEAR_PLANE,
+        FAR_PLANE,
+        PLANE_COUNT
+    };
+
+    // Extracts the (normalized) planes from a row vector view * projection matrix, zero_to_one_depth is false for OpenGL style clip space.
+    static Frustum FromMatrix(const Matrix4& view_projection, bool zero_to_one_depth);
+
+    [[nodiscard]] bool Intersects(const BoundingSphere& sphere) const;
+    [[nodiscard]] bool Intersects(const BoundingBox& box) const;
+
+    // Plane normals point inwards, a point is inside when dot(normal, point) + w >= 0 for all planes.
+    float4 planes[PLANE_COUNT];
+};
+
+namespace Culling
+{
+    struct Statistics
+    {
+        uint32 visible{0};
+        uint32 culled{0};
+        // Amount of bounding volumes tested against the frustum, hierarchical culling doesn't need to test every object.
+        uint32 tests{0};
+        // Inside the frustum but hidden behind occluders, not counted as visible.
+        uint32 occluded{0};
+    };
+
+    // Bounding spheres stored as a structure of arrays, so they can be tested 4 (SSE) or 8 (AVX) at a time.
+    class SphereBatch
+    {
+      public:
+        void Clear();
+        void Reserve(usize count);
+        void Add(const BoundingSphere& sphere);
+
+        [[nodiscard]] usize Size() const { return radius.size(); }
+
+        std::vector<float> x;
+        std::vector<float> y;
+        std::vector<float> z;
+        std::vector<float> radius;
+    };
+
+    [[nodiscard]] BoundingBox ComputeBoundingBox(const float3* positions, usize count, usize stride = sizeof(float3));
+    [[nodiscard]] BoundingSphere ComputeBoundingSphere(const BoundingBox& box, const float3* positions, usize count, usize stride = sizeof(float3));
+
+    // Transforms a local space sphere to world space, the radius is scaled by the largest axis scale of the matrix.
+    [[nodiscard]] BoundingSphere TransformSphere(const BoundingSphere& sphere, const Matrix4& matrix);
+    // Transforms a local space box to the world space box that encloses it.
+    [[nodiscard]] BoundingBox TransformBox(const BoundingBox& box, const Matrix4& matrix);
+
+    /// @brief Tests all spheres in the batch against the frustum using the widest available SIMD instructions.
+    /// @return Amount of visible spheres, the indices of which are written to visible_indices.
+    usize CullSpheres(const Frustum& frustum, const SphereBatch& batch, std::vector<uint32>& visible_indices);
+
+    // Scalar version of CullSpheres(), used as a baseline to compare against.
+    usize CullSpheresScalar(const Frustum& frustum, const SphereBatch& batch, std::vector<uint32>& visible_indices);
+
+    // Culls a randomly generated scene of object_count spheres with both the scalar and SIMD path and logs the timings.
+    void RunBenchmark(usize object_count, uint32 iterations = 10);
+} // namespace Culling
\ No newline at end of file
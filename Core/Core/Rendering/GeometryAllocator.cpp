@@ -0,0 +1,104 @@
+#include "GeometryAllocator.hpp"
+
+#include "Renderer.hpp"
+
+#include <algorithm>
+
+void GeometryAllocator::Reset(const uint32 vertex_capacity, const uint32 index_capacity)
+{
+    vertices.Reset(vertex_capacity);
+    indices.Reset(index_capacity);
+    owners.clear();
+}
+
+bool GeometryAllocator::Allocate(Mesh& mesh)
+{
+    const OffsetAllocator::Allocation vertex_allocation = vertices.Allocate(mesh.GetVerticesCount());
+    if (vertex_allocation.offset == OffsetAllocator::NONE) return false;
+
+    const OffsetAllocator::Allocation index_allocation = indices.Allocate(mesh.GetIndicesCount());
+    if (index_allocation.offset == OffsetAllocator::NONE)
+    {
+        vertices.Free(vertex_allocation.node);
+        return false;
+    }
+
+    mesh.vertex_allocation = vertex_allocation.node;
+    mesh.index_allocation = index_allocation.node;
+    mesh.base_vertex = static_cast<sint32>(vertex_allocation.offset);
+    mesh.first_index = index_allocation.offset;
+
+    if (owners.size() <= vertex_allocation.node) owners.resize(vertex_allocation.node + 1, nullptr);
+    owners[vertex_allocation.node] = &mesh;
+
+    return true;
+}
+
+GeometryAllocator::Ranges GeometryAllocator::Detach(Mesh& mesh)
+{
+    if (!IsAllocated(mesh)) return {};
+
+    const Ranges ranges{mesh.vertex_allocation, mesh.index_allocation};
+    owners[mesh.vertex_allocation] = nullptr;
+
+    mesh.vertex_allocation = OffsetAllocator::NONE;
+    mesh.index_allocation = OffsetAllocator::NONE;
+
+    return ranges;
+}
+
+void GeometryAllocator::Free(const Ranges& ranges)
+{
+    if (ranges.vertex_node == OffsetAllocator::NONE) return;
+
+    vertices.Free(ranges.vertex_node);
+    indices.Free(ranges.index_node);
+}
+
+bool GeometryAllocator::IsAllocated(const Mesh& mesh) { return mesh.vertex_allocation != OffsetAllocator::NONE; }
+
+bool GeometryAllocator::FitsAfterDefragment(const Mesh& mesh) const
+{
+    return vertices.GetCapacity() - vertices.GetUsed() >= std::max(mesh.GetVerticesCount(), 1u) &&
+           indices.GetCapacity() - indices.GetUsed() >= std::max(mesh.GetIndicesCount(), 1u);
+}
+
+std::pair<uint32, uint32> GeometryAllocator::GetGrownCapacities(const Mesh& mesh) const
+{
+    // Both buffers grow together, so meshes with few vertices but many indices don't need a second resize.
+    const uint32 vertex_capacity = vertices.GetCapacity();
+    const uint32 index_capacity = indices.GetCapacity();
+
+    return {
+        std::max(vertex_capacity * 2, vertex_capacity + mesh.GetVerticesCount()),
+        std::max(index_capacity * 2, index_capacity + mesh.GetIndicesCount())
+    };
+}
+
+void GeometryAllocator::Grow(const uint32 vertex_capacity, const uint32 index_capacity)
+{
+    vertices.Grow(vertex_capacity);
+    indices.Grow(index_capacity);
+
+    statistics.grows++;
+}
+
+void GeometryAllocator::Defragment(
+    std::vector<OffsetAllocator::Relocation>& vertex_moves, std::vector<OffsetAllocator::Relocation>& index_moves
+)
+{
+    vertices.Defragment(vertex_moves);
+    indices.Defragment(index_moves);
+
+    for (Mesh* mesh : owners)
+    {
+        if (mesh == nullptr) continue;
+
+        mesh->base_vertex = static_cast<sint32>(vertices.GetOffset(mesh->vertex_allocation));
+        mesh->first_index = indices.GetOffset(mesh->index_allocation);
+    }
+
+    statistics.defragmentations++;
+    for (const OffsetAllocator::Relocation& move : vertex_moves) { statistics.moved_vertices += move.size; }
+    for (const OffsetAllocator::Relocation& move : index_moves) { statistics.moved_indices += move.size; }
+}
\ No newline at end of file
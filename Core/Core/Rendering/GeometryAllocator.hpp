@@ -0,0 +1,69 @@
+#pragma once
+
+#include "Tools/OffsetAllocator.hpp"
+
+#include <utility>
+#include <vector>
+
+class Mesh;
+
+// Places the vertices and indices of all meshes in one shared vertex buffer and one shared index buffer.
+// The backend owns the buffers and copies the data, this only decides where in the buffers every mesh lives.
+// Offsets and capacities are counted in vertices and indices, not bytes.
+class GeometryAllocator
+{
+  public:
+    static constexpr uint32 INITIAL_VERTEX_CAPACITY = 256 * 1024;
+    static constexpr uint32 INITIAL_INDEX_CAPACITY = 3 * INITIAL_VERTEX_CAPACITY;
+
+    // Vertex and index allocations of a mesh.
+    struct Ranges
+    {
+        uint32 vertex_node{OffsetAllocator::NONE};
+        uint32 index_node{OffsetAllocator::NONE};
+    };
+
+    struct Statistics
+    {
+        uint32 defragmentations{0};
+        uint32 grows{0};
+        // Vertices and indices copied by defragmentations.
+        uint64 moved_vertices{0};
+        uint64 moved_indices{0};
+    };
+
+    // Frees all meshes and resizes the buffers.
+    void Reset(uint32 vertex_capacity = INITIAL_VERTEX_CAPACITY, uint32 index_capacity = INITIAL_INDEX_CAPACITY);
+
+    /// @brief Assigns the base vertex and first index of the mesh.
+    /// @return False when the buffers are too small or too fragmented, the backend needs to call Grow() or Defragment() and retry.
+    bool Allocate(Mesh& mesh);
+    void Free(Mesh& mesh) { Free(Detach(mesh)); }
+    // Removes the ranges from the mesh without freeing them, so frames still in flight can keep reading them until Free().
+    Ranges Detach(Mesh& mesh);
+    void Free(const Ranges& ranges);
+    [[nodiscard]] static bool IsAllocated(const Mesh& mesh);
+
+    // Whether the free space would fit the mesh after Defragment(), otherwise the buffers need to grow.
+    [[nodiscard]] bool FitsAfterDefragment(const Mesh& mesh) const;
+    // Capacities to grow the buffers to so the mesh fits, at least doubles them to keep the amount of copies low.
+    [[nodiscard]] std::pair<uint32, uint32> GetGrownCapacities(const Mesh& mesh) const;
+
+    // The backend copies the existing contents to buffers of the new capacities before or after calling this, offsets don't change.
+    void Grow(uint32 vertex_capacity, uint32 index_capacity);
+    // Packs all meshes to the start of the buffers and updates their offsets, the ranges to copy are added to the moves.
+    void Defragment(std::vector<OffsetAllocator::Relocation>& vertex_moves, std::vector<OffsetAllocator::Relocation>& index_moves);
+
+    [[nodiscard]] const OffsetAllocator& GetVertices() const { return vertices; }
+    [[nodiscard]] const OffsetAllocator& GetIndices() const { return indices; }
+    [[nodiscard]] const Statistics& GetStatistics() const { return statistics; }
+
+  private:
+    OffsetAllocator vertices;
+    OffsetAllocator indices;
+
+    // Mesh of every vertex allocation, used to update the offsets after defragmenting.
+    std::vector<Mesh*> owners;
+
+    Statistics statistics;
+};
\ No newline at end of file
@@ -0,0 +1,136 @@
+#include "GpuCulling.hpp"
+
+#include "Core/ECS.hpp"
+#include "Core/Spatial.hpp"
+
+#include <algorithm>
+#include <bit>
+
+namespace
+{
+    // Storage buffers have a fixed size, so a buffer that is too small is replaced by a larger one with the same name.
+    void Reserve(Handle<StorageBuffer>& buffer, const std::string& name, const usize size, const StorageBuffer::Flags flags)
+    {
+        if (buffer != nullptr && buffer->GetSize() >= size) return;
+
+        if (buffer != nullptr)
+        {
+            const uint64 id = buffer->Resource::GetID();
+            buffer.reset();
+            Resource::TryDestroyResource(id);
+        }
+
+        // Grown to the next power of two, so adding entities one by one doesn't recreate the buffer every frame.
+        buffer = Resource::Load<StorageBuffer>(name, std::bit_ceil(size), flags);
+    }
+} // namespace
+
+void GpuCulling::Update()
+{
+    const uint64 spatial_version = Spatial::GetVersion();
+    if (spatial_version == version && complete) return;
+
+    version = spatial_version;
+    complete = true;
+
+    entities.clear();
+    const auto mesh_query = ECS::GetWorld().query_builder<const Transform, const Handle<Mesh>>().build();
+    mesh_query.each([this](const Transform& transform, const Handle<Mesh>& mesh) {
+        if (!GeometryAllocator::IsAllocated(*mesh)) return;
+
+        // The arguments point straight into the shared geometry buffers, which don't hold the mesh until it is uploaded.
+        if (!mesh->resident)
+        {
+            complete = false;
+            return;
+        }
+
+        entities.push_back(DrawCommand{transform.GetMatrix(), mesh.get()});
+    });
+
+    // Instances of the same mesh are next to each other so they share one draw, meshes with the same textures share a group.
+    // Sorted by all textures of the mesh, the same comparison the groups are split by.
+    std::ranges::sort(entities, [](const DrawCommand& a, const DrawCommand& b) {
+        return a.mesh->textures != b.mesh->textures ? a.mesh->textures < b.mesh->textures : std::less{}(a.mesh, b.mesh);
+    });
+
+    instances.clear();
+    arguments.clear();
+    groups.clear();
+    for (usize i = 0; i < entities.size(); i++)
+    {
+        const DrawCommand& entity = entities[i];
+        const Mesh& mesh = *entity.mesh;
+
+        if (i == 0 || entities[i - 1].mesh != entity.mesh)
+        {
+            if (groups.empty() || groups.back().mesh->textures != mesh.textures)
+            {
+                groups.push_back(Group{&mesh, static_cast<uint32>(arguments.size()), 0});
+            }
+            groups.back().draw_count++;
+
+            // The instance count is counted by the culling shader, the instances of the mesh start at first_instance.
+            arguments.push_back(IndexedIndirectArguments{
+                .index_count = mesh.GetIndicesCount(),
+                .instance_count = 0,
+                .first_index = mesh.first_index,
+                .base_vertex = mesh.base_vertex,
+                .first_instance = static_cast<uint32>(i)
+            });
+        }
+
+        const BoundingSphere sphere = Culling::TransformSphere(mesh.GetBoundingSphere(), entity.model);
+        const BoundingBox box = Culling::TransformBox(mesh.GetBoundingBox(), entity.model);
+        instances.push_back(Instance{
+            .model = entity.model,
+            .sphere = float4{sphere.center.x(), sphere.center.y(), sphere.center.z(), sphere.radius},
+            .box_min = float4{box.min.x(), box.min.y(), box.min.z(), 0.0f},
+            .box_max = box.max,
+            .draw = static_cast<uint32>(arguments.size() - 1)
+        });
+    }
+
+    if (instances.empty()) return;
+
+    const auto arguments_flags = static_cast<StorageBuffer::Flags>(StorageBuffer::COMPUTE_WRITE | StorageBuffer::INDIRECT);
+    const auto models_flags = static_cast<StorageBuffer::Flags>(StorageBuffer::COMPUTE_WRITE | StorageBuffer::VERTEX);
+
+    Reserve(instances_buffer, "GpuCulling.Instances", instances.size() * sizeof(Instance), StorageBuffer::COMPUTE_READ);
+    Reserve(arguments_buffer, "GpuCulling.Arguments", arguments.size() * sizeof(IndexedIndirectArguments), arguments_flags);
+    Reserve(visible_models_buffer, "GpuCulling.VisibleModels", instances.size() * sizeof(Matrix4), models_flags);
+
+    instances_buffer->Update(instances.data(), instances.size() * sizeof(Instance));
+}
+
+void GpuCulling::Dispatch(
+    const ComputeShaderPipeline& pipeline, const Frustum& frustum, const Matrix4& view_projection, const OcclusionBuffer* occlusion_buffer
+)
+{
+    if (instances.empty()) return;
+
+    // Bound even when occlusion culling is disabled, every binding of the shader needs a buffer.
+    Reserve(pyramid_buffer, "GpuCulling.Pyramid", OcclusionBuffer::PYRAMID_SIZE * sizeof(float), StorageBuffer::COMPUTE_READ);
+
+    CullingData data{
+        .view_projection = view_projection, .instance_count = static_cast<uint32>(instances.size()), .occlusion = 0, .padding = {}
+    };
+    std::ranges::copy(frustum.planes, data.planes);
+
+    if (occlusion_buffer != nullptr)
+    {
+        occlusion_buffer->BuildPyramid(pyramid);
+        pyramid_buffer->Update(pyramid.data(), pyramid.size() * sizeof(float));
+        data.occlusion = 1;
+    }
+
+    // The template with all instance counts at 0 is uploaded every frame, the shader counts the visible instances into it.
+    arguments_buffer->Update(arguments.data(), arguments.size() * sizeof(IndexedIndirectArguments));
+    Renderer::SetUniform(0, data, Renderer::COMPUTE_STAGE);
+
+    const StorageBinding bindings[]{
+        {instances_buffer.get(), false}, {pyramid_buffer.get(), false}, {arguments_buffer.get(), true}, {visible_models_buffer.get(), true}
+    };
+    const auto group_count = static_cast<uint32>((instances.size() + THREAD_COUNT - 1) / THREAD_COUNT);
+    Renderer::Instance().Dispatch(pipeline, bindings, group_count, 1, 1);
+}
\ No newline at end of file
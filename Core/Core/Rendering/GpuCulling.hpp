@@ -0,0 +1,78 @@
+#pragma once
+
+#include "Renderer.hpp"
+#include "OcclusionBuffer.hpp"
+
+#include <vector>
+
+// Culls every mesh entity on the GPU: a compute pass tests the instances against the frustum and the Hi-Z pyramid of the occlusion
+// buffer, and appends the survivors to the indirect draw arguments of their mesh, which are then drawn without reading them back.
+// The instances are only gathered again when Spatial reports a change, so the CPU doesn't walk the entities of a static scene.
+class GpuCulling
+{
+  public:
+    // Has to match [numthreads] of GpuCulling.slang.
+    static constexpr uint32 THREAD_COUNT = 64;
+
+    // Meshes sharing their textures, drawn with one indirect draw of draw_count arguments.
+    struct Group
+    {
+        const Mesh* mesh;
+        uint32 first_draw;
+        uint32 draw_count;
+    };
+
+    // Gathers the instances again when an entity with a mesh was added, removed or moved since the last call.
+    void Update();
+    // Resets the instance counts of the arguments and dispatches the culling, needs to be recorded outside of render passes.
+    // The occlusion buffer is optional and needs to be rasterized already.
+    void Dispatch(
+        const ComputeShaderPipeline& pipeline, const Frustum& frustum, const Matrix4& view_projection,
+        const OcclusionBuffer* occlusion_buffer
+    );
+
+    [[nodiscard]] const std::vector<Group>& GetGroups() const { return groups; }
+    // IndexedIndirectArguments of every mesh, filled by the last dispatch.
+    [[nodiscard]] const StorageBuffer& GetArguments() const { return *arguments_buffer; }
+    // Model matrices of the visible instances, every mesh owns the range starting at the first_instance of its arguments.
+    [[nodiscard]] const StorageBuffer& GetVisibleModels() const { return *visible_models_buffer; }
+
+    [[nodiscard]] uint32 GetInstanceCount() const { return static_cast<uint32>(instances.size()); }
+    [[nodiscard]] uint32 GetDrawCount() const { return static_cast<uint32>(arguments.size()); }
+
+  private:
+    // Same layout as Instance in GpuCulling.slang, the bounds are in world space.
+    struct Instance
+    {
+        Matrix4 model;
+        float4 sphere;
+        float4 box_min;
+        float3 box_max;
+        uint32 draw;
+    };
+
+    // Same layout as CullingData in GpuCulling.slang.
+    struct CullingData
+    {
+        float4 planes[Frustum::PLANE_COUNT];
+        Matrix4 view_projection;
+        uint32 instance_count;
+        uint32 occlusion;
+        uint32 padding[2];
+    };
+
+    uint64 version{~0ull};
+    // Cleared when meshes were skipped because they aren't uploaded yet, they are gathered again the next frame.
+    bool complete{false};
+
+    std::vector<DrawCommand> entities;
+    std::vector<Instance> instances;
+    std::vector<IndexedIndirectArguments> arguments;
+    std::vector<Group> groups;
+    std::vector<float> pyramid;
+
+    Handle<StorageBuffer> instances_buffer;
+    Handle<StorageBuffer> arguments_buffer;
+    Handle<StorageBuffer> visible_models_buffer;
+    Handle<StorageBuffer> pyramid_buffer;
+};
\ No newline at end of file
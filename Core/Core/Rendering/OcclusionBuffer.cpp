@@ -0,0 +1,399 @@
+#include "OcclusionBuffer.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#if defined(__AVX__)
+    #include <immintrin.h>
+    #define OCCLUSION_AVX
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+    #include <emmintrin.h>
+    #define OCCLUSION_SSE
+#endif
+
+namespace
+{
+    // Triangles with a vertex this close to the camera plane would need to be clipped, they are skipped instead.
+    constexpr float MIN_W = 1e-3f;
+    // Boxes are only occluded when the buffer is closer by this fraction of 1 / w, so occluders don't hide their own meshes
+    // when the box and the occluder surface are at the same depth.
+    constexpr float DEPTH_BIAS = 1e-3f;
+
+    float ToScreenX(const float x, const float w) { return (x / w * 0.5f + 0.5f) * static_cast<float>(OcclusionBuffer::WIDTH); }
+    float ToScreenY(const float y, const float w) { return (0.5f - y / w * 0.5f) * static_cast<float>(OcclusionBuffer::HEIGHT); }
+} // namespace
+
+Occluder Occluder::FromBox(const BoundingBox& box)
+{
+    Occluder occluder;
+    for (uint32 corner = 0; corner < 8; corner++)
+    {
+        occluder.positions.emplace_back(
+            corner & 1 ? box.max.x() : box.min.x(), corner & 2 ? box.max.y() : box.min.y(), corner & 4 ? box.max.z() : box.min.z()
+        );
+    }
+
+    // Two triangles per face, the winding doesn't matter since occluders are rasterized from both sides.
+    occluder.indices = {0, 1, 3, 0, 3, 2, 4, 5, 7, 4, 7, 6, 0, 1, 5, 0, 5, 4, 2, 3, 7, 2, 7, 6, 0, 2, 6, 0, 6, 4, 1, 3, 7, 1, 7, 5};
+    return occluder;
+}
+
+void OcclusionBuffer::Begin(const Matrix4& new_view_projection)
+{
+    view_projection = new_view_projection;
+
+    std::ranges::fill(depth, 0.0f);
+    triangles.clear();
+    for (std::vector<uint32>& band : bands) { band.clear(); }
+
+    statistics = {};
+}
+
+void OcclusionBuffer::AddOccluder(const Occluder& occluder, const Matrix4& model)
+{
+    const Matrix4 matrix = model * view_projection;
+    const usize count = occluder.positions.size();
+
+    clip_x.resize(count);
+    clip_y.resize(count);
+    clip_w.resize(count);
+
+    float* const outputs[3] = {clip_x.data(), clip_y.data(), clip_w.data()};
+    constexpr usize columns[3] = {0, 1, 3};
+    usize index = 0;
+
+    // Several positions are transformed at once by broadcasting the matrix columns, like the software rasterizer does.
+#if defined(OCCLUSION_AVX)
+    for (; index + 8 <= count; index += 8)
+    {
+        const float3* positions = &occluder.positions[index];
+        const __m256 x = _mm256_setr_ps(
+            positions[0].x(), positions[1].x(), positions[2].x(), positions[3].x(), positions[4].x(), positions[5].x(), positions[6].x(),
+            positions[7].x()
+        );
+        const __m256 y = _mm256_setr_ps(
+            positions[0].y(), positions[1].y(), positions[2].y(), positions[3].y(), positions[4].y(), positions[5].y(), positions[6].y(),
+            positions[7].y()
+        );
+        const __m256 z = _mm256_setr_ps(
+            positions[0].z(), positions[1].z(), positions[2].z(), positions[3].z(), positions[4].z(), positions[5].z(), positions[6].z(),
+            positions[7].z()
+        );
+
+        for (usize i = 0; i < 3; i++)
+        {
+            const usize column = columns[i];
+            __m256 result = _mm256_add_ps(_mm256_mul_ps(x, _mm256_set1_ps(matrix(0, column))), _mm256_set1_ps(matrix(3, column)));
+            result = _mm256_add_ps(_mm256_mul_ps(y, _mm256_set1_ps(matrix(1, column))), result);
+            result = _mm256_add_ps(_mm256_mul_ps(z, _mm256_set1_ps(matrix(2, column))), result);
+            _mm256_storeu_ps(outputs[i] + index, result);
+        }
+    }
+#elif defined(OCCLUSION_SSE)
+    for (; index + 4 <= count; index += 4)
+    {
+        const float3* positions = &occluder.positions[index];
+        const __m128 x = _mm_setr_ps(positions[0].x(), positions[1].x(), positions[2].x(), positions[3].x());
+        const __m128 y = _mm_setr_ps(positions[0].y(), positions[1].y(), positions[2].y(), positions[3].y());
+        const __m128 z = _mm_setr_ps(positions[0].z(), positions[1].z(), positions[2].z(), positions[3].z());
+
+        for (usize i = 0; i < 3; i++)
+        {
+            const usize column = columns[i];
+            __m128 result = _mm_add_ps(_mm_mul_ps(x, _mm_set1_ps(matrix(0, column))), _mm_set1_ps(matrix(3, column)));
+            result = _mm_add_ps(_mm_mul_ps(y, _mm_set1_ps(matrix(1, column))), result);
+            result = _mm_add_ps(_mm_mul_ps(z, _mm_set1_ps(matrix(2, column))), result);
+            _mm_storeu_ps(outputs[i] + index, result);
+        }
+    }
+#endif
+
+    for (; index < count; index++)
+    {
+        const float3& position = occluder.positions[index];
+        for (usize i = 0; i < 3; i++)
+        {
+            const usize column = columns[i];
+            outputs[i][index] = position.x() * matrix(0, column) + position.y() * matrix(1, column) +
+                                position.z() * matrix(2, column) + matrix(3, column);
+        }
+    }
+
+    for (usize i = 0; i + 3 <= occluder.indices.size(); i += 3)
+    {
+        const uint32 index0 = occluder.indices[i];
+        const uint32 index1 = occluder.indices[i + 1];
+        const uint32 index2 = occluder.indices[i + 2];
+        if (index0 >= count || index1 >= count || index2 >= count) continue;
+
+        AddTriangle(index0, index1, index2);
+    }
+
+    statistics.occluders++;
+}
+
+void OcclusionBuffer::AddTriangle(const uint32 index0, const uint32 index1, const uint32 index2)
+{
+    statistics.triangles++;
+
+    uint32 order[3] = {index0, index1, index2};
+    if (clip_w[index0] < MIN_W || clip_w[index1] < MIN_W || clip_w[index2] < MIN_W)
+    {
+        statistics.skipped_triangles++;
+        return;
+    }
+
+    float screen_x[3];
+    float screen_y[3];
+    for (uint32 i = 0; i < 3; i++)
+    {
+        screen_x[i] = ToScreenX(clip_x[order[i]], clip_w[order[i]]);
+        screen_y[i] = ToScreenY(clip_y[order[i]], clip_w[order[i]]);
+    }
+
+    float area = (screen_x[1] - screen_x[0]) * (screen_y[2] - screen_y[0]) - (screen_y[1] - screen_y[0]) * (screen_x[2] - screen_x[0]);
+    if (area == 0.0f) return;
+
+    // Both windings are rasterized, the edge functions just need a positive area.
+    if (area < 0.0f)
+    {
+        std::swap(order[1], order[2]);
+        std::swap(screen_x[1], screen_x[2]);
+        std::swap(screen_y[1], screen_y[2]);
+        area = -area;
+    }
+
+    constexpr auto width = static_cast<float>(WIDTH);
+    constexpr auto height = static_cast<float>(HEIGHT);
+
+    Triangle triangle{};
+    triangle.min_x = static_cast<sint32>(std::ceil(Math::Clamp(std::min({screen_x[0], screen_x[1], screen_x[2]}) - 0.5f, 0.0f, width)));
+    triangle.min_y = static_cast<sint32>(std::ceil(Math::Clamp(std::min({screen_y[0], screen_y[1], screen_y[2]}) - 0.5f, 0.0f, height)));
+    triangle.max_x =
+        static_cast<sint32>(std::floor(Math::Clamp(std::max({screen_x[0], screen_x[1], screen_x[2]}) - 0.5f, -1.0f, width - 1.0f)));
+    triangle.max_y =
+        static_cast<sint32>(std::floor(Math::Clamp(std::max({screen_y[0], screen_y[1], screen_y[2]}) - 0.5f, -1.0f, height - 1.0f)));
+    if (triangle.min_x > triangle.max_x || triangle.min_y > triangle.max_y) return;
+
+    // 1 / w is interpolated with the barycentric coordinates, which are the edge functions divided by the area.
+    const float inverse_area = 1.0f / area;
+    for (uint32 k = 0; k < 3; k++)
+    {
+        const uint32 a = (k + 1) % 3;
+        const uint32 b = (k + 2) % 3;
+
+        triangle.edge_a[k] = screen_y[a] - screen_y[b];
+        triangle.edge_b[k] = screen_x[b] - screen_x[a];
+        triangle.edge_c[k] = -(triangle.edge_a[k] * screen_x[a] + triangle.edge_b[k] * screen_y[a]);
+
+        const float inverse_w = 1.0f / clip_w[order[k]] * inverse_area;
+        triangle.depth_a += triangle.edge_a[k] * inverse_w;
+        triangle.depth_b += triangle.edge_b[k] * inverse_w;
+        triangle.depth_c += triangle.edge_c[k] * inverse_w;
+    }
+
+    const auto triangle_index = static_cast<uint32>(triangles.size());
+    triangles.push_back(triangle);
+
+    for (sint32 band = triangle.min_y / BAND_HEIGHT; band <= triangle.max_y / BAND_HEIGHT; band++)
+    {
+        bands[band].push_back(triangle_index);
+    }
+}
+
+void OcclusionBuffer::RasterizeBands(const usize begin, const usize end)
+{
+    for (usize band = begin; band < end; band++)
+    {
+        const auto band_top = static_cast<sint32>(band) * BAND_HEIGHT;
+        for (const uint32 index : bands[band]) { RasterizeTriangle(triangles[index], band_top, band_top + BAND_HEIGHT - 1); }
+    }
+}
+
+void OcclusionBuffer::RasterizeTriangle(const Triangle& triangle, const sint32 band_top, const sint32 band_bottom)
+{
+    const sint32 min_y = std::max(triangle.min_y, band_top);
+    const sint32 max_y = std::min(triangle.max_y, band_bottom);
+
+    for (sint32 y = min_y; y <= max_y; y++)
+    {
+        const float center_y = static_cast<float>(y) + 0.5f;
+        float* row = depth.data() + static_cast<usize>(y) * WIDTH;
+
+        // Pixels whose center is inside all edges keep the nearest of their depth and the triangle's depth at the center.
+        // Rows start at a multiple of the SIMD width, which WIDTH is as well, lanes outside the triangle are masked by the edges.
+#if defined(OCCLUSION_AVX)
+        const __m256 lane_offsets = _mm256_setr_ps(0.5f, 1.5f, 2.5f, 3.5f, 4.5f, 5.5f, 6.5f, 7.5f);
+        const __m256 zero = _mm256_setzero_ps();
+
+        for (sint32 x = triangle.min_x & ~7; x <= triangle.max_x; x += 8)
+        {
+            const __m256 center_x = _mm256_add_ps(_mm256_set1_ps(static_cast<float>(x)), lane_offsets);
+
+            __m256 inside = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+            for (uint32 k = 0; k < 3; k++)
+            {
+                const float row_edge = triangle.edge_b[k] * center_y + triangle.edge_c[k];
+                const __m256 edge = _mm256_add_ps(_mm256_mul_ps(_mm256_set1_ps(triangle.edge_a[k]), center_x), _mm256_set1_ps(row_edge));
+                inside = _mm256_and_ps(inside, _mm256_cmp_ps(edge, zero, _CMP_GE_OQ));
+            }
+            if (_mm256_movemask_ps(inside) == 0) continue;
+
+            const float row_depth = triangle.depth_b * center_y + triangle.depth_c;
+            const __m256 triangle_depth =
+                _mm256_add_ps(_mm256_mul_ps(_mm256_set1_ps(triangle.depth_a), center_x), _mm256_set1_ps(row_depth));
+            const __m256 stored_depth = _mm256_loadu_ps(row + x);
+            _mm256_storeu_ps(row + x, _mm256_blendv_ps(stored_depth, _mm256_max_ps(stored_depth, triangle_depth), inside));
+        }
+#elif defined(OCCLUSION_SSE)
+        const __m128 lane_offsets = _mm_setr_ps(0.5f, 1.5f, 2.5f, 3.5f);
+        const __m128 zero = _mm_setzero_ps();
+
+        for (sint32 x = triangle.min_x & ~3; x <= triangle.max_x; x += 4)
+        {
+            const __m128 center_x = _mm_add_ps(_mm_set1_ps(static_cast<float>(x)), lane_offsets);
+
+            __m128 inside = _mm_castsi128_ps(_mm_set1_epi32(-1));
+            for (uint32 k = 0; k < 3; k++)
+            {
+                const float row_edge = triangle.edge_b[k] * center_y + triangle.edge_c[k];
+                const __m128 edge = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(triangle.edge_a[k]), center_x), _mm_set1_ps(row_edge));
+                inside = _mm_and_ps(inside, _mm_cmpge_ps(edge, zero));
+            }
+            if (_mm_movemask_ps(inside) == 0) continue;
+
+            const float row_depth = triangle.depth_b * center_y + triangle.depth_c;
+            const __m128 triangle_depth = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(triangle.depth_a), center_x), _mm_set1_ps(row_depth));
+            const __m128 stored_depth = _mm_loadu_ps(row + x);
+            const __m128 nearest_depth = _mm_max_ps(stored_depth, triangle_depth);
+            _mm_storeu_ps(row + x, _mm_or_ps(_mm_and_ps(inside, nearest_depth), _mm_andnot_ps(inside, stored_depth)));
+        }
+#else
+        for (sint32 x = triangle.min_x; x <= triangle.max_x; x++)
+        {
+            const float center_x = static_cast<float>(x) + 0.5f;
+
+            bool inside = true;
+            for (uint32 k = 0; k < 3; k++)
+            {
+                inside = inside && triangle.edge_a[k] * center_x + triangle.edge_b[k] * center_y + triangle.edge_c[k] >= 0.0f;
+            }
+            if (!inside) continue;
+
+            const float triangle_depth = triangle.depth_a * center_x + triangle.depth_b * center_y + triangle.depth_c;
+            row[x] = std::max(row[x], triangle_depth);
+        }
+#endif
+    }
+}
+
+bool OcclusionBuffer::IsVisible(const BoundingBox& box) const
+{
+    float min_x = std::numeric_limits<float>::max();
+    float min_y = std::numeric_limits<float>::max();
+    float max_x = std::numeric_limits<float>::lowest();
+    float max_y = std::numeric_limits<float>::lowest();
+    float nearest_depth = 0.0f;
+
+    for (uint32 corner = 0; corner < 8; corner++)
+    {
+        const float4 position{
+            corner & 1 ? box.max.x() : box.min.x(), corner & 2 ? box.max.y() : box.min.y(), corner & 4 ? box.max.z() : box.min.z(), 1.0f
+        };
+        const float4 clip = position * view_projection;
+
+        // Boxes reaching behind the camera cover an unbounded part of the screen.
+        if (clip.w() < MIN_W) return true;
+
+        const float x = ToScreenX(clip.x(), clip.w());
+        const float y = ToScreenY(clip.y(), clip.w());
+        min_x = std::min(min_x, x);
+        min_y = std::min(min_y, y);
+        max_x = std::max(max_x, x);
+        max_y = std::max(max_y, y);
+        nearest_depth = std::max(nearest_depth, 1.0f / clip.w());
+    }
+
+    // Boxes outside the screen are left to the frustum culling.
+    if (max_x < 0.0f || max_y < 0.0f || min_x > static_cast<float>(WIDTH) || min_y > static_cast<float>(HEIGHT)) return true;
+
+    // Every pixel the screen space bounds touch is tested, not only the ones whose center they cover, so small boxes aren't missed.
+    const auto left = static_cast<sint32>(Math::Clamp(min_x, 0.0f, static_cast<float>(WIDTH - 1)));
+    const auto top = static_cast<sint32>(Math::Clamp(min_y, 0.0f, static_cast<float>(HEIGHT - 1)));
+    const auto right = static_cast<sint32>(Math::Clamp(max_x, 0.0f, static_cast<float>(WIDTH - 1)));
+    const auto bottom = static_cast<sint32>(Math::Clamp(max_y, 0.0f, static_cast<float>(HEIGHT - 1)));
+
+    // The box is visible as soon as one pixel has no occluder in front of its nearest point.
+    const float threshold = nearest_depth * (1.0f + DEPTH_BIAS);
+    for (sint32 y = top; y <= bottom; y++)
+    {
+        const float* row = depth.data() + static_cast<usize>(y) * WIDTH;
+        sint32 x = left;
+
+        // Rows are tested from a multiple of the SIMD width, the pixels outside the bounds are masked out by their column.
+#if defined(OCCLUSION_AVX)
+        const __m256 threshold_lanes = _mm256_set1_ps(threshold);
+        const __m256 lane_offsets = _mm256_setr_ps(0.0f, 1.0f, 2.0f, 3.0f, 4.0f, 5.0f, 6.0f, 7.0f);
+        const __m256 left_lanes = _mm256_set1_ps(static_cast<float>(left));
+        const __m256 right_lanes = _mm256_set1_ps(static_cast<float>(right));
+        for (x = left & ~7; x <= right; x += 8)
+        {
+            const __m256 column = _mm256_add_ps(_mm256_set1_ps(static_cast<float>(x)), lane_offsets);
+            const __m256 in_bounds =
+                _mm256_and_ps(_mm256_cmp_ps(column, left_lanes, _CMP_GE_OQ), _mm256_cmp_ps(column, right_lanes, _CMP_LE_OQ));
+            const __m256 not_occluded = _mm256_cmp_ps(_mm256_loadu_ps(row + x), threshold_lanes, _CMP_LT_OQ);
+            if (_mm256_movemask_ps(_mm256_and_ps(in_bounds, not_occluded)) != 0) return true;
+        }
+#elif defined(OCCLUSION_SSE)
+        const __m128 threshold_lanes = _mm_set1_ps(threshold);
+        const __m128 lane_offsets = _mm_setr_ps(0.0f, 1.0f, 2.0f, 3.0f);
+        const __m128 left_lanes = _mm_set1_ps(static_cast<float>(left));
+        const __m128 right_lanes = _mm_set1_ps(static_cast<float>(right));
+        for (x = left & ~3; x <= right; x += 4)
+        {
+            const __m128 column = _mm_add_ps(_mm_set1_ps(static_cast<float>(x)), lane_offsets);
+            const __m128 in_bounds = _mm_and_ps(_mm_cmpge_ps(column, left_lanes), _mm_cmple_ps(column, right_lanes));
+            const __m128 not_occluded = _mm_cmplt_ps(_mm_loadu_ps(row + x), threshold_lanes);
+            if (_mm_movemask_ps(_mm_and_ps(in_bounds, not_occluded)) != 0) return true;
+        }
+#endif
+
+        for (; x <= right; x++)
+        {
+            if (row[x] < threshold) return true;
+        }
+    }
+
+    return false;
+}
+
+void OcclusionBuffer::BuildPyramid(std::vector<float>& pyramid) const
+{
+    pyramid.resize(PYRAMID_SIZE);
+    std::ranges::copy(depth, pyramid.begin());
+
+    usize source = 0;
+    usize target = depth.size();
+    for (sint32 level = 1; level < PYRAMID_LEVELS; level++)
+    {
+        const sint32 source_width = WIDTH >> (level - 1);
+        const sint32 width = WIDTH >> level;
+        const sint32 height = HEIGHT >> level;
+
+        for (sint32 y = 0; y < height; y++)
+        {
+            const float* row0 = pyramid.data() + source + static_cast<usize>(y * 2) * source_width;
+            const float* row1 = row0 + source_width;
+            float* output = pyramid.data() + target + static_cast<usize>(y) * width;
+
+            for (sint32 x = 0; x < width; x++)
+            {
+                output[x] = std::min(std::min(row0[x * 2], row0[x * 2 + 1]), std::min(row1[x * 2], row1[x * 2 + 1]));
+            }
+        }
+
+        source = target;
+        target += static_cast<usize>(width) * height;
+    }
+}
\ No newline at end of file
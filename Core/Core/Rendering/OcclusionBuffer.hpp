@@ -0,0 +1,95 @@
+#pragma once
+
+#include "Core/Math.hpp"
+#include "Core/Rendering/Culling.hpp"
+
+#include <vector>
+
+// Simplified geometry of an entity that hides what is behind it, in the local space of its transform.
+// Needs to fit inside the rendered mesh, otherwise meshes that are visible around its edges are culled.
+struct Occluder
+{
+    // Occluder of the whole box, only correct for meshes that fill their bounds, like walls and most buildings.
+    static Occluder FromBox(const BoundingBox& box);
+
+    std::vector<float3> positions;
+    std::vector<uint32> indices;
+};
+
+// Low resolution depth buffer the occluders are rasterized into on the CPU, bounding boxes are then tested against it.
+// Stores 1 / w instead of the projected depth, which is linear in screen space and the same for every clip space convention.
+// Pixels keep the nearest occluder, so larger values are closer to the camera and 0 is empty.
+class OcclusionBuffer
+{
+  public:
+    static constexpr sint32 WIDTH = 256;
+    static constexpr sint32 HEIGHT = 128;
+    // Rows rasterized by one job, every band has its own triangle list so the workers never write to the same pixels.
+    static constexpr sint32 BAND_HEIGHT = 8;
+    static constexpr usize BAND_COUNT = HEIGHT / BAND_HEIGHT;
+    // Levels of the Hi-Z pyramid, from the full buffer down to 2x1 pixels.
+    static constexpr sint32 PYRAMID_LEVELS = 8;
+    static constexpr usize PYRAMID_SIZE = [] {
+        usize size = 0;
+        for (sint32 level = 0; level < PYRAMID_LEVELS; level++) { size += static_cast<usize>(WIDTH >> level) * (HEIGHT >> level); }
+        return size;
+    }();
+
+    struct Statistics
+    {
+        uint32 occluders{0};
+        uint32 triangles{0};
+        // Triangles crossing the near plane are skipped, which only makes the buffer less occluding.
+        uint32 skipped_triangles{0};
+        uint32 tests{0};
+        uint32 occluded{0};
+    };
+
+    // Clears the buffer and the triangles of the last frame.
+    void Begin(const Matrix4& view_projection);
+    // Transforms the occluder with SIMD and adds its triangles to the bands they cover.
+    void AddOccluder(const Occluder& occluder, const Matrix4& model);
+    // Rasterizes the bands [begin, end), can be called for different ranges on multiple threads at once.
+    void RasterizeBands(usize begin, usize end);
+
+    // Whether any part of the box may be in front of the occluders, can be called on multiple threads once all bands are rasterized.
+    [[nodiscard]] bool IsVisible(const BoundingBox& box) const;
+    // Writes the Hi-Z pyramid the GPU culling tests against, once all bands are rasterized. The levels are stored one after another,
+    // every pixel keeps the farthest (smallest) value of the 2x2 pixels of the level above, so a box hidden on a level is hidden below.
+    void BuildPyramid(std::vector<float>& pyramid) const;
+
+    [[nodiscard]] const Statistics& GetStatistics() const { return statistics; }
+    // Test results are counted by the caller, so IsVisible() doesn't write anything and can run in parallel.
+    void AddTestResults(const uint32 tests, const uint32 occluded)
+    {
+        statistics.tests += tests;
+        statistics.occluded += occluded;
+    }
+
+  private:
+    // Screen space triangle, with the edge functions and 1 / w as planes over the pixel centers.
+    struct Triangle
+    {
+        float edge_a[3];
+        float edge_b[3];
+        float edge_c[3];
+        float depth_a, depth_b, depth_c;
+
+        sint32 min_x, min_y, max_x, max_y;
+    };
+
+    void AddTriangle(uint32 index0, uint32 index1, uint32 index2);
+    void RasterizeTriangle(const Triangle& triangle, sint32 band_top, sint32 band_bottom);
+
+    Matrix4 view_projection;
+
+    std::vector<float> depth = std::vector<float>(static_cast<usize>(WIDTH) * HEIGHT, 0.0f);
+
+    std::vector<Triangle> triangles;
+    std::vector<uint32> bands[BAND_COUNT];
+
+    // Clip space positions of the occluder being added, z isn't needed.
+    std::vector<float> clip_x, clip_y, clip_w;
+
+    Statistics statistics;
+};
\ No newline at end of file
@@ -0,0 +1,387 @@
+#include "RenderGraph.hpp"
+
+#include "RenderPassInterface.hpp"
+#include "Tools/Logging.hpp"
+
+#include <algorithm>
+
+void RenderGraph::Reset(const Handle<RenderTarget>& output)
+{
+    resources.clear();
+    nodes.clear();
+    passes.clear();
+
+    // Textures sized like the output get the size of its textures, so they don't change while the output is being resized.
+    output_width = output->GetAllocatedWidth();
+    output_height = output->GetAllocatedHeight();
+    output_viewport_width = output->GetWidth();
+    output_viewport_height = output->GetHeight();
+
+    for (PooledTexture& pooled_texture : texture_pool)
+    {
+        pooled_texture.in_use = false;
+        pooled_texture.unused_frames++;
+    }
+    for (PooledTarget& pooled_target : target_pool) { pooled_target.unused_frames++; }
+
+    // Targets are destroyed first, since they reference the pooled textures.
+    std::erase_if(target_pool, [](const PooledTarget& pooled_target) { return pooled_target.unused_frames > MAX_UNUSED_FRAMES; });
+    std::erase_if(texture_pool, [](const PooledTexture& pooled_texture) { return pooled_texture.unused_frames > MAX_UNUSED_FRAMES; });
+
+    for (usize i = 0; i < output->render_buffers.size(); i++)
+    {
+        Import(i == 0 ? "MainColor" : "MainColor" + std::to_string(i), output->render_buffers[i].GetTexture(), true);
+    }
+
+    // Nothing samples the main depth buffer after the frame, so it doesn't need to be stored by the last pass writing it.
+    if (output->depth_buffer.GetTexture() != nullptr) Import("MainDepth", output->depth_buffer.GetTexture(), false);
+}
+
+void RenderGraph::AddPass(RenderPassInterface& pass)
+{
+    passes.push_back(PassData{&pass});
+
+    RenderGraphBuilder builder{*this, static_cast<uint32>(passes.size() - 1)};
+    pass.Setup(builder);
+}
+
+void RenderGraph::Compile()
+{
+    statistics = {};
+    statistics.passes = static_cast<uint32>(passes.size());
+
+    // Every pass is referenced by the versions it produces, every version by the passes reading it.
+    for (PassData& pass : passes) { pass.reference_count = static_cast<uint32>(pass.writes.size()); }
+    for (const PassData& pass : passes)
+    {
+        for (const uint32 node : pass.reads) { nodes[node].reference_count++; }
+    }
+    for (const ResourceData& resource : resources)
+    {
+        if (resource.output) nodes[resource.latest_node].reference_count++;
+    }
+
+    // Flood fill from the versions nobody uses, culling their producers when all their versions are unused.
+    std::vector<uint32> unused_nodes;
+    for (uint32 i = 0; i < nodes.size(); i++)
+    {
+        if (nodes[i].reference_count == 0) unused_nodes.push_back(i);
+    }
+
+    while (!unused_nodes.empty())
+    {
+        const uint32 node = unused_nodes.back();
+        unused_nodes.pop_back();
+
+        const uint32 producer = nodes[node].producer;
+        if (producer == NO_PASS) continue;
+
+        PassData& pass = passes[producer];
+        if (pass.side_effect || --pass.reference_count > 0) continue;
+
+        pass.culled = true;
+        statistics.culled_passes++;
+
+        for (const uint32 read : pass.reads)
+        {
+            if (--nodes[read].reference_count == 0) unused_nodes.push_back(read);
+        }
+    }
+
+    // Resources only need to be allocated between the first and the last pass using them.
+    for (uint32 i = 0; i < passes.size(); i++)
+    {
+        PassData& pass = passes[i];
+        if (pass.culled) continue;
+
+        auto use = [this, i](const uint32 node) {
+            ResourceData& resource = resources[nodes[node].resource];
+            if (resource.first_pass == NO_PASS) resource.first_pass = i;
+            resource.last_pass = i;
+        };
+        std::ranges::for_each(pass.reads, use);
+        std::ranges::for_each(pass.writes, use);
+
+        // The result of a write only needs to be stored if a later pass or the graph output uses it.
+        auto derive_store = [this](AttachmentData& attachment) {
+            const bool used = nodes[attachment.node].reference_count > 0;
+            attachment.store_op = used ? RenderBuffer::StoreOp::STORE : RenderBuffer::StoreOp::DONT_CARE;
+        };
+        std::ranges::for_each(pass.color_attachments, derive_store);
+        if (pass.depth_attachment.resource != INVALID_RESOURCE) derive_store(pass.depth_attachment);
+    }
+
+    for (const ResourceData& resource : resources)
+    {
+        if (!resource.imported && resource.first_pass != NO_PASS) statistics.transient_resources++;
+    }
+}
+
+void RenderGraph::Execute(const std::function<void(RenderPassInterface&)>& execute_pass)
+{
+    for (uint32 i = 0; i < passes.size(); i++)
+    {
+        PassData& pass = passes[i];
+        if (pass.culled) continue;
+
+        for (ResourceData& resource : resources)
+        {
+            if (!resource.imported && resource.first_pass == i) resource.texture = AcquireTexture(resource.description);
+        }
+
+        const Handle<RenderTarget> target = ResolveTarget(pass);
+
+        for (usize j = 0; j < pass.color_attachments.size(); j++)
+        {
+            const AttachmentData& attachment = pass.color_attachments[j];
+            RenderBuffer& render_buffer = target->render_buffers[j];
+
+            render_buffer.load_op = attachment.load_op;
+            render_buffer.store_op = attachment.store_op;
+
+            // Imported buffers keep the clear color of the target they belong to.
+            const ResourceData& resource = resources[attachment.resource];
+            if (!resource.imported) render_buffer.clear_color = resource.description.clear_color;
+        }
+        if (pass.depth_attachment.resource != INVALID_RESOURCE)
+        {
+            target->depth_buffer.load_op = pass.depth_attachment.load_op;
+            target->depth_buffer.store_op = pass.depth_attachment.store_op;
+        }
+
+        pass.pass->target = target;
+        execute_pass(*pass.pass);
+        pass.pass->target.reset();
+
+        // Textures are returned to the pool after their last use, so later resources in the frame can reuse them.
+        for (ResourceData& resource : resources)
+        {
+            if (resource.imported || resource.last_pass != i) continue;
+
+            ReleaseTexture(resource.texture);
+            resource.texture.reset();
+        }
+    }
+
+    for (const PooledTexture& pooled_texture : texture_pool)
+    {
+        if (pooled_texture.unused_frames == 0) statistics.transient_textures++;
+    }
+    statistics.pooled_textures = static_cast<uint32>(texture_pool.size());
+}
+
+void RenderGraph::Clear()
+{
+    resources.clear();
+    nodes.clear();
+    passes.clear();
+
+    target_pool.clear();
+    texture_pool.clear();
+}
+
+RenderGraph::ResourceID RenderGraph::Find(const std::string& name) const
+{
+    for (ResourceID i = 0; i < resources.size(); i++)
+    {
+        if (resources[i].name == name) return i;
+    }
+
+    return INVALID_RESOURCE;
+}
+
+Handle<Texture> RenderGraph::GetTexture(const ResourceID resource) const
+{
+    if (resource >= resources.size()) return nullptr;
+    return resources[resource].texture;
+}
+
+RenderGraph::ResourceID RenderGraph::Import(const std::string& name, const Handle<Texture>& texture, const bool output)
+{
+    for (ResourceID i = 0; i < resources.size(); i++)
+    {
+        if (resources[i].texture == texture) return i;
+    }
+
+    const auto resource = static_cast<ResourceID>(resources.size());
+    ResourceData& data = resources.emplace_back();
+    data.name = name;
+    data.description = TextureDescription{texture->GetWidth(), texture->GetHeight(), texture->GetFormat()};
+    data.texture = texture;
+    data.imported = true;
+    data.output = output;
+    data.latest_node = CreateNode(resource, NO_PASS);
+
+    return resource;
+}
+
+RenderGraph::ResourceID RenderGraph::CreateResource(const std::string& name, const TextureDescription& description)
+{
+    if (Find(name) != INVALID_RESOURCE) Log::Error("Render graph resource {} already exists", name);
+
+    const auto resource = static_cast<ResourceID>(resources.size());
+    ResourceData& data = resources.emplace_back();
+    data.name = name;
+    data.description = description;
+    if (data.description.width == 0) data.description.width = output_width;
+    if (data.description.height == 0) data.description.height = output_height;
+    data.latest_node = CreateNode(resource, NO_PASS);
+
+    return resource;
+}
+
+uint32 RenderGraph::CreateNode(const ResourceID resource, const uint32 producer)
+{
+    nodes.push_back(NodeData{resource, producer});
+    return static_cast<uint32>(nodes.size() - 1);
+}
+
+Handle<Texture> RenderGraph::AcquireTexture(const TextureDescription& description)
+{
+    for (PooledTexture& pooled_texture : texture_pool)
+    {
+        const Texture& texture = *pooled_texture.texture;
+        if (pooled_texture.in_use || texture.GetFormat() != description.format) continue;
+        if (texture.GetWidth() != description.width || texture.GetHeight() != description.height) continue;
+
+        pooled_texture.in_use = true;
+        pooled_texture.unused_frames = 0;
+        return pooled_texture.texture;
+    }
+
+    const bool depth = description.format == Texture::DEPTH_24;
+    const TextureSettings texture_settings{
+        .width = description.width,
+        .height = description.height,
+        .format = description.format,
+        .flags = static_cast<Texture::Flags>((depth ? Texture::DEPTH_TARGET : Texture::COLOR_TARGET) | Texture::SAMPLER),
+    };
+
+    PooledTexture& pooled_texture = texture_pool.emplace_back();
+    pooled_texture.texture = std::make_shared<Texture>(texture_settings, SamplerSettings{});
+    pooled_texture.in_use = true;
+
+    return pooled_texture.texture;
+}
+
+void RenderGraph::ReleaseTexture(const Handle<Texture>& texture)
+{
+    for (PooledTexture& pooled_texture : texture_pool)
+    {
+        if (pooled_texture.texture == texture) pooled_texture.in_use = false;
+    }
+}
+
+Handle<RenderTarget> RenderGraph::ResolveTarget(const PassData& pass)
+{
+    if (pass.target != nullptr) return pass.target;
+
+    std::vector<const Texture*> color_textures;
+    color_textures.reserve(pass.color_attachments.size());
+    for (const AttachmentData& attachment : pass.color_attachments)
+    {
+        color_textures.push_back(resources[attachment.resource].texture.get());
+    }
+
+    const Texture* depth_texture = nullptr;
+    if (pass.depth_attachment.resource != INVALID_RESOURCE) depth_texture = resources[pass.depth_attachment.resource].texture.get();
+
+    for (PooledTarget& pooled_target : target_pool)
+    {
+        if (pooled_target.color_textures != color_textures || pooled_target.depth_texture != depth_texture) continue;
+
+        pooled_target.unused_frames = 0;
+        SetViewport(*pooled_target.target);
+        return pooled_target.target;
+    }
+
+    // Targets are kept between frames, since creating them can be expensive (OpenGL frame buffers).
+    PooledTarget& pooled_target = target_pool.emplace_back();
+    pooled_target.color_textures = color_textures;
+    pooled_target.depth_texture = depth_texture;
+    pooled_target.target = std::make_shared<RenderTarget>("RenderGraph");
+
+    for (const AttachmentData& attachment : pass.color_attachments)
+    {
+        pooled_target.target->AddRenderBuffer(resources[attachment.resource].texture);
+    }
+    if (depth_texture != nullptr) pooled_target.target->SetDepthBuffer(resources[pass.depth_attachment.resource].texture);
+
+    const Texture& size_texture = depth_texture != nullptr ? *depth_texture : *color_textures.front();
+    pooled_target.target->Resize(size_texture.GetWidth(), size_texture.GetHeight());
+    SetViewport(*pooled_target.target);
+
+    return pooled_target.target;
+}
+
+void RenderGraph::SetViewport(RenderTarget& target) const
+{
+    // Only the part of output sized textures the output shows is rendered to, other textures are rendered to completely.
+    if (target.GetAllocatedWidth() == output_width && target.GetAllocatedHeight() == output_height)
+    {
+        target.SetViewport(output_viewport_width, output_viewport_height);
+    }
+    else target.SetViewport(target.GetAllocatedWidth(), target.GetAllocatedHeight());
+}
+
+RenderGraph::ResourceID RenderGraphBuilder::Create(const std::string& name, const RenderGraph::TextureDescription& description)
+{
+    return graph.CreateResource(name, description);
+}
+
+void RenderGraphBuilder::Read(const ResourceID resource)
+{
+    const uint32 node = graph.resources[resource].latest_node;
+    if (graph.nodes[node].producer == RenderGraph::NO_PASS && !graph.resources[resource].imported)
+    {
+        Log::Error("Render graph resource {} is read before it is written", graph.resources[resource].name);
+    }
+
+    graph.passes[pass].reads.push_back(node);
+}
+
+void RenderGraphBuilder::Write(const ResourceID resource, const bool overwrite_all)
+{
+    RenderGraph::AttachmentData attachment = AddWrite(resource);
+    if (overwrite_all && attachment.load_op == RenderBuffer::LoadOp::CLEAR) attachment.load_op = RenderBuffer::LoadOp::DONT_CARE;
+
+    graph.passes[pass].color_attachments.push_back(attachment);
+}
+
+void RenderGraphBuilder::WriteDepth(const ResourceID resource) { graph.passes[pass].depth_attachment = AddWrite(resource); }
+
+void RenderGraphBuilder::WriteTarget(const Handle<RenderTarget>& target)
+{
+    for (const RenderBuffer& render_buffer : target->render_buffers)
+    {
+        const ResourceID resource = graph.Import("", render_buffer.GetTexture(), true);
+        Write(resource);
+    }
+
+    if (target->depth_buffer.GetTexture() != nullptr) WriteDepth(graph.Import("", target->depth_buffer.GetTexture(), false));
+
+    // Targets without buffers render to the swapchain, which the graph doesn't track.
+    if (target->render_buffers.empty()) SideEffect();
+
+    graph.passes[pass].target = target;
+}
+
+void RenderGraphBuilder::SideEffect() { graph.passes[pass].side_effect = true; }
+
+RenderGraph::AttachmentData RenderGraphBuilder::AddWrite(const ResourceID resource)
+{
+    RenderGraph::ResourceData& data = graph.resources[resource];
+    RenderGraph::PassData& pass_data = graph.passes[pass];
+
+    // Writing to a resource that was already written this frame keeps its contents, so it depends on the previous version.
+    const uint32 previous_node = data.latest_node;
+    const bool written_before = graph.nodes[previous_node].producer != RenderGraph::NO_PASS;
+    if (written_before) pass_data.reads.push_back(previous_node);
+
+    data.latest_node = graph.CreateNode(resource, pass);
+    pass_data.writes.push_back(data.latest_node);
+
+    return RenderGraph::AttachmentData{
+        resource, data.latest_node, written_before ? RenderBuffer::LoadOp::LOAD : RenderBuffer::LoadOp::CLEAR
+    };
+}
\ No newline at end of file
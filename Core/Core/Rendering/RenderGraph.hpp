@@ -0,0 +1,188 @@
+#pragma once
+
+#include "Renderer.hpp"
+
+#include <functional>
+#include <string>
+#include <vector>
+
+class RenderPassInterface;
+class RenderGraphBuilder;
+
+// Orders the render passes of a frame by the resources they read and write.
+// Passes whose results are never used are culled, transient textures share pooled textures when their lifetimes don't overlap
+// and the load/store operations of every attachment are derived from how the resource is used before and after the pass.
+class RenderGraph
+{
+  public:
+    using ResourceID = uint32;
+    static constexpr ResourceID INVALID_RESOURCE = ~0u;
+
+    struct TextureDescription
+    {
+        // A size of 0 uses the size of the textures of the graph output, passes only render to the part it shows.
+        sint32 width{0};
+        sint32 height{0};
+        Texture::ColorFormat format{Texture::COLOR_RGBA_32};
+        float4 clear_color{0.0f, 0.0f, 0.0f, 1.0f};
+    };
+
+    struct Statistics
+    {
+        uint32 passes{0};
+        uint32 culled_passes{0};
+        // Transient resources used this frame and the amount of pooled textures backing them.
+        uint32 transient_resources{0};
+        uint32 transient_textures{0};
+        uint32 pooled_textures{0};
+    };
+
+    /// @brief Removes the passes and resources of the previous frame, pooled textures and targets are kept.
+    /// @param output Target the frame is rendered to, its color buffers are marked as outputs of the graph.
+    void Reset(const Handle<RenderTarget>& output);
+
+    // Calls Setup() of the pass to record the resources it uses, passes are executed in the order they are added.
+    void AddPass(RenderPassInterface& pass);
+
+    void Compile();
+
+    // Calls execute_pass for every pass that wasn't culled, the target of the pass is resolved before.
+    void Execute(const std::function<void(RenderPassInterface&)>& execute_pass);
+
+    // Destroys all pooled textures and targets.
+    void Clear();
+
+    [[nodiscard]] ResourceID Find(const std::string& name) const;
+    // Texture backing the resource, only valid while a pass that uses it is executed.
+    [[nodiscard]] Handle<Texture> GetTexture(ResourceID resource) const;
+    [[nodiscard]] const Statistics& GetStatistics() const { return statistics; }
+
+  private:
+    friend class RenderGraphBuilder;
+
+    static constexpr uint32 NO_PASS = ~0u;
+    // Pooled textures and targets that haven't been used for this many frames are destroyed.
+    static constexpr uint32 MAX_UNUSED_FRAMES = 3;
+
+    struct ResourceData
+    {
+        std::string name;
+        TextureDescription description;
+        Handle<Texture> texture;
+
+        bool imported{false};
+        bool output{false};
+
+        // Node of the latest version of the resource, every write creates a new version.
+        uint32 latest_node{0};
+
+        uint32 first_pass{NO_PASS};
+        uint32 last_pass{NO_PASS};
+    };
+
+    struct NodeData
+    {
+        ResourceID resource;
+        uint32 producer{NO_PASS};
+        uint32 reference_count{0};
+    };
+
+    struct AttachmentData
+    {
+        ResourceID resource;
+        uint32 node{0};
+        RenderBuffer::LoadOp load_op{RenderBuffer::LoadOp::CLEAR};
+        RenderBuffer::StoreOp store_op{RenderBuffer::StoreOp::STORE};
+    };
+
+    struct PassData
+    {
+        RenderPassInterface* pass;
+
+        std::vector<uint32> reads;
+        std::vector<uint32> writes;
+
+        std::vector<AttachmentData> color_attachments;
+        AttachmentData depth_attachment{INVALID_RESOURCE};
+
+        // Existing target used instead of one assembled from the attachments.
+        Handle<RenderTarget> target;
+
+        uint32 reference_count{0};
+        bool side_effect{false};
+        bool culled{false};
+    };
+
+    struct PooledTexture
+    {
+        Handle<Texture> texture;
+        bool in_use{false};
+        uint32 unused_frames{0};
+    };
+
+    struct PooledTarget
+    {
+        std::vector<const Texture*> color_textures;
+        const Texture* depth_texture{nullptr};
+        Handle<RenderTarget> target;
+        uint32 unused_frames{0};
+    };
+
+    ResourceID Import(const std::string& name, const Handle<Texture>& texture, bool output);
+    ResourceID CreateResource(const std::string& name, const TextureDescription& description);
+    uint32 CreateNode(ResourceID resource, uint32 producer);
+
+    Handle<Texture> AcquireTexture(const TextureDescription& description);
+    void ReleaseTexture(const Handle<Texture>& texture);
+    Handle<RenderTarget> ResolveTarget(const PassData& pass);
+    void SetViewport(RenderTarget& target) const;
+
+    // Size of the textures of the output and the part of them it renders to.
+    sint32 output_width{1};
+    sint32 output_height{1};
+    sint32 output_viewport_width{1};
+    sint32 output_viewport_height{1};
+
+    std::vector<ResourceData> resources;
+    std::vector<NodeData> nodes;
+    std::vector<PassData> passes;
+
+    std::vector<PooledTexture> texture_pool;
+    std::vector<PooledTarget> target_pool;
+
+    Statistics statistics;
+};
+
+// Passed to RenderPassInterface::Setup() to declare the resources used by the pass.
+class RenderGraphBuilder
+{
+  public:
+    using ResourceID = RenderGraph::ResourceID;
+
+    // Creates a transient texture, only valid during the frame.
+    ResourceID Create(const std::string& name, const RenderGraph::TextureDescription& description);
+    // Finds a resource imported or created by this or an earlier pass, the main target buffers are called "MainColor" and "MainDepth".
+    [[nodiscard]] ResourceID Find(const std::string& name) const { return graph.Find(name); }
+
+    // Samples the resource during the pass.
+    void Read(ResourceID resource);
+    // Renders to the resource as a color buffer, overwrite_all skips clearing it when it wasn't written before in the frame.
+    void Write(ResourceID resource, bool overwrite_all = false);
+    void WriteDepth(ResourceID resource);
+
+    // Renders to an existing target, its buffers are imported into the graph.
+    void WriteTarget(const Handle<RenderTarget>& target);
+
+    // The pass has effects outside of the graph and should never be culled.
+    void SideEffect();
+
+  private:
+    friend class RenderGraph;
+
+    RenderGraphBuilder(RenderGraph& graph, const uint32 pass) : graph{graph}, pass{pass} {}
+
+    RenderGraph::AttachmentData AddWrite(ResourceID resource);
+
+    RenderGraph& graph;
+    uint32 pass;
+};
\ No newline at end of file
@@ -1,14 +1,16 @@
 #include "RenderPassInterface.hpp"
 
+#include "Core/Spatial.hpp"
+
+#include <algorithm>
+
 namespace
 {
-    void RenderMesh(const Transform& transform, const Handle<Mesh>& mesh_handle)
+    void SetMeshTextures(const Mesh& mesh)
     {
-        Renderer::SetUniform(0, transform.GetMatrix());
-
         uint32 diffuse_count = 0;
         uint32 specular_count = 0;
-        for (const auto& texture : mesh_handle->textures)
+        for (const auto& texture : mesh.textures)
         {
             uint32 sampler_slot = 0;
             if (texture->GetFlags() | Texture::DIFFUSE) { sampler_slot = diffuse_count++; }
@@ -16,24 +18,293 @@ namespace
 
             Renderer::Instance().SetTextureSampler(sampler_slot, *texture);
         }
+    }
 
-        Renderer::Instance().RenderMesh(*mesh_handle);
+    void RenderMesh(const Matrix4& model, const Mesh& mesh)
+    {
+        Renderer::SetUniform(0, model);
+        SetMeshTextures(mesh);
+
+        Renderer::Instance().RenderMesh(mesh);
+    }
+
+    const Camera& GetCamera(Matrix4& view)
+    {
+        const ECS::Entity camera_entity = ECS::GetWorld().query_builder<const Transform, const Camera>().build().first();
+        view = Math::Inverse(camera_entity.GetComponent<Transform>().GetMatrix());
+        return camera_entity.GetComponent<Camera>();
     }
 } // namespace
 
+void DefaultRenderPass::Compute()
+{
+    gpu_culled = false;
+    if (!gpu_culling || culling_pipeline == nullptr || indirect_pipeline == nullptr) return;
+    // The survivors are drawn straight from the shared geometry buffers, which backends without indirect draws don't have.
+    if (!Renderer::Instance().SupportsCompute() || !Renderer::Instance().SupportsIndirectDraws()) return;
+
+    Matrix4 view;
+    const Camera& camera = GetCamera(view);
+    const Matrix4 view_projection = view * camera.GetProjection(*GetTarget());
+
+    gpu_culler.Update();
+    // Nothing was gathered, so the CPU culling draws whatever the GPU culling can't yet.
+    if (gpu_culler.GetInstanceCount() == 0) return;
+
+    // The occluders are still rasterized on the CPU, the GPU only tests against the pyramid built from them.
+    const bool occluders = occlusion_culling && RasterizeOccluders(view_projection);
+    gpu_culler.Dispatch(*culling_pipeline, camera.GetFrustum(view, *GetTarget()), view_projection, occluders ? &occlusion_buffer : nullptr);
+
+    // How many instances survive is only known on the GPU.
+    culling_statistics = {};
+    culling_statistics.tests = gpu_culler.GetInstanceCount();
+    gpu_culled = true;
+}
 
 void DefaultRenderPass::Render()
 {
-    const ECS::Entity camera_entity = ECS::GetWorld().query_builder<const Transform, const Camera>().build().first();
-    const Transform& camera_transform = camera_entity.GetComponent<Transform>();
-    const Camera& camera = camera_entity.GetComponent<Camera>();
-
-    const Matrix4 view = Math::Inverse(camera_transform.GetMatrix());
+    Matrix4 view;
+    const Camera& camera = GetCamera(view);
     Renderer::SetUniform(1, view);
 
-    const Matrix4 projection = camera.GetProjection(*render_target);
+    const Matrix4 projection = camera.GetProjection(*GetTarget());
     Renderer::SetUniform(2, projection);
 
-    const auto mesh_query = ECS::GetWorld().query_builder<const Transform, const Handle<Mesh>>().build();
-    mesh_query.each([](const Transform& transform, const Handle<Mesh>& mesh_handle) { RenderMesh(transform, mesh_handle); });
+    // The backend either draws every group or none, so the CPU culling can still take over when the first one fails.
+    if (gpu_culled && SubmitGpuCulled()) return;
+
+    worker_scratch.resize(Jobs::GetWorkerCount());
+
+    if (culling_mode == CullingMode::HIERARCHICAL)
+    {
+        Spatial::QueryFrustum(camera.GetFrustum(view, *GetTarget()), visible_entities, culling_statistics);
+
+        // The hierarchy already culled everything, the workers only need to compute the model matrices.
+        PrepareDrawLists((visible_entities.size() + CHUNK_SIZE - 1) / CHUNK_SIZE);
+        ForEachRange(visible_entities.size(), CHUNK_SIZE, [this](const usize begin, const usize end, uint32) {
+            std::vector<DrawCommand>& draw_list = draw_lists[begin / CHUNK_SIZE];
+            for (usize i = begin; i < end; i++)
+            {
+                const ECS::Entity& entity = visible_entities[i];
+                draw_list.push_back(DrawCommand{entity.GetComponent<Transform>().GetMatrix(), entity.GetComponent<Handle<Mesh>>().get()});
+            }
+        });
+    }
+    else
+    {
+        chunks.clear();
+
+        const auto mesh_query = ECS::GetWorld().query_builder<const Transform, const Handle<Mesh>>().build();
+        mesh_query.run([this](flecs::iter& iterator) {
+            while (iterator.next())
+            {
+                const auto transforms = iterator.field<const Transform>(0);
+                const auto meshes = iterator.field<const Handle<Mesh>>(1);
+                const usize count = iterator.count();
+
+                for (usize offset = 0; offset < count; offset += CHUNK_SIZE)
+                {
+                    chunks.push_back(MeshChunk{&transforms[offset], &meshes[offset], std::min(CHUNK_SIZE, count - offset)});
+                }
+            }
+        });
+
+        const Frustum frustum = camera.GetFrustum(view, *GetTarget());
+        const Frustum* culling_frustum = culling_mode == CullingMode::FRUSTUM ? &frustum : nullptr;
+
+        PrepareDrawLists(chunks.size());
+        ForEachRange(chunks.size(), 1, [this, culling_frustum](const usize begin, const usize end, const uint32 worker) {
+            for (usize i = begin; i < end; i++) { BuildDrawList(chunks[i], culling_frustum, worker_scratch[worker], draw_lists[i]); }
+        });
+
+        culling_statistics = {};
+        for (usize i = 0; i < chunks.size(); i++)
+        {
+            culling_statistics.visible += static_cast<uint32>(draw_lists[i].size());
+            culling_statistics.culled += static_cast<uint32>(chunks[i].count - draw_lists[i].size());
+        }
+        if (culling_mode == CullingMode::FRUSTUM) culling_statistics.tests = culling_statistics.visible + culling_statistics.culled;
+    }
+
+    if (occlusion_culling) CullOccluded(view * projection);
+
+    if (indirect_pipeline != nullptr && Renderer::Instance().SupportsIndirectDraws())
+    {
+        SubmitIndirect();
+        return;
+    }
+
+    // Merging in order keeps the submission order the same as with a single thread.
+    for (usize i = 0; i < draw_list_count; i++)
+    {
+        for (const DrawCommand& command : draw_lists[i]) { RenderMesh(command.model, *command.mesh); }
+    }
+}
+
+void DefaultRenderPass::SubmitIndirect()
+{
+    indirect_commands.clear();
+    for (usize i = 0; i < draw_list_count; i++)
+    {
+        indirect_commands.insert(indirect_commands.end(), draw_lists[i].begin(), draw_lists[i].end());
+    }
+
+    // Draws with the same textures end up next to each other, so each group can be submitted at once.
+    std::ranges::stable_sort(indirect_commands, [](const DrawCommand& a, const DrawCommand& b) {
+        return a.mesh->textures < b.mesh->textures;
+    });
+
+    const std::span<const DrawCommand> commands{indirect_commands};
+    for (usize begin = 0; begin < commands.size();)
+    {
+        const Mesh& first_mesh = *commands[begin].mesh;
+
+        usize end = begin + 1;
+        while (end < commands.size() && commands[end].mesh->textures == first_mesh.textures) end++;
+
+        SetMeshTextures(first_mesh);
+
+        const std::span<const DrawCommand> group = commands.subspan(begin, end - begin);
+        if (!Renderer::Instance().RenderMeshesIndirect(*indirect_pipeline, group))
+        {
+            for (const DrawCommand& command : group) { RenderMesh(command.model, *command.mesh); }
+        }
+
+        begin = end;
+    }
+}
+
+bool DefaultRenderPass::SubmitGpuCulled()
+{
+    if (gpu_culler.GetGroups().empty()) return false;
+
+    for (const GpuCulling::Group& group : gpu_culler.GetGroups())
+    {
+        SetMeshTextures(*group.mesh);
+
+        const auto offset = static_cast<uint32>(group.first_draw * sizeof(IndexedIndirectArguments));
+        if (!Renderer::Instance().RenderMeshesIndirectBuffer(
+                *indirect_pipeline, gpu_culler.GetArguments(), offset, group.draw_count, gpu_culler.GetVisibleModels()
+            ))
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool DefaultRenderPass::RasterizeOccluders(const Matrix4& view_projection)
+{
+    occlusion_buffer.Begin(view_projection);
+
+    const auto occluder_query = ECS::GetWorld().query_builder<const Transform, const Occluder>().build();
+    occluder_query.each([this](const Transform& transform, const Occluder& occluder) {
+        occlusion_buffer.AddOccluder(occluder, transform.GetMatrix());
+    });
+    if (occlusion_buffer.GetStatistics().occluders == 0) return false;
+
+    // Every band has its own triangles and pixels, so they are rasterized like the draw lists, one job per band.
+    ForEachRange(OcclusionBuffer::BAND_COUNT, 1, [this](const usize begin, const usize end, uint32) {
+        occlusion_buffer.RasterizeBands(begin, end);
+    });
+
+    return true;
+}
+
+void DefaultRenderPass::CullOccluded(const Matrix4& view_projection)
+{
+    if (!RasterizeOccluders(view_projection)) return;
+
+    for (WorkerScratch& scratch : worker_scratch)
+    {
+        scratch.occlusion_tests = 0;
+        scratch.occluded = 0;
+    }
+
+    ForEachRange(draw_list_count, 1, [this](const usize begin, const usize end, const uint32 worker) {
+        WorkerScratch& scratch = worker_scratch[worker];
+        for (usize i = begin; i < end; i++)
+        {
+            std::vector<DrawCommand>& draw_list = draw_lists[i];
+            scratch.occlusion_tests += static_cast<uint32>(draw_list.size());
+            scratch.occluded += static_cast<uint32>(std::erase_if(draw_list, [this](const DrawCommand& command) {
+                return !occlusion_buffer.IsVisible(Culling::TransformBox(command.mesh->GetBoundingBox(), command.model));
+            }));
+        }
+    });
+
+    uint32 tests = 0;
+    uint32 occluded = 0;
+    for (const WorkerScratch& scratch : worker_scratch)
+    {
+        tests += scratch.occlusion_tests;
+        occluded += scratch.occluded;
+    }
+
+    occlusion_buffer.AddTestResults(tests, occluded);
+    culling_statistics.visible -= occluded;
+    culling_statistics.occluded = occluded;
+}
+
+void DefaultRenderPass::PrepareDrawLists(const usize count)
+{
+    if (draw_lists.size() < count) draw_lists.resize(count);
+    for (usize i = 0; i < count; i++) { draw_lists[i].clear(); }
+    draw_list_count = count;
+}
+
+void DefaultRenderPass::ForEachRange(const usize count, const usize batch_size, const Jobs::RangeFunction& function) const
+{
+    if (multithreaded) { Jobs::ParallelFor(count, batch_size, function); }
+    else if (count > 0) { function(0, count, 0); }
+}
+
+void DefaultRenderPass::BuildDrawList(
+    const MeshChunk& chunk, const Frustum* frustum, WorkerScratch& scratch, std::vector<DrawCommand>& draw_list
+)
+{
+    if (frustum == nullptr)
+    {
+        for (usize i = 0; i < chunk.count; i++)
+        {
+            draw_list.push_back(DrawCommand{chunk.transforms[i].GetMatrix(), chunk.meshes[i].get()});
+        }
+        return;
+    }
+
+    scratch.bounds.Clear();
+    for (usize i = 0; i < chunk.count; i++)
+    {
+        scratch.bounds.Add(Culling::TransformSphere(chunk.meshes[i]->GetBoundingSphere(), chunk.transforms[i].GetMatrix()));
+    }
+
+    Culling::CullSpheres(*frustum, scratch.bounds, scratch.visible_indices);
+    for (const uint32 index : scratch.visible_indices)
+    {
+        draw_list.push_back(DrawCommand{chunk.transforms[index].GetMatrix(), chunk.meshes[index].get()});
+    }
+}
+
+void DepthPrepassRenderPass::Render()
+{
+    Matrix4 view;
+    const Camera& camera = GetCamera(view);
+    Renderer::SetUniform(1, view);
+    Renderer::SetUniform(2, camera.GetProjection(*GetTarget()));
+
+    // Meshes the shading pass culls afterwards only cost their depth here, which is cheap compared to shading them.
+    Spatial::QueryFrustum(camera.GetFrustum(view, *GetTarget()), visible_entities, culling_statistics);
+    for (const ECS::Entity& entity : visible_entities)
+    {
+        Renderer::SetUniform(0, entity.GetComponent<Transform>().GetMatrix());
+        Renderer::Instance().RenderMesh(*entity.GetComponent<Handle<Mesh>>());
+    }
+}
+
+void DepthPrepassRenderPass::SetupShadingPass(PipelineState& state, const bool depth_prepass)
+{
+    // The pre-pass transforms the positions exactly like the shading pass, so the visible surfaces pass with an equal depth.
+    state.depth_write = !depth_prepass;
+    state.depth_compare = depth_prepass ? PipelineState::CompareOp::LESS_OR_EQUAL : PipelineState::CompareOp::LESS;
 }
\ No newline at end of file
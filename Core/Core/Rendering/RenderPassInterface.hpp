@@ -1,6 +1,10 @@
 #pragma once
 
 #include "Renderer.hpp"
+#include "RenderGraph.hpp"
+#include "OcclusionBuffer.hpp"
+#include "GpuCulling.hpp"
+#include "Core/Jobs.hpp"
 
 class RenderPassInterface
 {
@@ -13,20 +17,142 @@ class RenderPassInterface
 
     Handle<GraphicsShaderPipeline> graphics_pipeline;
     Handle<RenderTarget> render_target;
+    // Blend, depth and raster state the pipeline is drawn with in this pass.
+    PipelineState pipeline_state;
 
-    bool clear_render_targets{true};
-
+    // Declares the resources the pass reads and writes, by default it renders to render_target.
+    virtual void Setup(RenderGraphBuilder& builder)
+    {
+        if (render_target != nullptr) builder.WriteTarget(render_target);
+    }
+    // Records the compute work the pass depends on, called right before the pass begins and outside of any render pass.
+    virtual void Compute() {}
     virtual void Render() = 0;
+
+    // Name the GPU time of the pass is reported under, see Renderer::GetPassTimings().
+    [[nodiscard]] virtual std::string_view GetName() const { return "Unnamed"; }
+
+    // Target the pass renders to, resolved by the render graph and only valid while the pass is executed.
+    [[nodiscard]] const Handle<RenderTarget>& GetTarget() const { return target; }
+
+  private:
+    friend class RenderGraph;
+
+    Handle<RenderTarget> target;
 };
 
 class DefaultRenderPass final : public RenderPassInterface
 {
   public:
+    enum class CullingMode : uint8
+    {
+        NONE,
+        // Tests every mesh against the frustum.
+        FRUSTUM,
+        // Traverses the spatial hierarchy, skipping the tests for subtrees that are completely in- or outside the frustum.
+        HIERARCHICAL
+    };
+
     DefaultRenderPass(const Handle<GraphicsShaderPipeline>& pipeline, const Handle<RenderTarget>& target) :
         RenderPassInterface{pipeline, target}
     {
     }
     ~DefaultRenderPass() override = default;
 
+    void Compute() override;
     void Render() override;
+    [[nodiscard]] std::string_view GetName() const override { return "Default"; }
+
+    [[nodiscard]] const Culling::Statistics& GetCullingStatistics() const { return culling_statistics; }
+    [[nodiscard]] const OcclusionBuffer::Statistics& GetOcclusionStatistics() const { return occlusion_buffer.GetStatistics(); }
+    [[nodiscard]] const GpuCulling& GetGpuCulling() const { return gpu_culler; }
+
+    CullingMode culling_mode{CullingMode::HIERARCHICAL};
+    // Builds the draw lists on all job workers instead of only the calling thread.
+    bool multithreaded{true};
+    // Rasterizes the entities with an Occluder component into a small depth buffer and removes the draws hidden behind them.
+    bool occlusion_culling{true};
+
+    // Culls all meshes with culling_pipeline and draws the survivors with indirect_pipeline, without walking the entities every frame.
+    // The culling mode is ignored, every instance is tested against the frustum. Uses the CPU culling when compute isn't supported.
+    bool gpu_culling{false};
+
+    // Variant of the pipeline reading the model matrix per instance, used to submit draws with the same textures at once.
+    Handle<GraphicsShaderPipeline> indirect_pipeline;
+    Handle<ComputeShaderPipeline> culling_pipeline;
+
+  private:
+    // Maximum amount of entities handled by one job, flecs tables are split into chunks of this size.
+    static constexpr usize CHUNK_SIZE = 256;
+
+    struct MeshChunk
+    {
+        const Transform* transforms;
+        const Handle<Mesh>* meshes;
+        usize count;
+    };
+
+    // Scratch memory per job worker, so the workers don't need to synchronize.
+    struct WorkerScratch
+    {
+        Culling::SphereBatch bounds;
+        std::vector<uint32> visible_indices;
+
+        uint32 occlusion_tests{0};
+        uint32 occluded{0};
+    };
+
+    void PrepareDrawLists(usize count);
+    void SubmitIndirect();
+    // Draws what the GPU culling of this frame kept, returns false when the backend can't draw from its buffers.
+    bool SubmitGpuCulled();
+    // Rasterizes the entities with an Occluder component, returns false when there are none.
+    bool RasterizeOccluders(const Matrix4& view_projection);
+    // Removes the draws whose bounding box is hidden by the occluders, does nothing when there are none.
+    void CullOccluded(const Matrix4& view_projection);
+    // Runs the ranges on the job workers, or on the calling thread when multithreading is disabled.
+    void ForEachRange(usize count, usize batch_size, const Jobs::RangeFunction& function) const;
+
+    static void BuildDrawList(const MeshChunk& chunk, const Frustum* frustum, WorkerScratch& scratch, std::vector<DrawCommand>& draw_list);
+
+    // Kept between frames so the per frame culling doesn't need to reallocate.
+    std::vector<MeshChunk> chunks;
+    std::vector<std::vector<DrawCommand>> draw_lists;
+    usize draw_list_count{0};
+    std::vector<WorkerScratch> worker_scratch;
+    std::vector<ECS::Entity> visible_entities;
+    std::vector<DrawCommand> indirect_commands;
+
+    Culling::Statistics culling_statistics;
+    OcclusionBuffer occlusion_buffer;
+
+    GpuCulling gpu_culler;
+    // Set by Compute() when the culling was dispatched for this frame.
+    bool gpu_culled{false};
+};
+
+// Fills the depth buffer of the target before the pass shading the meshes, reading only the position stream of the meshes.
+// The shading pass then tests against it without writing depth (see SetupShadingPass()), so each pixel is only shaded by the
+// surface that ends up visible. Every mesh is treated as opaque.
+class DepthPrepassRenderPass final : public RenderPassInterface
+{
+  public:
+    DepthPrepassRenderPass(const Handle<GraphicsShaderPipeline>& pipeline, const Handle<RenderTarget>& target) :
+        RenderPassInterface{pipeline, target}
+    {
+        pipeline_state.vertex_layout = PipelineState::VertexLayout::POSITION;
+        pipeline_state.blend = PipelineState::BlendMode::REPLACE;
+        pipeline_state.color_write = false;
+    }
+    ~DepthPrepassRenderPass() override = default;
+
+    void Render() override;
+    [[nodiscard]] std::string_view GetName() const override { return "Depth pre-pass"; }
+
+    // Sets the depth state of a pass drawing the same meshes after the pre-pass, or back to the default state without it.
+    static void SetupShadingPass(PipelineState& state, bool depth_prepass);
+
+  private:
+    std::vector<ECS::Entity> visible_entities;
+    Culling::Statistics culling_statistics;
 };
\ No newline at end of file
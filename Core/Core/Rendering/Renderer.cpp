@@ -1,15 +1,21 @@
 #include "Core/Rendering/Renderer.hpp"
 
+#include "Platform/Null/Rendering/Renderer.hpp"
 #include "Platform/OpenGL/Rendering/Renderer.hpp"
 #include "Platform/PC/SDL3GPU/Rendering/Renderer.hpp"
+#include "Platform/Software/Rendering/Renderer.hpp"
 
 #include "Core/Model.hpp"
+#include "RenderGraph.hpp"
 #include "RenderPassInterface.hpp"
 #include "Tools/Logging.hpp"
+#include "Tools/Profiler.hpp"
 
 #define STB_IMAGE_IMPLEMENTATION
 #define STBI_NO_STDIO
 #include <stb/stb_image.h>
+#include <algorithm>
+#include <bit>
 #include <filesystem>
 #include <assimp/scene.h>
 
@@ -17,6 +23,8 @@
 
 namespace
 {
+    RenderGraph render_graph;
+
     std::vector<uint8> LoadTextureImage(const std::string& path, sint32& out_width, sint32& out_height)
     {
         const std::vector<uint8>& file_data = Files::ReadBinary(path);
@@ -40,6 +48,16 @@ namespace
 
     std::vector<Handle<Texture>> LoadMaterialTextures(const aiMaterial& material, const aiTextureType type, const std::string& mesh_path)
     {
+        // Models tile their textures and view them at grazing angles, so they are sampled trilinear and anisotropic.
+        constexpr SamplerSettings material_sampler_settings{
+            .down_filter = SamplerSettings::LINEAR,
+            .up_filter = SamplerSettings::LINEAR,
+            .mipmap_mode = SamplerSettings::LINEAR,
+            .wrap_mode_u = SamplerSettings::REPEAT,
+            .wrap_mode_v = SamplerSettings::REPEAT,
+            .max_anisotropy = 8.0f
+        };
+
         std::vector<Handle<Texture>> textures;
         for (uint32 i = 0; i < material.GetTextureCount(type); i++)
         {
@@ -60,28 +78,103 @@ namespace
                 .color_data = data.data()
             };
 
-            auto texture_handle = std::make_shared<Texture>(texture_settings, SamplerSettings{});
+            auto texture_handle = std::make_shared<Texture>(texture_settings, material_sampler_settings);
             textures.push_back(texture_handle);
         }
         return textures;
     }
 } // namespace
 
-RenderTarget::RenderTarget(const std::string& name) : name{name} { Renderer::Instance().CreateRenderTarget(*this); }
+RenderTarget::RenderTarget(const std::string& name) : name{name}, backend_created{true} { Renderer::Instance().CreateRenderTarget(*this); }
+
+RenderTarget::~RenderTarget()
+{
+    if (backend_created) Renderer::Instance().DestroyRenderTarget(*this);
+}
 
 void RenderTarget::Resize(const sint32 new_width, const sint32 new_height)
 {
-    if (width == new_width && height == new_height) return;
+    requested_width = new_width;
+    requested_height = new_height;
 
-    width = new_width;
-    height = new_height;
+    Allocate(new_width, new_height);
+    SetViewport(new_width, new_height);
+}
+
+void RenderTarget::RequestSize(const sint32 new_width, const sint32 new_height)
+{
+    if (new_width <= 0 || new_height <= 0) return;
+
+    // Targets without textures (the window) have nothing to reallocate.
+    if (render_buffers.empty() && depth_buffer.GetTexture() == nullptr)
+    {
+        Resize(new_width, new_height);
+        return;
+    }
+
+    // The first size is allocated right away, there is no earlier frame that could be shown scaled.
+    if (!size_requested)
+    {
+        size_requested = true;
+        Resize((new_width + SIZE_CLASS - 1) / SIZE_CLASS * SIZE_CLASS, (new_height + SIZE_CLASS - 1) / SIZE_CLASS * SIZE_CLASS);
+    }
+
+    if (new_width == requested_width && new_height == requested_height) return;
+
+    requested_width = new_width;
+    requested_height = new_height;
+    settled_frames = 0;
+
+    const float scale = std::min({
+        1.0f, static_cast<float>(allocated_width) / static_cast<float>(new_width),
+        static_cast<float>(allocated_height) / static_cast<float>(new_height)
+    });
+    SetViewport(
+        std::max(static_cast<sint32>(static_cast<float>(new_width) * scale), 1),
+        std::max(static_cast<sint32>(static_cast<float>(new_height) * scale), 1)
+    );
+}
+
+void RenderTarget::Settle()
+{
+    // Targets without textures are resized to the exact size by RequestSize(), they have no size class.
+    if (render_buffers.empty() && depth_buffer.GetTexture() == nullptr) return;
+
+    const sint32 class_width = (requested_width + SIZE_CLASS - 1) / SIZE_CLASS * SIZE_CLASS;
+    const sint32 class_height = (requested_height + SIZE_CLASS - 1) / SIZE_CLASS * SIZE_CLASS;
+
+    // Sizes within the same class only move the viewport, the textures stay.
+    if (class_width == allocated_width && class_height == allocated_height)
+    {
+        SetViewport(requested_width, requested_height);
+        return;
+    }
+
+    if (++settled_frames < SETTLE_FRAMES) return;
+
+    Allocate(class_width, class_height);
+    SetViewport(requested_width, requested_height);
+}
+
+void RenderTarget::SetViewport(const sint32 new_width, const sint32 new_height)
+{
+    width = std::min(new_width, allocated_width);
+    height = std::min(new_height, allocated_height);
+}
+
+void RenderTarget::Allocate(const sint32 new_width, const sint32 new_height)
+{
+    if (allocated_width == new_width && allocated_height == new_height) return;
+
+    allocated_width = new_width;
+    allocated_height = new_height;
 
     for (RenderBuffer& buffer : render_buffers)
     {
-        buffer.GetTexture()->Resize(width, height);
+        buffer.GetTexture()->Resize(allocated_width, allocated_height);
     }
 
-    if (depth_buffer.GetTexture() != nullptr) { depth_buffer.GetTexture()->Resize(width, height); }
+    if (depth_buffer.GetTexture() != nullptr) { depth_buffer.GetTexture()->Resize(allocated_width, allocated_height); }
 }
 
 void RenderTarget::AddRenderBuffer(const Handle<Texture>& render_texture, const float4& clear_color)
@@ -179,6 +272,7 @@ Mesh::Mesh(const std::string& path, const uint32 index) : index{index}
 
     vertices_count = static_cast<uint32>(vertices.size());
     indices_count = static_cast<uint32>(indices.size());
+    ComputeBounds(vertices);
 
     Renderer::Instance().CreateMesh(*this, vertices, indices);
 }
@@ -187,12 +281,29 @@ Mesh::Mesh(const std::vector<Vertex>& vertices, const std::vector<uint32>& indic
 {
     vertices_count = static_cast<uint32>(vertices.size());
     indices_count = static_cast<uint32>(indices.size());
+    ComputeBounds(vertices);
 
     Renderer::Instance().CreateMesh(*this, vertices, indices);
 }
 
 Mesh::~Mesh() { Renderer::Instance().DestroyMesh(*this); }
 
+void Mesh::ComputeBounds(const std::vector<Vertex>& vertices)
+{
+    // Empty meshes, like ones that failed to load, keep empty bounds at the origin.
+    if (vertices.empty())
+    {
+        bounding_box = {};
+        bounding_sphere = {};
+        return;
+    }
+
+    const float3* positions = &vertices.data()->position;
+
+    bounding_box = Culling::ComputeBoundingBox(positions, vertices.size(), sizeof(Vertex));
+    bounding_sphere = Culling::ComputeBoundingSphere(bounding_box, positions, vertices.size(), sizeof(Vertex));
+}
+
 uint64 Shader::GetID(const std::string& path, const ShaderSettings& shader_info)
 {
     constexpr std::hash<std::string> hasher{};
@@ -223,29 +334,79 @@ Shader::Shader(std::string path, const ShaderSettings& shader_info) :
 
 Shader::~Shader() { Renderer::Instance().DestroyShader(*this); }
 
+uint64 SamplerSettings::GetHash() const
+{
+    const uint64 modes = down_filter | up_filter << 4 | mipmap_mode << 8 | wrap_mode_u << 12 | wrap_mode_v << 16;
+    return modes | static_cast<uint64>(std::bit_cast<uint32>(max_anisotropy)) << 32;
+}
+
+uint64 PipelineState::GetHash() const
+{
+    // Every field fits into its own bits, so different states never share a hash.
+    return static_cast<uint64>(vertex_layout) | static_cast<uint64>(blend) << 8 | static_cast<uint64>(cull) << 16 |
+           static_cast<uint64>(wireframe) << 24 | static_cast<uint64>(depth_test) << 25 | static_cast<uint64>(depth_write) << 26 |
+           static_cast<uint64>(color_write) << 27 | static_cast<uint64>(depth_compare) << 32;
+}
+
 GraphicsShaderPipeline::GraphicsShaderPipeline(
     const std::string& pipeline_path, const ShaderSettings& vertex_settings, const ShaderSettings& fragment_settings
-)
+) :
+    vertex_path{pipeline_path}, fragment_path{pipeline_path}, vertex_shader{FileResource::Load<Shader>(pipeline_path, vertex_settings)},
+    fragment_shader{FileResource::Load<Shader>(pipeline_path, fragment_settings)}
 {
-    const Handle<Shader>& vertex_shader = FileResource::Load<Shader>(pipeline_path, vertex_settings);
-    vertex_path = pipeline_path;
-    const Handle<Shader>& fragment_shader = FileResource::Load<Shader>(pipeline_path, fragment_settings);
-    fragment_path = pipeline_path;
-
     Renderer::Instance().CreateShaderPipeline(*this, vertex_shader, fragment_shader);
-
-    TryDestroyResource(vertex_shader->Resource::GetID());
-    TryDestroyResource(fragment_shader->Resource::GetID());
 }
 
 GraphicsShaderPipeline::GraphicsShaderPipeline(const Handle<Shader>& vertex_shader, const Handle<Shader>& fragment_shader) :
-    vertex_path{vertex_shader->GetPath()}, fragment_path{fragment_shader->GetPath()}
+    vertex_path{vertex_shader->GetPath()}, fragment_path{fragment_shader->GetPath()}, vertex_shader{vertex_shader},
+    fragment_shader{fragment_shader}
 {
     Renderer::Instance().CreateShaderPipeline(*this, vertex_shader, fragment_shader);
 }
 
 GraphicsShaderPipeline::~GraphicsShaderPipeline() { Renderer::Instance().DestroyShaderPipeline(*this); }
 
+StorageBuffer::StorageBuffer(const std::string& name, const usize size, const Flags flags, const void* data) :
+    name{name}, size{size}, flags{flags}
+{
+    Renderer::Instance().CreateStorageBuffer(*this, data);
+}
+
+StorageBuffer::~StorageBuffer() { Renderer::Instance().DestroyStorageBuffer(*this); }
+
+void StorageBuffer::Update(const void* data, const usize update_size, const usize offset)
+{
+    if (offset + update_size > size)
+    {
+        Log::Error("Update of {} bytes at offset {} doesn't fit into storage buffer {} of {} bytes", update_size, offset, name, size);
+        return;
+    }
+
+    Renderer::Instance().UpdateStorageBuffer(*this, data, update_size, offset);
+}
+
+ComputeShaderPipeline::ComputeShaderPipeline(std::string path, const ComputeShaderSettings& settings) : settings{settings}
+{
+    const Renderer::BackendShaderInfo& backend_shader_info = Renderer::GetBackendShaderInfo();
+
+    path = path.substr(0, path.find_last_of('.'));
+    path += ".comp";
+    path += backend_shader_info.file_extension;
+
+    if (backend_shader_info.binary)
+    {
+        const std::vector<uint8>& binary_shader = Files::ReadBinary(path);
+        Renderer::Instance().CreateComputePipeline(*this, binary_shader.data(), binary_shader.size());
+    }
+    else
+    {
+        const std::string& text_shader = Files::ReadText(path);
+        Renderer::Instance().CreateComputePipeline(*this, text_shader.data(), text_shader.size());
+    }
+}
+
+ComputeShaderPipeline::~ComputeShaderPipeline() { Renderer::Instance().DestroyComputePipeline(*this); }
+
 void Renderer::SetupBackend(const char* backend_argument)
 {
     if (backend_argument == nullptr) backend_name = "SDL3GPU";
@@ -264,6 +425,20 @@ void Renderer::SetupBackend(const char* backend_argument)
         renderer = new SDL3GPURenderer;
         return;
     }
+
+    // Records the frames without a GPU, set SDL_VIDEODRIVER=offscreen to run without a display as well.
+    if (backend_name == "Null")
+    {
+        renderer = new NullRenderer;
+        return;
+    }
+
+    // Renders on the CPU, also works with SDL_VIDEODRIVER=offscreen.
+    if (backend_name == "Software")
+    {
+        renderer = new SoftwareRenderer;
+        return;
+    }
 }
 
 void Renderer::Init() { renderer->InitBackend(); }
@@ -272,18 +447,90 @@ void Renderer::Exit()
 {
     main_target.reset();
     render_passes.clear();
+    render_graph.Clear();
 
     renderer->ExitBackend();
 }
 
 void Renderer::Render()
 {
-    Instance().Update();
+    PROFILE_ZONE("Renderer::Render");
+    Renderer& instance = Instance();
 
-    for (Handle<RenderPassInterface>& render_pass : render_passes)
-    {
-        Instance().BeginRenderPass(*render_pass);
-        render_pass->Render();
+    // Uniforms are pushed to a new command buffer every frame, so nothing is bound yet.
+    instance.uniform_allocator.Reset();
+    for (auto& stage_shadows : instance.uniform_shadows) { std::ranges::fill(stage_shadows, UniformShadow{}); }
+    instance.statistics = {};
+
+    instance.Update();
+
+    main_target->Settle();
+    render_graph.Reset(main_target);
+    for (Handle<RenderPassInterface>& render_pass : render_passes) { render_graph.AddPass(*render_pass); }
+    render_graph.Compile();
+
+    render_graph.Execute([](RenderPassInterface& render_pass) {
+        PROFILE_ZONE_DETAIL("Render pass", render_pass.GetName());
+        render_pass.Compute();
+
+        Instance().BeginRenderPass(render_pass);
+        render_pass.Render();
         Instance().EndRenderPass();
+    });
+
+    instance.EndFrame();
+}
+
+RenderGraph& Renderer::GetRenderGraph() { return render_graph; }
+
+void Renderer::SetUniform(const uint32 slot, const void* data, const usize size, const ShaderStages stages)
+{
+    if (slot >= MAX_UNIFORM_SLOTS)
+    {
+        Log::Error("Invalid shader uniform slot: {}", slot);
+        return;
+    }
+
+    uint8 changed_stages = 0;
+    for (uint32 stage = 0; stage < UNIFORM_STAGE_COUNT; stage++)
+    {
+        if ((stages & (1 << stage)) == 0) continue;
+
+        const UniformShadow& shadow = uniform_shadows[stage][slot];
+        if (shadow.size == size && std::memcmp(uniform_allocator.GetData(shadow.offset), data, size) == 0) continue;
+
+        changed_stages |= static_cast<uint8>(1 << stage);
+    }
+
+    if (changed_stages == 0)
+    {
+        statistics.skipped_uniform_pushes++;
+        return;
+    }
+
+    const usize offset = uniform_allocator.Push(data, size);
+    for (uint32 stage = 0; stage < UNIFORM_STAGE_COUNT; stage++)
+    {
+        if ((changed_stages & (1 << stage)) != 0) uniform_shadows[stage][slot] = UniformShadow{offset, size};
     }
+
+    statistics.uniform_pushes++;
+    statistics.uniform_bytes += size * static_cast<usize>(std::popcount(changed_stages));
+
+    PushUniform(slot, uniform_allocator.GetData(offset), size, static_cast<ShaderStages>(changed_stages));
+}
+
+void Renderer::AddPassTiming(const std::string_view name, const float milliseconds)
+{
+    auto timing = std::ranges::find(pass_timings, name, &PassTiming::name);
+    if (timing == pass_timings.end()) timing = pass_timings.insert(pass_timings.end(), PassTiming{.name = std::string{name}});
+
+    timing->last_milliseconds = milliseconds;
+    timing->samples[timing->next_sample] = milliseconds;
+    timing->next_sample = (timing->next_sample + 1) % PassTiming::WINDOW;
+    timing->sample_count = std::min(timing->sample_count + 1, PassTiming::WINDOW);
+
+    float sum = 0.0f;
+    for (uint32 i = 0; i < timing->sample_count; i++) { sum += timing->samples[i]; }
+    timing->average_milliseconds = sum / static_cast<float>(timing->sample_count);
 }
\ No newline at end of file
@@ -4,9 +4,16 @@
 #include "Core/Math.hpp"
 #include "Core/Resource.hpp"
 #include "Core/Window.hpp"
+#include "Core/Rendering/Culling.hpp"
+#include "Core/Rendering/GeometryAllocator.hpp"
+#include "Tools/LinearAllocator.hpp"
 
+#include <array>
+#include <functional>
 #include <memory>
+#include <span>
 #include <string>
+#include <string_view>
 #include <vector>
 
 namespace Physics
@@ -44,6 +51,12 @@ union GraphicsShaderPipelineID
     uint32 id;
 };
 
+union ComputeShaderPipelineID
+{
+    void* pointer = nullptr;
+    uint32 id;
+};
+
 struct Vertex
 {
     float3 position{};
@@ -90,6 +103,7 @@ class Texture
     [[nodiscard]] Flags GetFlags() const { return flags; }
 
     TextureID texture{};
+    // Owned by the sampler cache of the backend, shared with every texture using the same sampler settings.
     SamplerID sampler{};
 
   private:
@@ -111,16 +125,57 @@ struct TextureSettings
 
 struct SamplerSettings
 {
-    uint32 down_filter{0};
-    uint32 up_filter{0};
-    uint32 mipmap_mode{0};
-    uint32 wrap_mode_u{2};
-    uint32 wrap_mode_v{2};
+    // The values match the SDL3GPU enums, the filters are also used for the mipmap mode.
+    enum Filter : uint32
+    {
+        NEAREST,
+        LINEAR
+    };
+
+    enum WrapMode : uint32
+    {
+        REPEAT,
+        MIRRORED_REPEAT,
+        CLAMP_TO_EDGE
+    };
+
+    uint32 down_filter{NEAREST};
+    uint32 up_filter{NEAREST};
+    uint32 mipmap_mode{NEAREST};
+    uint32 wrap_mode_u{CLAMP_TO_EDGE};
+    uint32 wrap_mode_v{CLAMP_TO_EDGE};
+    // Anisotropic filtering is used above 1, clamped to what the device supports.
+    float max_anisotropy{1.0f};
+
+    // Backends share one sampler between all textures with the same settings, cached by this hash.
+    [[nodiscard]] uint64 GetHash() const;
+    bool operator==(const SamplerSettings&) const = default;
+};
+
+template <>
+struct std::hash<SamplerSettings>
+{
+    usize operator()(const SamplerSettings& settings) const noexcept { return static_cast<usize>(settings.GetHash()); }
 };
 
 class RenderBuffer
 {
   public:
+    // What happens to the contents of the buffer at the start and the end of a render pass, set by the render graph.
+    // Declared in the same order as the SDL_gpu operations, so backends can cast them directly.
+    enum class LoadOp : uint8
+    {
+        LOAD,
+        CLEAR,
+        DONT_CARE
+    };
+
+    enum class StoreOp : uint8
+    {
+        STORE,
+        DONT_CARE
+    };
+
     RenderBuffer() = default;
     RenderBuffer(const Handle<Texture>& texture) : texture{texture} {}
 
@@ -128,6 +183,9 @@ class RenderBuffer
 
     float4 clear_color{};
 
+    LoadOp load_op{LoadOp::CLEAR};
+    StoreOp store_op{StoreOp::STORE};
+
   private:
     Handle<Texture> texture;
 };
@@ -143,11 +201,32 @@ class RenderTarget final : public Resource
 
     RenderTarget() = default;
     explicit RenderTarget(const std::string& name);
+    ~RenderTarget() override;
 
-    void Resize(sint32 new_width, sint32 new_height);
+    // Textures of sizes requested with RequestSize() are rounded up to multiples of this.
+    static constexpr sint32 SIZE_CLASS = 256;
+    // Frames a requested size has to stay the same before the textures are reallocated for it.
+    static constexpr uint32 SETTLE_FRAMES = 8;
 
+    // Reallocates the textures at exactly the new size right away, the passes render to all of them.
+    void Resize(sint32 new_width, sint32 new_height);
+    /// @brief For sizes that change every frame while they are dragged, like the window or the editor viewport.
+    /// The textures are allocated with headroom, rounded up to SIZE_CLASS, and the passes render to the top left of them.
+    /// They are only reallocated once the size was the same for SETTLE_FRAMES calls to Settle(), until then a size that doesn't
+    /// fit is scaled down to fit into the textures, keeping its aspect ratio.
+    void RequestSize(sint32 new_width, sint32 new_height);
+    // Reallocates the textures when the requested size settled in another size class, called once per frame.
+    void Settle();
+
+    // Size the passes render to, the top left of the textures.
     [[nodiscard]] sint32 GetWidth() const { return width; }
     [[nodiscard]] sint32 GetHeight() const { return height; }
+    // Size of the textures, at least the size the passes render to.
+    [[nodiscard]] sint32 GetAllocatedWidth() const { return allocated_width; }
+    [[nodiscard]] sint32 GetAllocatedHeight() const { return allocated_height; }
+
+    // Renders to the top left of the textures, clamped to their size.
+    void SetViewport(sint32 new_width, sint32 new_height);
 
     void AddRenderBuffer(const Handle<Texture>& render_texture, const float4& clear_color = {});
     void SetDepthBuffer(const Handle<Texture>& depth_texture);
@@ -155,13 +234,24 @@ class RenderTarget final : public Resource
     std::vector<RenderBuffer> render_buffers;
     RenderBuffer depth_buffer;
 
-    uint32 target_id; // Only used for OpenGL.
+    uint32 target_id{0}; // Only used for OpenGL.
 
   private:
+    void Allocate(sint32 new_width, sint32 new_height);
+
     std::string name{};
+    // Only named targets create a backend object, default constructed ones (like the window) have nothing to destroy.
+    bool backend_created{false};
 
     sint32 width{1};
     sint32 height{1};
+    sint32 allocated_width{1};
+    sint32 allocated_height{1};
+
+    sint32 requested_width{1};
+    sint32 requested_height{1};
+    uint32 settled_frames{0};
+    bool size_requested{false};
 };
 
 class Mesh final : public Resource
@@ -183,17 +273,44 @@ class Mesh final : public Resource
     // Mesh index in the model it was loaded from.
     [[nodiscard]] uint32 GetIndex() const { return index; }
 
+    // Local space bounds, computed from the vertices when the mesh is created.
+    [[nodiscard]] const BoundingBox& GetBoundingBox() const { return bounding_box; }
+    [[nodiscard]] const BoundingSphere& GetBoundingSphere() const { return bounding_sphere; }
+
     uint32 bind{};
 
     BufferID vertices_buffer;
     BufferID indices_buffer;
 
+    // Offsets of the mesh in the buffers when they are shared with other meshes, 0 when the mesh has its own buffers.
+    uint32 first_index{0};
+    sint32 base_vertex{0};
+
+    // Nodes of the geometry allocator, NONE when the mesh has its own buffers.
+    uint32 vertex_allocation{OffsetAllocator::NONE};
+    uint32 index_allocation{OffsetAllocator::NONE};
+
+    // False while the data is waiting in the upload queue of the backend, drawing the mesh is skipped until then.
+    bool resident{true};
+
     std::vector<Handle<Texture>> textures;
 
   private:
+    void ComputeBounds(const std::vector<Vertex>& vertices);
+
     uint32 vertices_count;
     uint32 indices_count;
     uint32 index{0}; // Mesh index in the model it was loaded from.
+
+    BoundingBox bounding_box;
+    BoundingSphere bounding_sphere;
+};
+
+// Everything needed to draw a mesh, built ahead of time so the draw lists can be generated on multiple threads.
+struct DrawCommand
+{
+    Matrix4 model;
+    const Mesh* mesh;
 };
 
 struct ShaderSettings;
@@ -231,7 +348,155 @@ struct ShaderSettings
     uint32 uniform_count{0};
 };
 
+// Fixed function state a graphics pipeline is created with, set per render pass.
+// Backends combine it with the shaders and the formats of the render target into one pipeline object,
+// which is cached by the hash of that description and shared by every pass using the same one.
+struct PipelineState
+{
+    enum class BlendMode : uint8
+    {
+        REPLACE,
+        ALPHA,
+        ADDITIVE
+    };
+
+    enum class CullMode : uint8
+    {
+        NONE,
+        FRONT,
+        BACK
+    };
+
+    enum class CompareOp : uint8
+    {
+        LESS,
+        LESS_OR_EQUAL,
+        EQUAL,
+        ALWAYS
+    };
+
+    // Vertex buffers the pipeline reads, the instanced layout reads the model matrix per instance from a second buffer.
+    // The position layout only reads the positions of the meshes, which are stored apart from the other attributes.
+    enum class VertexLayout : uint8
+    {
+        MESH,
+        MESH_INSTANCED_MODEL,
+        POSITION
+    };
+
+    [[nodiscard]] uint64 GetHash() const;
+    bool operator==(const PipelineState&) const = default;
+
+    VertexLayout vertex_layout{VertexLayout::MESH};
+    BlendMode blend{BlendMode::ALPHA};
+    CullMode cull{CullMode::BACK};
+    bool wireframe{false};
+    // Disabled for passes that only fill the depth buffer.
+    bool color_write{true};
+
+    bool depth_test{true};
+    bool depth_write{true};
+    CompareOp depth_compare{CompareOp::LESS};
+};
+
 class RenderPassInterface;
+class RenderGraph;
+
+// Buffer of structured data that shaders read and write, its size is fixed when it is created.
+class StorageBuffer final : public Resource
+{
+  public:
+    enum Flags : uint32
+    {
+        // Bound as a read-only storage buffer of compute shaders.
+        COMPUTE_READ = (1 << 0),
+        // Bound as a read-write storage buffer of compute shaders.
+        COMPUTE_WRITE = (1 << 1),
+        // Read by vertex and fragment shaders.
+        GRAPHICS_READ = (1 << 2),
+        // Holds the arguments of indirect dispatches and draws.
+        INDIRECT = (1 << 3),
+        // Read per instance as the model matrices of the MESH_INSTANCED_MODEL vertex layout.
+        VERTEX = (1 << 4)
+    };
+
+    static uint64 GetID(const std::string& name, usize, Flags, const void* = nullptr)
+    {
+        constexpr std::hash<std::string> hasher{};
+        return hasher(name);
+    }
+
+    StorageBuffer() = default;
+    StorageBuffer(const std::string& name, usize size, Flags flags, const void* data = nullptr);
+    ~StorageBuffer() override;
+
+    // Overwrites size bytes at the offset, the work recorded after this call sees the new data.
+    // SDL3GPU uploads before the frame is submitted, so updating a range twice in a frame overwrites it for the whole frame.
+    void Update(const void* data, usize size, usize offset = 0);
+
+    [[nodiscard]] usize GetSize() const { return size; }
+    [[nodiscard]] Flags GetFlags() const { return flags; }
+
+    BufferID buffer{};
+
+  private:
+    std::string name{};
+
+    usize size{0};
+    Flags flags{COMPUTE_READ};
+};
+
+// Arguments of one indexed draw read from an INDIRECT buffer, laid out the way SDL3GPU and OpenGL expect them.
+struct IndexedIndirectArguments
+{
+    uint32 index_count{0};
+    uint32 instance_count{0};
+    uint32 first_index{0};
+    sint32 base_vertex{0};
+    uint32 first_instance{0};
+};
+
+// Storage buffer used by a dispatch, read-write bindings need a buffer created with COMPUTE_WRITE.
+struct StorageBinding
+{
+    const StorageBuffer* buffer{nullptr};
+    bool read_write{false};
+};
+
+// Resources a compute pipeline is created with, the thread counts need to match [numthreads] of the entry point.
+struct ComputeShaderSettings
+{
+    uint32 sampler_count{0};
+    uint32 read_only_storage_count{0};
+    uint32 read_write_storage_count{0};
+    uint32 uniform_count{0};
+
+    uint32 thread_count_x{64};
+    uint32 thread_count_y{1};
+    uint32 thread_count_z{1};
+};
+
+// Pipeline of the [shader("compute")] entry point of a shader file, compiled to <name>.comp<extension> by the shader compiler.
+class ComputeShaderPipeline final : public FileResource
+{
+  public:
+    static uint64 GetID(const std::string& path, const ComputeShaderSettings&)
+    {
+        constexpr std::hash<std::string> hasher{};
+        return hasher(path + ".comp");
+    }
+
+    ComputeShaderPipeline() = default;
+    ComputeShaderPipeline(std::string path, const ComputeShaderSettings& settings);
+    ~ComputeShaderPipeline() override;
+
+    [[nodiscard]] const ComputeShaderSettings& GetSettings() const { return settings; }
+
+    ComputeShaderPipelineID compute_pipeline;
+
+  private:
+    ComputeShaderSettings settings;
+};
 
 class GraphicsShaderPipeline final : public FileResource
 {
@@ -258,15 +523,18 @@ class GraphicsShaderPipeline final : public FileResource
     const std::string& GetVertexPath() const { return vertex_path; }
     const std::string& GetFragmentPath() const { return fragment_path; }
 
-    bool IsWireframe() const { return wireframe; }
+    // The shaders are kept alive, backends that create their pipelines per state and target need them after construction.
+    const Handle<Shader>& GetVertexShader() const { return vertex_shader; }
+    const Handle<Shader>& GetFragmentShader() const { return fragment_shader; }
 
-    GraphicsShaderPipelineID shader_pipeline;
+    GraphicsShaderPipelineID shader_pipeline; // Only used for OpenGL.
 
   private:
     std::string vertex_path;
     std::string fragment_path;
 
-    bool wireframe{false};
+    Handle<Shader> vertex_shader;
+    Handle<Shader> fragment_shader;
 };
 
 class Renderer
@@ -278,6 +546,79 @@ class Renderer
         bool binary;
         const char* profile;
         bool invert_y;
+        // Compute shaders need a newer profile on OpenGL (GLSL 4.30).
+        const char* compute_profile;
+    };
+
+    enum ShaderStages : uint8
+    {
+        VERTEX_STAGE = (1 << 0),
+        FRAGMENT_STAGE = (1 << 1),
+        COMPUTE_STAGE = (1 << 2),
+        ALL_STAGES = VERTEX_STAGE | FRAGMENT_STAGE | COMPUTE_STAGE
+    };
+
+    // Counters of the current frame, reset at the start of Render().
+    struct Statistics
+    {
+        uint32 uniform_pushes{0};
+        // Pushes skipped because every stage already had the same data bound to the slot.
+        uint32 skipped_uniform_pushes{0};
+        // Bytes pushed to the backend, counted once per stage.
+        usize uniform_bytes{0};
+
+        uint32 draw_calls{0};
+        uint32 dispatches{0};
+        // Backend state changes and the redundant ones skipped because the state was already set.
+        uint32 state_changes{0};
+        uint32 skipped_state_changes{0};
+
+        // Bytes sent to the GPU this frame and the uploads still queued afterwards.
+        usize uploaded_bytes{0};
+        uint32 pending_uploads{0};
+        usize pending_upload_bytes{0};
+
+        // Pipelines created or waited for while recording a pass instead of ahead of time, each one stalls the frame.
+        uint32 pipeline_stalls{0};
+
+        // Time blocked on the window since the last frame: in WaitForSwapchain(), acquiring the swapchain or swapping (OpenGL).
+        float swapchain_wait_milliseconds{0.0f};
+    };
+
+    // GPU time of the passes with the same name, measured with timer queries and read back a few frames later so the CPU never
+    // waits for it. Backends without timer queries (Null, SDL3GPU) don't report any.
+    struct PassTiming
+    {
+        static constexpr uint32 WINDOW = 60;
+
+        std::string name;
+        // Average of the last WINDOW measurements.
+        float average_milliseconds{0.0f};
+        float last_milliseconds{0.0f};
+
+        std::array<float, WINDOW> samples{};
+        uint32 sample_count{0};
+        uint32 next_sample{0};
+    };
+
+    // How presented frames replace each other on the window.
+    enum class PresentMode : uint8
+    {
+        // Waits for the vertical blank, never tears and limits the frame rate to the refresh rate.
+        VSYNC,
+        // Never tears or blocks, the newest frame replaces the queued one at the vertical blank.
+        MAILBOX,
+        // Shown right away, lowest latency but may tear.
+        IMMEDIATE
+    };
+
+    // Order in which queued uploads are sent when they don't fit into the upload budget of a frame.
+    enum class UploadPriority : uint8
+    {
+        // Needed right away, meshes that are drawn while their upload is queued are moved to this class as well.
+        VISIBLE,
+        // Loaded ahead of time, only sent when no visible upload is waiting.
+        PREFETCH
     };
 
     Renderer(Renderer& other) = delete;
@@ -296,29 +637,94 @@ class Renderer
 
     static void Render();
     virtual void SwapBuffer() = 0;
+    // Blocks until the window can take another frame when late_swapchain_acquire is set, call it before the input of the frame is read.
+    virtual void WaitForSwapchain() {}
+
+    // Graph the render passes are added to every frame, can be used to look up the transient resources of the frame.
+    static RenderGraph& GetRenderGraph();
 
     virtual void* GetContext() = 0;
 
     virtual void RenderMesh(const Mesh& mesh) = 0;
+
+    // Whether RenderMeshesIndirect() can submit many draws at once (OpenGL 4.5 multi-draw indirect).
+    [[nodiscard]] virtual bool SupportsIndirectDraws() const { return false; }
+    // Draws the commands in a single submission with a pipeline that reads the model matrix per instance instead of from a uniform.
+    // All commands use the textures that are currently set, returns false when the commands need to be drawn one by one.
+    virtual bool RenderMeshesIndirect(const GraphicsShaderPipeline& pipeline, std::span<const DrawCommand> commands) { return false; }
+    // Draws draw_count IndexedIndirectArguments from the offset of a buffer written by compute shaders, with the instanced pipeline
+    // reading its model matrices from the instances buffer (created with VERTEX) at first_instance. Uses the textures that are set,
+    // returns false when the backend can't draw from buffers, nothing is drawn then.
+    virtual bool RenderMeshesIndirectBuffer(
+        const GraphicsShaderPipeline& pipeline, const StorageBuffer& arguments, uint32 offset, uint32 draw_count,
+        const StorageBuffer& instances
+    )
+    {
+        return false;
+    }
     virtual void SetTextureSampler(uint32 slot, const Texture& texture) = 0;
-    virtual void SetUniform(uint32 slot, const void* data, usize size) = 0;
+
+    // Whether compute pipelines and storage buffers can be used (SDL3GPU, OpenGL 4.3).
+    [[nodiscard]] virtual bool SupportsCompute() const { return false; }
+    // Runs the pipeline for the amount of workgroups, only allowed outside of render passes (see RenderPassInterface::Compute()).
+    // Read-only and read-write buffers are bound to the slots of their access in the order of the bindings, see Common.slang.
+    virtual void Dispatch(
+        const ComputeShaderPipeline& pipeline, std::span<const StorageBinding> bindings, uint32 group_count_x, uint32 group_count_y,
+        uint32 group_count_z
+    )
+    {
+    }
+    // Same as Dispatch(), with the three uint32 workgroup counts read from the offset of a buffer created with INDIRECT.
+    virtual void DispatchIndirect(
+        const ComputeShaderPipeline& pipeline, std::span<const StorageBinding> bindings, const StorageBuffer& arguments, uint32 offset
+    )
+    {
+    }
+
+    // Starts creating the pipeline the pass will use on a worker thread, so its first frame doesn't wait for it.
+    // Passes that weren't prewarmed still work, their pipeline is created when they begin.
+    virtual void PrewarmPipeline(const RenderPassInterface& render_pass) {}
+
+    // Copies the data into the frame's uniform memory and pushes it to the given stages.
+    // Data identical to what a stage already has bound to the slot this frame isn't pushed again.
+    void SetUniform(uint32 slot, const void* data, usize size, ShaderStages stages = VERTEX_STAGE);
 
     template <typename Type>
-    static void SetUniform(const uint32 slot, const Type& object)
+    static void SetUniform(const uint32 slot, const Type& object, const ShaderStages stages = VERTEX_STAGE)
     {
-        Instance().SetUniform(slot, static_cast<const void*>(&object), sizeof(object));
+        Instance().SetUniform(slot, static_cast<const void*>(&object), sizeof(object), stages);
     }
 
+    // Packs the meshes in the shared vertex and index buffers, also done automatically when a new mesh doesn't fit otherwise.
+    virtual void DefragmentGeometry() {}
+
     static const BackendShaderInfo& GetBackendShaderInfo() { return backend_shader_info; }
+    static const Statistics& GetStatistics() { return Instance().statistics; }
+    static const std::vector<PassTiming>& GetPassTimings() { return Instance().pass_timings; }
+    static const GeometryAllocator& GetGeometryAllocator() { return Instance().geometry_allocator; }
 
     static inline Handle<RenderTarget> main_target;
 
+    // Bytes sent to the GPU per frame at most, the rest of the uploads wait for the next frames.
+    // Only used by backends that queue their uploads (SDL3GPU), OpenGL uploads right away.
+    static inline usize upload_budget{32 * 1024 * 1024};
+    // Priority of the uploads of meshes and textures created from now on.
+    static inline UploadPriority upload_priority{UploadPriority::VISIBLE};
+
+    // Applied at the start of the next frame, backends use VSYNC when the window doesn't support the mode.
+    static inline PresentMode present_mode{PresentMode::VSYNC};
+    // Waits for the swapchain in WaitForSwapchain() instead of when the first pass draws to the window, so the wait happens before
+    // the input of the frame is read and is no longer part of the input latency. Only used by backends with a swapchain (SDL3GPU).
+    static inline bool late_swapchain_acquire{true};
+
   protected:
     friend class RenderTarget;
     friend class Texture;
     friend class Mesh;
     friend class Shader;
     friend class GraphicsShaderPipeline;
+    friend class ComputeShaderPipeline;
+    friend class StorageBuffer;
     friend class Physics::DebugRenderer;
 
     static inline BackendShaderInfo backend_shader_info; // Needs to be setup in InitBackend.
@@ -327,10 +733,18 @@ class Renderer
     virtual void InitBackend() = 0;
     virtual void ExitBackend() = 0;
     virtual void Update() = 0;
+    // Called after all render passes of the frame were executed.
+    virtual void EndFrame() {}
 
     virtual void BeginRenderPass(const RenderPassInterface& render_pass) = 0;
     virtual void EndRenderPass() = 0;
 
+    // Adds a measurement to the rolling average of the pass, called by the backend once the GPU time is available.
+    void AddPassTiming(std::string_view name, float milliseconds);
+
+    // Only called by SetUniform() for the stages whose data changed.
+    virtual void PushUniform(uint32 slot, const void* data, usize size, ShaderStages stages) = 0;
+
     virtual void CreateTexture(Texture& texture, const uint8* data, const SamplerSettings& sampler_settings) = 0;
     virtual void ResizeTexture(Texture& texture, sint32 new_width, sint32 new_height) = 0;
     virtual void DestroyTexture(Texture& texture) = 0;
@@ -351,11 +765,38 @@ class Renderer
     ) = 0;
     virtual void DestroyShaderPipeline(GraphicsShaderPipeline& pipeline) = 0;
 
+    virtual void CreateComputePipeline(ComputeShaderPipeline& pipeline, const void* data, usize size) = 0;
+    virtual void DestroyComputePipeline(ComputeShaderPipeline& pipeline) = 0;
+
+    // The data is nullptr when the buffer is only written by the GPU, its contents are undefined until then.
+    virtual void CreateStorageBuffer(StorageBuffer& buffer, const void* data) = 0;
+    virtual void UpdateStorageBuffer(StorageBuffer& buffer, const void* data, usize size, usize offset) = 0;
+    virtual void DestroyStorageBuffer(StorageBuffer& buffer) = 0;
+
     Renderer() = default;
     virtual ~Renderer() = default;
 
+    Statistics statistics;
+    // Offsets of the meshes in the shared vertex and index buffers of the backend.
+    GeometryAllocator geometry_allocator;
+
   private:
+    static constexpr uint32 UNIFORM_STAGE_COUNT = 3;
+    static constexpr uint32 MAX_UNIFORM_SLOTS = 8;
+
+    // Data last pushed to a slot of a stage, stored in the uniform allocator.
+    struct UniformShadow
+    {
+        usize offset{0};
+        usize size{0};
+    };
+
     static inline Renderer* renderer;
+
+    std::vector<PassTiming> pass_timings;
+
+    LinearAllocator uniform_allocator{64 * 1024};
+    UniformShadow uniform_shadows[UNIFORM_STAGE_COUNT][MAX_UNIFORM_SLOTS]{};
 };
 
 class Camera
@@ -369,6 +810,11 @@ class Camera
         return Math::PerspectiveZO(fov, aspect, near, far);
     }
 
+    Frustum GetFrustum(const Matrix4& view, const RenderTarget& target) const
+    {
+        return Frustum::FromMatrix(view * GetProjection(target), Renderer::GetBackendName() != "OpenGL");
+    }
+
     float fov{Math::ToRadians(45.0f)};
 
     float near{0.1f};
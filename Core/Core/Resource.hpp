@@ -5,6 +5,7 @@
 #include <unordered_map>
 #include <string>
 
+#include "Tools/Profiler.hpp"
 #include "Tools/TypeNames.hpp"
 
 template <typename Type>
@@ -77,6 +78,7 @@ Handle<ResourceType> Resource::Load(Args&&... args)
     auto existing_resource = Resource::Find<ResourceType>(id);
     if (existing_resource) return existing_resource;
 
+    PROFILE_ZONE_DETAIL("Resource::Load", GetName<ResourceType>());
     auto resource_handle = std::make_shared<ResourceType>(std::forward<Args>(args)...);
     resource_handle->Resource::id = id;
     resource_handle->Resource::type_name = GetName<ResourceType>();
@@ -148,6 +150,7 @@ Handle<ResourceType> FileResource::Load(const std::string& path, Args&&... args)
     auto existing_resource = Resource::Find<ResourceType>(id);
     if (existing_resource) return existing_resource;
 
+    PROFILE_ZONE_DETAIL("FileResource::Load", GetName<ResourceType>());
     auto resource_handle = std::make_shared<ResourceType>(path, std::forward<Args>(args)...);
     resource_handle->Resource::id = id;
     resource_handle->Resource::type_name = GetName<ResourceType>();
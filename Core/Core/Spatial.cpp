@@ -0,0 +1,567 @@
+#include "Spatial.hpp"
+
+#include "Core/Rendering/Renderer.hpp"
+
+#include <algorithm>
+
+namespace
+{
+    // Enlarges leaf boxes so objects can move a bit before they need to be reinserted.
+    constexpr float FAT_BOX_MARGIN = 0.1f;
+    constexpr float FAT_BOX_SCALE = 0.1f;
+
+    BoundingBox Union(const BoundingBox& a, const BoundingBox& b) { return BoundingBox{a.min.cwiseMin(b.min), a.max.cwiseMax(b.max)}; }
+
+    bool Contains(const BoundingBox& outer, const BoundingBox& inner)
+    {
+        return (outer.min.array() <= inner.min.array()).all() && (inner.max.array() <= outer.max.array()).all();
+    }
+
+    bool Overlaps(const BoundingBox& a, const BoundingBox& b)
+    {
+        return (a.min.array() <= b.max.array()).all() && (b.min.array() <= a.max.array()).all();
+    }
+
+    // Half the surface area, used as the cost of a node when choosing where to insert a leaf.
+    float Perimeter(const BoundingBox& box)
+    {
+        const float3 size = box.max - box.min;
+        return size.x() * size.y() + size.y() * size.z() + size.z() * size.x();
+    }
+
+    BoundingBox Fatten(const BoundingBox& box)
+    {
+        const float3 margin = box.GetExtents() * FAT_BOX_SCALE + float3::Constant(FAT_BOX_MARGIN);
+        return BoundingBox{box.min - margin, box.max + margin};
+    }
+
+    // Returns the distance along the ray to the box, or a negative value if it is missed.
+    float RayIntersect(const BoundingBox& box, const float3& origin, const float3& inverse_direction, const float max_distance)
+    {
+        const float3 t0 = (box.min - origin).cwiseProduct(inverse_direction);
+        const float3 t1 = (box.max - origin).cwiseProduct(inverse_direction);
+
+        const float entry = Math::Max(t0.cwiseMin(t1).maxCoeff(), 0.0f);
+        const float exit = Math::Min(t0.cwiseMax(t1).minCoeff(), max_distance);
+
+        return entry <= exit ? entry : -1.0f;
+    }
+
+    enum class Containment : uint8
+    {
+        OUTSIDE,
+        PARTIAL,
+        INSIDE
+    };
+
+    // Only tests the planes in plane_mask, planes the box is completely inside of are removed from the mask.
+    Containment Classify(const Frustum& frustum, const BoundingBox& box, uint8& plane_mask)
+    {
+        const float3 center = box.GetCenter();
+        const float3 extents = box.GetExtents();
+
+        for (uint8 i = 0; i < Frustum::PLANE_COUNT; i++)
+        {
+            const auto bit = static_cast<uint8>(1 << i);
+            if ((plane_mask & bit) == 0) continue;
+
+            const float3 normal = frustum.planes[i].head<3>();
+            const float distance = normal.dot(center) + frustum.planes[i].w();
+            const float radius = extents.dot(normal.cwiseAbs());
+
+            if (distance < -radius) return Containment::OUTSIDE;
+            if (distance >= radius) plane_mask = static_cast<uint8>(plane_mask & ~bit);
+        }
+
+        return plane_mask == 0 ? Containment::INSIDE : Containment::PARTIAL;
+    }
+} // namespace
+
+uint32 BoundingVolumeHierarchy::CreateProxy(const BoundingBox& box, const BoundingSphere& sphere, const uint64 user_data)
+{
+    const uint32 proxy = AllocateNode();
+
+    Node& node = nodes[proxy];
+    node.box = Fatten(box);
+    node.tight_box = box;
+    node.sphere = sphere;
+    node.user_data = user_data;
+    node.height = 0;
+
+    InsertLeaf(proxy);
+    proxy_count++;
+
+    return proxy;
+}
+
+void BoundingVolumeHierarchy::DestroyProxy(const uint32 proxy)
+{
+    RemoveLeaf(proxy);
+    FreeNode(proxy);
+    proxy_count--;
+}
+
+bool BoundingVolumeHierarchy::MoveProxy(const uint32 proxy, const BoundingBox& box, const BoundingSphere& sphere)
+{
+    Node& node = nodes[proxy];
+    node.tight_box = box;
+    node.sphere = sphere;
+
+    if (Contains(node.box, box)) return false;
+
+    RemoveLeaf(proxy);
+    nodes[proxy].box = Fatten(box);
+    InsertLeaf(proxy);
+
+    return true;
+}
+
+void BoundingVolumeHierarchy::Clear()
+{
+    nodes.clear();
+    root = NULL_NODE;
+    free_list = NULL_NODE;
+    proxy_count = 0;
+}
+
+void BoundingVolumeHierarchy::QueryFrustum(const Frustum& frustum, std::vector<uint32>& proxies, Culling::Statistics& statistics) const
+{
+    proxies.clear();
+    partial_leaves.clear();
+    partial_bounds.Clear();
+    statistics = {};
+
+    if (root == NULL_NODE) return;
+
+    constexpr uint8 ALL_PLANES = (1 << Frustum::PLANE_COUNT) - 1;
+
+    // The stack stores pairs of node and the planes that still need to be tested for it.
+    stack.clear();
+    stack.push_back(root);
+    stack.push_back(ALL_PLANES);
+
+    while (!stack.empty())
+    {
+        auto plane_mask = static_cast<uint8>(stack.back());
+        stack.pop_back();
+        const uint32 index = stack.back();
+        stack.pop_back();
+
+        const Node& node = nodes[index];
+
+        if (plane_mask == 0)
+        {
+            if (node.IsLeaf()) { proxies.push_back(index); }
+            else
+            {
+                stack.insert(stack.end(), {node.left, 0, node.right, 0});
+            }
+            continue;
+        }
+
+        if (node.IsLeaf())
+        {
+            // Leaves are tested in one batch afterwards, which is faster than testing their boxes one by one.
+            partial_leaves.push_back(index);
+            partial_bounds.Add(node.sphere);
+            continue;
+        }
+
+        statistics.tests++;
+        if (Classify(frustum, node.box, plane_mask) == Containment::OUTSIDE) continue;
+
+        stack.insert(stack.end(), {node.left, plane_mask, node.right, plane_mask});
+    }
+
+    Culling::CullSpheres(frustum, partial_bounds, visible_indices);
+    for (const uint32 index : visible_indices) { proxies.push_back(partial_leaves[index]); }
+
+    statistics.tests += static_cast<uint32>(partial_leaves.size());
+    statistics.visible = static_cast<uint32>(proxies.size());
+    statistics.culled = static_cast<uint32>(proxy_count - proxies.size());
+}
+
+void BoundingVolumeHierarchy::QueryBox(const BoundingBox& box, std::vector<uint32>& proxies) const
+{
+    proxies.clear();
+    if (root == NULL_NODE) return;
+
+    stack.clear();
+    stack.push_back(root);
+
+    while (!stack.empty())
+    {
+        const uint32 index = stack.back();
+        stack.pop_back();
+
+        const Node& node = nodes[index];
+        if (!Overlaps(node.box, box)) continue;
+
+        if (node.IsLeaf())
+        {
+            if (Overlaps(node.tight_box, box)) proxies.push_back(index);
+        }
+        else
+        {
+            stack.push_back(node.left);
+            stack.push_back(node.right);
+        }
+    }
+}
+
+uint32 BoundingVolumeHierarchy::RayCast(const float3& origin, const float3& direction, const float max_distance, float& distance) const
+{
+    if (root == NULL_NODE) return NULL_NODE;
+
+    // Division by zero results in infinity, which the slab test handles correctly.
+    const float3 inverse_direction = direction.cwiseInverse();
+
+    uint32 closest = NULL_NODE;
+    float closest_distance = max_distance;
+
+    stack.clear();
+    stack.push_back(root);
+
+    while (!stack.empty())
+    {
+        const uint32 index = stack.back();
+        stack.pop_back();
+
+        const Node& node = nodes[index];
+        if (RayIntersect(node.box, origin, inverse_direction, closest_distance) < 0.0f) continue;
+
+        if (node.IsLeaf())
+        {
+            const float hit_distance = RayIntersect(node.tight_box, origin, inverse_direction, closest_distance);
+            if (hit_distance >= 0.0f)
+            {
+                closest = index;
+                closest_distance = hit_distance;
+            }
+        }
+        else
+        {
+            stack.push_back(node.left);
+            stack.push_back(node.right);
+        }
+    }
+
+    if (closest != NULL_NODE) distance = closest_distance;
+    return closest;
+}
+
+uint32 BoundingVolumeHierarchy::AllocateNode()
+{
+    if (free_list == NULL_NODE)
+    {
+        nodes.emplace_back();
+        return static_cast<uint32>(nodes.size() - 1);
+    }
+
+    const uint32 node = free_list;
+    free_list = nodes[node].parent;
+    nodes[node] = Node{};
+
+    return node;
+}
+
+void BoundingVolumeHierarchy::FreeNode(const uint32 node)
+{
+    nodes[node].parent = free_list;
+    nodes[node].height = -1;
+    free_list = node;
+}
+
+void BoundingVolumeHierarchy::InsertLeaf(const uint32 leaf)
+{
+    if (root == NULL_NODE)
+    {
+        root = leaf;
+        nodes[root].parent = NULL_NODE;
+        return;
+    }
+
+    // Find the best sibling by walking down the tree, choosing the child with the lowest increase in surface area.
+    const BoundingBox leaf_box = nodes[leaf].box;
+    uint32 index = root;
+    while (!nodes[index].IsLeaf())
+    {
+        const Node& node = nodes[index];
+
+        const float area = Perimeter(node.box);
+        const float combined_area = Perimeter(Union(node.box, leaf_box));
+
+        // Cost of creating a new parent for this node and the new leaf.
+        const float cost = 2.0f * combined_area;
+        // Minimum cost of pushing the leaf further down the tree.
+        const float inheritance_cost = 2.0f * (combined_area - area);
+
+        auto descend_cost = [&](const uint32 child) {
+            const float new_area = Perimeter(Union(leaf_box, nodes[child].box));
+            if (nodes[child].IsLeaf()) return new_area + inheritance_cost;
+            return new_area - Perimeter(nodes[child].box) + inheritance_cost;
+        };
+
+        const float left_cost = descend_cost(node.left);
+        const float right_cost = descend_cost(node.right);
+
+        if (cost < left_cost && cost < right_cost) break;
+
+        index = left_cost < right_cost ? node.left : node.right;
+    }
+
+    const uint32 sibling = index;
+    const uint32 old_parent = nodes[sibling].parent;
+    const uint32 new_parent = AllocateNode();
+
+    nodes[new_parent].parent = old_parent;
+    nodes[new_parent].box = Union(leaf_box, nodes[sibling].box);
+    nodes[new_parent].height = nodes[sibling].height + 1;
+    nodes[new_parent].left = sibling;
+    nodes[new_parent].right = leaf;
+    nodes[sibling].parent = new_parent;
+    nodes[leaf].parent = new_parent;
+
+    if (old_parent == NULL_NODE) { root = new_parent; }
+    else if (nodes[old_parent].left == sibling) { nodes[old_parent].left = new_parent; }
+    else { nodes[old_parent].right = new_parent; }
+
+    RefitAncestors(nodes[leaf].parent);
+}
+
+void BoundingVolumeHierarchy::RemoveLeaf(const uint32 leaf)
+{
+    if (leaf == root)
+    {
+        root = NULL_NODE;
+        return;
+    }
+
+    const uint32 parent = nodes[leaf].parent;
+    const uint32 grand_parent = nodes[parent].parent;
+    const uint32 sibling = nodes[parent].left == leaf ? nodes[parent].right : nodes[parent].left;
+
+    FreeNode(parent);
+
+    if (grand_parent == NULL_NODE)
+    {
+        root = sibling;
+        nodes[sibling].parent = NULL_NODE;
+        return;
+    }
+
+    if (nodes[grand_parent].left == parent) { nodes[grand_parent].left = sibling; }
+    else { nodes[grand_parent].right = sibling; }
+    nodes[sibling].parent = grand_parent;
+
+    RefitAncestors(grand_parent);
+}
+
+void BoundingVolumeHierarchy::RefitAncestors(uint32 node)
+{
+    while (node != NULL_NODE)
+    {
+        node = Balance(node);
+
+        Node& current = nodes[node];
+        const Node& left = nodes[current.left];
+        const Node& right = nodes[current.right];
+
+        current.height = 1 + std::max(left.height, right.height);
+        current.box = Union(left.box, right.box);
+
+        node = current.parent;
+    }
+}
+
+uint32 BoundingVolumeHierarchy::Balance(const uint32 a)
+{
+    // Rotates the higher child of a up if the subtree is unbalanced, returns the new root of the subtree.
+    Node& node_a = nodes[a];
+    if (node_a.IsLeaf() || node_a.height < 2) return a;
+
+    const uint32 b = node_a.left;
+    const uint32 c = node_a.right;
+    Node& node_b = nodes[b];
+    Node& node_c = nodes[c];
+
+    const sint32 balance = node_c.height - node_b.height;
+
+    if (balance > 1)
+    {
+        const uint32 f = node_c.left;
+        const uint32 g = node_c.right;
+
+        node_c.left = a;
+        node_c.parent = node_a.parent;
+        node_a.parent = c;
+
+        if (node_c.parent == NULL_NODE) { root = c; }
+        else if (nodes[node_c.parent].left == a) { nodes[node_c.parent].left = c; }
+        else { nodes[node_c.parent].right = c; }
+
+        const bool f_higher = nodes[f].height > nodes[g].height;
+        const uint32 keep = f_higher ? f : g;
+        const uint32 move = f_higher ? g : f;
+
+        node_c.right = keep;
+        node_a.right = move;
+        nodes[move].parent = a;
+
+        node_a.box = Union(node_b.box, nodes[move].box);
+        node_c.box = Union(node_a.box, nodes[keep].box);
+        node_a.height = 1 + std::max(node_b.height, nodes[move].height);
+        node_c.height = 1 + std::max(node_a.height, nodes[keep].height);
+
+        return c;
+    }
+
+    if (balance < -1)
+    {
+        const uint32 d = node_b.left;
+        const uint32 e = node_b.right;
+
+        node_b.left = a;
+        node_b.parent = node_a.parent;
+        node_a.parent = b;
+
+        if (node_b.parent == NULL_NODE) { root = b; }
+        else if (nodes[node_b.parent].left == a) { nodes[node_b.parent].left = b; }
+        else { nodes[node_b.parent].right = b; }
+
+        const bool d_higher = nodes[d].height > nodes[e].height;
+        const uint32 keep = d_higher ? d : e;
+        const uint32 move = d_higher ? e : d;
+
+        node_b.right = keep;
+        node_a.left = move;
+        nodes[move].parent = a;
+
+        node_a.box = Union(node_c.box, nodes[move].box);
+        node_b.box = Union(node_a.box, nodes[keep].box);
+        node_a.height = 1 + std::max(node_c.height, nodes[move].height);
+        node_b.height = 1 + std::max(node_a.height, nodes[keep].height);
+
+        return b;
+    }
+
+    return a;
+}
+
+namespace
+{
+    BoundingVolumeHierarchy hierarchy;
+
+    std::vector<uint32> dirty_proxies;
+    std::vector<uint32> query_proxies;
+    uint64 version = 0;
+
+    void ComputeWorldBounds(const Transform& transform, const Mesh& mesh, BoundingBox& box, BoundingSphere& sphere)
+    {
+        const Matrix4& matrix = transform.GetMatrix();
+        box = Culling::TransformBox(mesh.GetBoundingBox(), matrix);
+        sphere = Culling::TransformSphere(mesh.GetBoundingSphere(), matrix);
+    }
+
+    void ToEntities(const std::vector<uint32>& proxies, std::vector<ECS::Entity>& entities)
+    {
+        entities.clear();
+        entities.reserve(proxies.size());
+        for (const uint32 proxy : proxies) { entities.push_back(ECS::GetEntity(hierarchy.GetUserData(proxy))); }
+    }
+} // namespace
+
+namespace Spatial
+{
+    void Init()
+    {
+        flecs::world& world = ECS::GetWorld();
+
+        world.observer<Transform, const Handle<Mesh>>()
+            .event(flecs::OnSet)
+            .each([](const flecs::entity entity, Transform& transform, const Handle<Mesh>& mesh) {
+                if (transform.GetSpatialProxy() != Transform::NO_SPATIAL_PROXY)
+                {
+                    MarkDirty(transform.GetSpatialProxy());
+                    return;
+                }
+
+                BoundingBox box;
+                BoundingSphere sphere;
+                ComputeWorldBounds(transform, *mesh, box, sphere);
+                transform.SetSpatialProxy(hierarchy.CreateProxy(box, sphere, entity.id()));
+                version++;
+            });
+
+        world.observer<Transform, const Handle<Mesh>>().event(flecs::OnRemove).each([](Transform& transform, const Handle<Mesh>&) {
+            if (transform.GetSpatialProxy() == Transform::NO_SPATIAL_PROXY) return;
+
+            // The proxy might be reused by another entity, so it can't stay in the dirty list.
+            std::erase(dirty_proxies, transform.GetSpatialProxy());
+            hierarchy.DestroyProxy(transform.GetSpatialProxy());
+            transform.SetSpatialProxy(Transform::NO_SPATIAL_PROXY);
+            version++;
+        });
+    }
+
+    void Exit()
+    {
+        hierarchy.Clear();
+        dirty_proxies.clear();
+        version++;
+    }
+
+    void Update()
+    {
+        if (dirty_proxies.empty()) return;
+
+        // Proxies can be marked multiple times per frame, sorting makes it easy to skip the duplicates.
+        std::ranges::sort(dirty_proxies);
+        const auto [first, last] = std::ranges::unique(dirty_proxies);
+        dirty_proxies.erase(first, last);
+        if (!dirty_proxies.empty()) version++;
+
+        for (const uint32 proxy : dirty_proxies)
+        {
+            const ECS::Entity entity = ECS::GetEntity(hierarchy.GetUserData(proxy));
+            const auto& transform = entity.GetComponent<Transform>();
+            const auto& mesh = entity.GetComponent<Handle<Mesh>>();
+
+            BoundingBox box;
+            BoundingSphere sphere;
+            ComputeWorldBounds(transform, *mesh, box, sphere);
+            (void)hierarchy.MoveProxy(proxy, box, sphere);
+        }
+
+        dirty_proxies.clear();
+    }
+
+    void MarkDirty(const uint32 proxy) { dirty_proxies.push_back(proxy); }
+
+    uint64 GetVersion() { return version; }
+
+    void QueryFrustum(const Frustum& frustum, std::vector<ECS::Entity>& entities, Culling::Statistics& statistics)
+    {
+        hierarchy.QueryFrustum(frustum, query_proxies, statistics);
+        ToEntities(query_proxies, entities);
+    }
+
+    void QueryBox(const BoundingBox& box, std::vector<ECS::Entity>& entities)
+    {
+        hierarchy.QueryBox(box, query_proxies);
+        ToEntities(query_proxies, entities);
+    }
+
+    bool RayCast(const float3& origin, const float3& direction, RayHit& hit, const float max_distance)
+    {
+        float distance = 0.0f;
+        const uint32 proxy = hierarchy.RayCast(origin, direction, max_distance, distance);
+        if (proxy == BoundingVolumeHierarchy::NULL_NODE) return false;
+
+        hit.entity = ECS::GetEntity(hierarchy.GetUserData(proxy));
+        hit.distance = distance;
+        return true;
+    }
+
+    const BoundingVolumeHierarchy& GetHierarchy() { return hierarchy; }
+} // namespace Spatial
\ No newline at end of file
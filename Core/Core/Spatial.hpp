@@ -0,0 +1,107 @@
+#pragma once
+
+#include "Core/ECS.hpp"
+#include "Core/Rendering/Culling.hpp"
+
+#include <vector>
+
+// Dynamic AABB tree, leaves store a slightly enlarged (fat) box so small movements don't require the tree to be restructured.
+// Based on the dynamic tree of Box2D: https://github.com/erincatto/box2d
+class BoundingVolumeHierarchy
+{
+  public:
+    static constexpr uint32 NULL_NODE = ~0u;
+
+    uint32 CreateProxy(const BoundingBox& box, const BoundingSphere& sphere, uint64 user_data);
+    void DestroyProxy(uint32 proxy);
+
+    /// @brief Updates the bounds of a proxy, the proxy is only reinserted when it moved outside of its fat box.
+    /// @return True if the proxy was reinserted.
+    bool MoveProxy(uint32 proxy, const BoundingBox& box, const BoundingSphere& sphere);
+
+    void Clear();
+
+    [[nodiscard]] uint64 GetUserData(const uint32 proxy) const { return nodes[proxy].user_data; }
+    [[nodiscard]] usize GetProxyCount() const { return proxy_count; }
+    [[nodiscard]] sint32 GetHeight() const { return root == NULL_NODE ? 0 : nodes[root].height; }
+
+    // Subtrees that are completely inside the frustum are accepted without testing, partially visible leaves are tested with SIMD.
+    void QueryFrustum(const Frustum& frustum, std::vector<uint32>& proxies, Culling::Statistics& statistics) const;
+    void QueryBox(const BoundingBox& box, std::vector<uint32>& proxies) const;
+
+    /// @brief Finds the closest proxy box hit by the ray, direction needs to be normalized.
+    /// @return The hit proxy or NULL_NODE, distance is set to the distance along the ray when something was hit.
+    uint32 RayCast(const float3& origin, const float3& direction, float max_distance, float& distance) const;
+
+  private:
+    struct Node
+    {
+        [[nodiscard]] bool IsLeaf() const { return left == NULL_NODE; }
+
+        BoundingBox box;
+        // Only used by leaves, the exact bounds of the proxy.
+        BoundingBox tight_box;
+        BoundingSphere sphere;
+
+        uint64 user_data{0};
+
+        // Next node in the free list when the node is not in use.
+        uint32 parent{NULL_NODE};
+        uint32 left{NULL_NODE};
+        uint32 right{NULL_NODE};
+
+        // Leaves have height 0, free nodes -1.
+        sint32 height{-1};
+    };
+
+    uint32 AllocateNode();
+    void FreeNode(uint32 node);
+
+    void InsertLeaf(uint32 leaf);
+    void RemoveLeaf(uint32 leaf);
+    void RefitAncestors(uint32 node);
+    uint32 Balance(uint32 node);
+
+    std::vector<Node> nodes;
+    uint32 root{NULL_NODE};
+    uint32 free_list{NULL_NODE};
+    usize proxy_count{0};
+
+    // Scratch memory for the queries, kept to avoid reallocating every frame.
+    mutable std::vector<uint32> stack;
+    mutable std::vector<uint32> partial_leaves;
+    mutable Culling::SphereBatch partial_bounds;
+    mutable std::vector<uint32> visible_indices;
+};
+
+// Spatial hierarchy of all entities with a Transform and a mesh, used for culling, picking and region queries.
+namespace Spatial
+{
+    struct RayHit
+    {
+        ECS::Entity entity;
+        float distance{0.0f};
+    };
+
+    // Registers observers on the ECS world to track entities, needs to be called after ECS::Init().
+    void Init();
+
+    void Exit();
+
+    // Refits the proxies of entities whose transform changed since the last update, the queries only see the bounds of the last
+    // update. Needs to be called after moving entities and before querying, on the main thread like the moves. The matrices of
+    // the moved entities are computed here as well, so anything reading them afterwards doesn't write to the transforms.
+    void Update();
+
+    void MarkDirty(uint32 proxy);
+
+    // Changes whenever an entity with a mesh is added, removed or moved, caches of the entities compare it to know when to rebuild.
+    [[nodiscard]] uint64 GetVersion();
+
+    void QueryFrustum(const Frustum& frustum, std::vector<ECS::Entity>& entities, Culling::Statistics& statistics);
+    void QueryBox(const BoundingBox& box, std::vector<ECS::Entity>& entities);
+
+    [[nodiscard]] bool RayCast(const float3& origin, const float3& direction, RayHit& hit, float max_distance = 1000.0f);
+
+    [[nodiscard]] const BoundingVolumeHierarchy& GetHierarchy();
+} // namespace Spatial
\ No newline at end of file
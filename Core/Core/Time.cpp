@@ -1,17 +1,45 @@
 #include "Time.hpp"
 
 #include <chrono>
+#include <cmath>
+#include <thread>
 
 namespace
 {
     using Timer = std::chrono::high_resolution_clock;
     using TimePoint = std::chrono::time_point<std::chrono::high_resolution_clock>;
     using seconds =  std::chrono::duration<float>;
+    using milliseconds = std::chrono::duration<float, std::milli>;
 
     TimePoint last_time{Timer::now()};
     TimePoint current_time{last_time};
 
     float delta_time{0.0f};
+
+    float frame_limit{0.0f};
+    Time::FrameStatistics frame_statistics;
+
+    // Sleeps are requested in steps of this length, each one is measured to learn how much the OS oversleeps.
+    constexpr std::chrono::milliseconds SLEEP_STEP{1};
+    // Weight of a new measurement in the running averages, so the estimate follows changes of the system load.
+    constexpr double ESTIMATE_WEIGHT = 1.0 / 16.0;
+
+    // Running mean and variance of how long a sleep step really takes, in seconds.
+    double sleep_mean = 2e-3;
+    double sleep_variance = 0.0;
+
+    void AddSleepMeasurement(const double duration)
+    {
+        const double difference = duration - sleep_mean;
+        sleep_mean += ESTIMATE_WEIGHT * difference;
+        sleep_variance = (1.0 - ESTIMATE_WEIGHT) * (sleep_variance + ESTIMATE_WEIGHT * difference * difference);
+    }
+
+    // Sleeping stops once less than a pessimistic sleep step is left, the remaining time is spun.
+    std::chrono::duration<double> GetSleepThreshold()
+    {
+        return std::chrono::duration<double>(sleep_mean + 2.0 * std::sqrt(sleep_variance));
+    }
 } // namespace
 
 namespace Time
@@ -22,7 +50,46 @@ namespace Time
         current_time = Timer::now();
 
         delta_time = std::chrono::duration_cast<seconds>(current_time - last_time).count();
+        frame_statistics.frame_milliseconds = std::chrono::duration_cast<milliseconds>(current_time - last_time).count();
     }
 
     float GetDeltaTime() { return delta_time; }
+
+    void SetFrameLimit(const float frames_per_second) { frame_limit = frames_per_second > 0.0f ? frames_per_second : 0.0f; }
+
+    float GetFrameLimit() { return frame_limit; }
+
+    void WaitForNextFrame()
+    {
+        const TimePoint submitted = Timer::now();
+        frame_statistics.submit_latency_milliseconds = std::chrono::duration_cast<milliseconds>(submitted - current_time).count();
+        frame_statistics.sleep_milliseconds = 0.0f;
+        frame_statistics.spin_milliseconds = 0.0f;
+        frame_statistics.limiter_error_milliseconds = 0.0f;
+        if (frame_limit == 0.0f) return;
+
+        // Scheduled from the start of the frame, so the time spent on the frame itself is part of the period.
+        const auto period = std::chrono::duration<double>(1.0 / static_cast<double>(frame_limit));
+        const TimePoint next_frame = current_time + std::chrono::duration_cast<Timer::duration>(period);
+        if (submitted >= next_frame) return;
+
+        TimePoint now = submitted;
+        while (next_frame - now > GetSleepThreshold())
+        {
+            const TimePoint sleep_start = now;
+            std::this_thread::sleep_for(SLEEP_STEP);
+            now = Timer::now();
+
+            AddSleepMeasurement(std::chrono::duration<double>(now - sleep_start).count());
+        }
+        const TimePoint spin_start = now;
+
+        while (now < next_frame) { now = Timer::now(); }
+
+        frame_statistics.sleep_milliseconds = std::chrono::duration_cast<milliseconds>(spin_start - submitted).count();
+        frame_statistics.spin_milliseconds = std::chrono::duration_cast<milliseconds>(now - spin_start).count();
+        frame_statistics.limiter_error_milliseconds = std::chrono::duration_cast<milliseconds>(now - next_frame).count();
+    }
+
+    const FrameStatistics& GetFrameStatistics() { return frame_statistics; }
 } // namespace Time
\ No newline at end of file
@@ -2,7 +2,33 @@
 
 namespace Time
 {
+    // Timings of the last completed frame of the main loop, in milliseconds.
+    struct FrameStatistics
+    {
+        // Time between the starts of the last two frames.
+        float frame_milliseconds{0.0f};
+        // From the start of the frame, right after its input was read, until it was submitted. Doesn't include the time the GPU
+        // takes to render and present it, which the backends don't report.
+        float submit_latency_milliseconds{0.0f};
+        // Time WaitForNextFrame() slept and then spun to hit the start of the next frame.
+        float sleep_milliseconds{0.0f};
+        float spin_milliseconds{0.0f};
+        // How late the limiter woke up, stays around a few microseconds unless the thread was preempted while spinning.
+        float limiter_error_milliseconds{0.0f};
+    };
+
+    // Starts a new frame, needs to be called right after the input of the frame was read.
     void Update();
 
     float GetDeltaTime();
+
+    // Frames per second WaitForNextFrame() limits the main loop to, 0 disables the limiter.
+    void SetFrameLimit(float frames_per_second);
+    float GetFrameLimit();
+
+    /// @brief Called once the frame was submitted, waits until the next frame is due when a frame limit is set.
+    /// Sleeps for most of the wait and spins the rest, the sleep is cut short by its measured overshoot so the wakeup is precise.
+    void WaitForNextFrame();
+
+    const FrameStatistics& GetFrameStatistics();
 }
\ No newline at end of file
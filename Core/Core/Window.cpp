@@ -58,7 +58,7 @@ namespace Window
                 {
                     width = window_event.data1;
                     height = window_event.data2;
-                    Renderer::main_target->Resize(width, height);
+                    Renderer::main_target->RequestSize(width, height);
                 }
                 break;
             }
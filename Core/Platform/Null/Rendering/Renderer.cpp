@@ -0,0 +1,280 @@
+#include "Core/Rendering/Renderer.hpp"
+#include "Renderer.hpp"
+
+#include "Tools/Logging.hpp"
+#include "Core/Rendering/RenderPassInterface.hpp"
+
+#include <array>
+
+namespace
+{
+    std::vector<uint8> command_stream;
+    uint32 command_count = 0;
+
+    NullRenderer::Counters counters;
+
+    // Textures get increasing IDs in creation order, so the stream of a scene loaded the same way is the same every run.
+    uint32 next_texture_id = 1;
+
+    // Texture bound to every slot, binds of the texture that is already bound are skipped like the GPU backends do.
+    constexpr uint32 TEXTURE_SLOTS = 16;
+    std::array<uint32, TEXTURE_SLOTS> bound_textures{};
+
+    template <typename Type>
+    void Write(const Type& value)
+    {
+        const auto* bytes = reinterpret_cast<const uint8*>(&value);
+        command_stream.insert(command_stream.end(), bytes, bytes + sizeof(Type));
+    }
+
+    template <typename... Types>
+    void Record(const NullRenderer::Command command, const Types&... values)
+    {
+        Write(command);
+        (Write(values), ...);
+        command_count++;
+    }
+
+    void WriteBindings(const std::span<const StorageBinding> bindings)
+    {
+        for (const auto& [buffer, read_write] : bindings)
+        {
+            Write(buffer->Resource::GetID());
+            Write(static_cast<uint8>(read_write));
+        }
+    }
+
+    usize GetTextureSize(const sint32 width, const sint32 height)
+    {
+        // Both formats take 4 bytes per pixel, D24 is padded like on most GPUs.
+        return static_cast<usize>(width) * static_cast<usize>(height) * 4;
+    }
+} // namespace
+
+NullRenderer::NullRenderer() : Renderer{}
+{
+    // The shaders are never compiled, but are still loaded from the files the OpenGL backend uses.
+    backend_shader_info = {
+        .file_extension = ".glsl", .binary = false, .profile = "glsl_150", .invert_y = true, .compute_profile = "glsl_430"
+    };
+}
+
+void NullRenderer::InitBackend()
+{
+    geometry_allocator.Reset();
+
+    Resource::Load<GraphicsShaderPipeline>(
+        "Assets/Shaders/TestShader.slang", ShaderSettings{Shader::VERTEX, 0, 0, 3}, ShaderSettings{Shader::FRAGMENT, 1, 0, 0}
+    );
+}
+
+void NullRenderer::ExitBackend()
+{
+    command_stream.clear();
+    command_stream.shrink_to_fit();
+    command_count = 0;
+}
+
+void NullRenderer::Update()
+{
+    command_stream.clear();
+    command_count = 0;
+    bound_textures.fill(0);
+}
+
+void NullRenderer::SwapBuffer() { counters.frames++; }
+
+void* NullRenderer::GetContext() { return nullptr; }
+
+void NullRenderer::RenderMesh(const Mesh& mesh)
+{
+    if (!GeometryAllocator::IsAllocated(mesh)) return;
+
+    Record(Command::DRAW, mesh.GetIndicesCount(), mesh.first_index, mesh.base_vertex);
+    statistics.draw_calls++;
+}
+
+bool NullRenderer::RenderMeshesIndirect(const GraphicsShaderPipeline&, const std::span<const DrawCommand> commands)
+{
+    if (commands.empty()) return false;
+
+    Record(Command::DRAW_INDIRECT, static_cast<uint32>(commands.size()));
+    for (const DrawCommand& command : commands)
+    {
+        const Mesh& mesh = *command.mesh;
+        Write(mesh.GetIndicesCount());
+        Write(mesh.first_index);
+        Write(mesh.base_vertex);
+    }
+
+    statistics.draw_calls++;
+    return true;
+}
+
+bool NullRenderer::RenderMeshesIndirectBuffer(
+    const GraphicsShaderPipeline&, const StorageBuffer& arguments, const uint32 offset, const uint32 draw_count,
+    const StorageBuffer& instances
+)
+{
+    if (draw_count == 0) return false;
+
+    Record(Command::DRAW_INDIRECT_BUFFER, arguments.Resource::GetID(), offset, draw_count, instances.Resource::GetID());
+    statistics.draw_calls++;
+    return true;
+}
+
+void NullRenderer::Dispatch(
+    const ComputeShaderPipeline& pipeline, const std::span<const StorageBinding> bindings, const uint32 group_count_x,
+    const uint32 group_count_y, const uint32 group_count_z
+)
+{
+    Record(
+        Command::DISPATCH, pipeline.Resource::GetID(), group_count_x, group_count_y, group_count_z, static_cast<uint32>(bindings.size())
+    );
+    WriteBindings(bindings);
+    statistics.dispatches++;
+}
+
+void NullRenderer::DispatchIndirect(
+    const ComputeShaderPipeline& pipeline, const std::span<const StorageBinding> bindings, const StorageBuffer& arguments,
+    const uint32 offset
+)
+{
+    Record(
+        Command::DISPATCH_INDIRECT, pipeline.Resource::GetID(), arguments.Resource::GetID(), offset, static_cast<uint32>(bindings.size())
+    );
+    WriteBindings(bindings);
+    statistics.dispatches++;
+}
+
+void NullRenderer::SetTextureSampler(const uint32 slot, const Texture& texture)
+{
+    if (slot < TEXTURE_SLOTS)
+    {
+        if (bound_textures[slot] == texture.texture.id)
+        {
+            statistics.skipped_state_changes++;
+            return;
+        }
+        bound_textures[slot] = texture.texture.id;
+    }
+
+    Record(Command::SET_TEXTURE, slot, texture.texture.id);
+    statistics.state_changes++;
+}
+
+std::span<const uint8> NullRenderer::GetCommandStream() { return command_stream; }
+
+uint32 NullRenderer::GetCommandCount() { return command_count; }
+
+uint64 NullRenderer::GetCommandStreamHash()
+{
+    uint64 hash = 14695981039346656037ull;
+    for (const uint8 byte : command_stream)
+    {
+        hash ^= byte;
+        hash *= 1099511628211ull;
+    }
+
+    return hash;
+}
+
+const NullRenderer::Counters& NullRenderer::GetCounters() { return counters; }
+
+void NullRenderer::BeginRenderPass(const RenderPassInterface& render_pass)
+{
+    const Handle<RenderTarget>& render_target = render_pass.GetTarget();
+
+    Record(
+        Command::BEGIN_RENDER_PASS, render_pass.graphics_pipeline->Resource::GetID(), render_pass.pipeline_state.GetHash(),
+        render_target->GetWidth(), render_target->GetHeight()
+    );
+    statistics.state_changes++;
+}
+
+void NullRenderer::EndRenderPass() { Record(Command::END_RENDER_PASS); }
+
+void NullRenderer::PushUniform(const uint32 slot, const void* data, const usize size, const ShaderStages stages)
+{
+    Record(Command::PUSH_UNIFORM, slot, static_cast<uint8>(stages), static_cast<uint32>(size));
+
+    const auto* bytes = static_cast<const uint8*>(data);
+    command_stream.insert(command_stream.end(), bytes, bytes + size);
+}
+
+void NullRenderer::CreateTexture(Texture& texture, const uint8*, const SamplerSettings&)
+{
+    texture.texture.id = next_texture_id++;
+
+    counters.textures++;
+    counters.texture_bytes += GetTextureSize(texture.GetWidth(), texture.GetHeight());
+}
+
+void NullRenderer::ResizeTexture(Texture& texture, const sint32 new_width, const sint32 new_height)
+{
+    counters.texture_bytes -= GetTextureSize(texture.GetWidth(), texture.GetHeight());
+    counters.texture_bytes += GetTextureSize(new_width, new_height);
+}
+
+void NullRenderer::DestroyTexture(Texture& texture)
+{
+    counters.textures--;
+    counters.texture_bytes -= GetTextureSize(texture.GetWidth(), texture.GetHeight());
+}
+
+void NullRenderer::CreateRenderTarget(RenderTarget&) { counters.render_targets++; }
+
+void NullRenderer::DestroyRenderTarget(RenderTarget&) { counters.render_targets--; }
+
+void NullRenderer::CreateMesh(Mesh& mesh, const std::vector<Vertex>& vertices, const std::vector<uint32>& indices)
+{
+    // Nothing needs to be copied, so the allocator only ever grows instead of defragmenting.
+    if (!geometry_allocator.Allocate(mesh))
+    {
+        const auto [vertex_capacity, index_capacity] = geometry_allocator.GetGrownCapacities(mesh);
+        geometry_allocator.Grow(vertex_capacity, index_capacity);
+
+        if (!geometry_allocator.Allocate(mesh))
+        {
+            Log::Error("Failed to allocate {} vertices and {} indices", mesh.GetVerticesCount(), mesh.GetIndicesCount());
+            return;
+        }
+    }
+
+    counters.meshes++;
+    counters.mesh_bytes += vertices.size() * sizeof(Vertex) + indices.size() * sizeof(uint32);
+}
+
+void NullRenderer::DestroyMesh(Mesh& mesh)
+{
+    if (!GeometryAllocator::IsAllocated(mesh)) return;
+
+    geometry_allocator.Free(mesh);
+
+    counters.meshes--;
+    counters.mesh_bytes -= static_cast<usize>(mesh.GetVerticesCount()) * sizeof(Vertex) + mesh.GetIndicesCount() * sizeof(uint32);
+}
+
+void NullRenderer::CreateShader(Shader&, const void*, usize) { counters.shaders++; }
+
+void NullRenderer::DestroyShader(Shader&) { counters.shaders--; }
+
+void NullRenderer::CreateShaderPipeline(GraphicsShaderPipeline&, const Handle<Shader>&, const Handle<Shader>&) { counters.pipelines++; }
+
+void NullRenderer::DestroyShaderPipeline(GraphicsShaderPipeline&) { counters.pipelines--; }
+
+void NullRenderer::CreateComputePipeline(ComputeShaderPipeline&, const void*, usize) { counters.pipelines++; }
+
+void NullRenderer::DestroyComputePipeline(ComputeShaderPipeline&) { counters.pipelines--; }
+
+void NullRenderer::CreateStorageBuffer(StorageBuffer& buffer, const void*)
+{
+    counters.storage_buffers++;
+    counters.storage_bytes += buffer.GetSize();
+}
+
+void NullRenderer::DestroyStorageBuffer(StorageBuffer& buffer)
+{
+    counters.storage_buffers--;
+    counters.storage_bytes -= buffer.GetSize();
+}
\ No newline at end of file
@@ -0,0 +1,120 @@
+#pragma once
+
+#include "Core/Rendering/Renderer.hpp"
+
+// Backend that doesn't touch a GPU, it records the commands of every frame into a compact byte stream and counts resources instead.
+// Used to benchmark and regression test the CPU side of rendering (culling, sorting, uniform traffic) on machines without a display.
+class NullRenderer final : public Renderer
+{
+  public:
+    // Every command is the command byte followed by its values, written back to back without padding.
+    enum class Command : uint8
+    {
+        // uint64 pipeline resource ID, uint64 pipeline state hash, sint32 target width, sint32 target height.
+        BEGIN_RENDER_PASS,
+        END_RENDER_PASS,
+        // uint32 slot, uint8 stages, uint32 size, followed by the size bytes of data.
+        PUSH_UNIFORM,
+        // uint32 slot, uint32 texture.
+        SET_TEXTURE,
+        // uint32 index count, uint32 first index, sint32 base vertex.
+        DRAW,
+        // uint32 draw count, followed by the values of a DRAW per draw.
+        DRAW_INDIRECT,
+        // uint64 pipeline resource ID, uint32 group counts x, y and z, uint32 binding count, followed by a binding per binding.
+        // A binding is the uint64 buffer resource ID and uint8 1 when it is read-write.
+        DISPATCH,
+        // uint64 pipeline resource ID, uint64 arguments buffer resource ID, uint32 offset, uint32 binding count, followed by the bindings.
+        DISPATCH_INDIRECT,
+        // uint64 arguments buffer resource ID, uint32 offset, uint32 draw count, uint64 instances buffer resource ID.
+        DRAW_INDIRECT_BUFFER
+    };
+
+    // Resources alive and frames rendered, the counters of the current frame are in Renderer::Statistics.
+    struct Counters
+    {
+        uint64 frames{0};
+
+        uint32 meshes{0};
+        uint32 textures{0};
+        uint32 render_targets{0};
+        uint32 shaders{0};
+        uint32 pipelines{0};
+        uint32 storage_buffers{0};
+
+        usize mesh_bytes{0};
+        usize texture_bytes{0};
+        usize storage_bytes{0};
+    };
+
+    NullRenderer();
+    ~NullRenderer() override = default;
+
+    constexpr usize WindowFlags() override { return 0; }
+
+    void InitBackend() override;
+    void ExitBackend() override;
+
+    void Update() override;
+    void SwapBuffer() override;
+
+    void* GetContext() override;
+
+    void RenderMesh(const Mesh& mesh) override;
+    [[nodiscard]] bool SupportsIndirectDraws() const override { return true; }
+    bool RenderMeshesIndirect(const GraphicsShaderPipeline& pipeline, std::span<const DrawCommand> commands) override;
+    bool RenderMeshesIndirectBuffer(
+        const GraphicsShaderPipeline& pipeline, const StorageBuffer& arguments, uint32 offset, uint32 draw_count,
+        const StorageBuffer& instances
+    ) override;
+    void SetTextureSampler(uint32 slot, const Texture& texture) override;
+
+    [[nodiscard]] bool SupportsCompute() const override { return true; }
+    void Dispatch(
+        const ComputeShaderPipeline& pipeline, std::span<const StorageBinding> bindings, uint32 group_count_x, uint32 group_count_y,
+        uint32 group_count_z
+    ) override;
+    void DispatchIndirect(
+        const ComputeShaderPipeline& pipeline, std::span<const StorageBinding> bindings, const StorageBuffer& arguments, uint32 offset
+    ) override;
+
+    // Commands of the frame being rendered, they stay available after SwapBuffer() until the next frame starts.
+    [[nodiscard]] static std::span<const uint8> GetCommandStream();
+    [[nodiscard]] static uint32 GetCommandCount();
+    // FNV-1a hash of the command stream, frames rendering the same scene the same way have the same hash.
+    [[nodiscard]] static uint64 GetCommandStreamHash();
+    [[nodiscard]] static const Counters& GetCounters();
+
+  private:
+    void BeginRenderPass(const RenderPassInterface& render_pass) override;
+    void EndRenderPass() override;
+
+    void PushUniform(uint32 slot, const void* data, usize size, ShaderStages stages) override;
+
+    void CreateTexture(Texture& texture, const uint8* data, const SamplerSettings& sampler_settings) override;
+    void ResizeTexture(Texture& texture, sint32 new_width, sint32 new_height) override;
+    void DestroyTexture(Texture& texture) override;
+
+    void CreateRenderTarget(RenderTarget& target) override;
+    void UpdateRenderBuffer(const RenderTarget& target, usize index) override {}
+    void UpdateDepthBuffer(const RenderTarget& target) override {}
+    void DestroyRenderTarget(RenderTarget& target) override;
+
+    void CreateMesh(Mesh& mesh, const std::vector<Vertex>& vertices, const std::vector<uint32>& indices) override;
+    void DestroyMesh(Mesh& mesh) override;
+
+    void CreateShader(Shader& shader, const void* data, usize size) override;
+    void DestroyShader(Shader& shader) override;
+
+    void CreateShaderPipeline(GraphicsShaderPipeline& pipeline, const Handle<Shader>& vertex_shader, const Handle<Shader>& fragment_shader)
+        override;
+    void DestroyShaderPipeline(GraphicsShaderPipeline& pipeline) override;
+
+    void CreateComputePipeline(ComputeShaderPipeline& pipeline, const void* data, usize size) override;
+    void DestroyComputePipeline(ComputeShaderPipeline& pipeline) override;
+
+    void CreateStorageBuffer(StorageBuffer& buffer, const void* data) override;
+    // The contents are never read, so updates aren't recorded.
+    void UpdateStorageBuffer(StorageBuffer& buffer, const void* data, usize size, usize offset) override {}
+    void DestroyStorageBuffer(StorageBuffer& buffer) override;
+};
\ No newline at end of file
@@ -11,9 +11,16 @@
 #include <SDL3/SDL_video.h>
 #include <glad/glad.h>
 
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstring>
 #include <map>
+#include <optional>
 #include <filesystem>
 #include <string>
+#include <string_view>
+#include <unordered_map>
 
 namespace
 {
@@ -21,6 +28,9 @@ namespace
 
     std::map<int, unsigned int> uniformBuffers;
 
+    // Target of the active render pass, its buffers are invalidated at the end of the pass when they don't need to be stored.
+    Handle<RenderTarget> active_target;
+
     void CheckCompileErrors(const uint32 id, const std::string& type = "")
     {
         int success;
@@ -57,11 +67,778 @@ namespace
         glBindBuffer(GL_UNIFORM_BUFFER, 0);
     }
 
+    // Buffer that stays mapped for its whole lifetime (GL 4.4), split into one segment per frame in flight.
+    // The CPU writes the segment of the current frame while the GPU still reads the previous ones, a fence per segment
+    // makes sure the GPU is done with a segment before it is written again.
+    class PersistentRing
+    {
+      public:
+        static constexpr usize NO_SPACE = ~usize{0};
+        static constexpr uint32 SEGMENT_COUNT = 3;
+
+        bool Create(const uint32 target, const usize new_segment_size, const usize new_alignment)
+        {
+            segment_size = new_segment_size;
+            alignment = new_alignment;
+
+            constexpr GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+            const auto size = static_cast<GLsizeiptr>(segment_size * SEGMENT_COUNT);
+
+            glGenBuffers(1, &buffer);
+            glBindBuffer(target, buffer);
+            glBufferStorage(target, size, nullptr, flags);
+            mapping = static_cast<uint8*>(glMapBufferRange(target, 0, size, flags));
+            glBindBuffer(target, 0);
+
+            if (mapping == nullptr)
+            {
+                Log::Error("Failed to map persistent buffer");
+                Destroy();
+                return false;
+            }
+
+            return true;
+        }
+
+        void Destroy()
+        {
+            for (GLsync& fence : fences)
+            {
+                if (fence != nullptr) glDeleteSync(fence);
+                fence = nullptr;
+            }
+
+            if (mapping != nullptr)
+            {
+                glBindBuffer(GL_COPY_WRITE_BUFFER, buffer);
+                glUnmapBuffer(GL_COPY_WRITE_BUFFER);
+                glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+                mapping = nullptr;
+            }
+
+            glDeleteBuffers(1, &buffer);
+            buffer = 0;
+        }
+
+        // Moves to the next segment, waiting for the GPU if it still reads it.
+        void BeginFrame()
+        {
+            segment = (segment + 1) % SEGMENT_COUNT;
+            head = segment * segment_size;
+
+            GLsync& fence = fences[segment];
+            if (fence == nullptr) return;
+
+            while (true)
+            {
+                const GLenum result = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1'000'000);
+                if (result == GL_ALREADY_SIGNALED || result == GL_CONDITION_SATISFIED) break;
+
+                if (result == GL_WAIT_FAILED)
+                {
+                    Log::Error("Failed to wait for persistent buffer fence");
+                    break;
+                }
+            }
+
+            glDeleteSync(fence);
+            fence = nullptr;
+        }
+
+        // Fences the commands reading the current segment.
+        void EndFrame()
+        {
+            GLsync& fence = fences[segment];
+            if (fence != nullptr) glDeleteSync(fence);
+
+            fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+        }
+
+        // Returns the offset of size bytes in the current segment, or NO_SPACE when the segment is full.
+        usize Allocate(const usize size)
+        {
+            const usize offset = (head + alignment - 1) & ~(alignment - 1);
+            if (offset + size > (segment + 1) * segment_size) return NO_SPACE;
+
+            head = offset + size;
+            return offset;
+        }
+
+        usize Push(const void* data, const usize size)
+        {
+            const usize offset = Allocate(size);
+            if (offset != NO_SPACE) std::memcpy(mapping + offset, data, size);
+
+            return offset;
+        }
+
+        [[nodiscard]] uint8* GetMapping(const usize offset) const { return mapping + offset; }
+        [[nodiscard]] bool IsValid() const { return mapping != nullptr; }
+        [[nodiscard]] uint32 GetBuffer() const { return buffer; }
+
+      private:
+        uint32 buffer{0};
+        uint8* mapping{nullptr};
+
+        usize segment_size{0};
+        usize alignment{1};
+
+        uint32 segment{0};
+        usize head{0};
+
+        GLsync fences[SEGMENT_COUNT]{};
+    };
+
+    // Uniform data of 3 frames, every draw needs at least one aligned (usually 256 byte) block for its model matrix.
+    constexpr usize UNIFORM_RING_SEGMENT_SIZE = 4 * 1024 * 1024;
+    PersistentRing uniform_ring;
+
+    // Shadow copy of the bound state, binds of the state that is already bound are skipped.
+    // ImGui changes the state behind its back, so it is invalidated at the start and the end of every frame.
+    class StateCache
+    {
+      public:
+        static constexpr uint32 TEXTURE_UNITS = 16;
+        static constexpr uint32 UNIFORM_SLOTS = 8;
+
+        void Invalidate()
+        {
+            program = UNKNOWN;
+            vertex_array = UNKNOWN;
+            framebuffer = UNKNOWN;
+            active_texture_unit = UNKNOWN;
+            std::ranges::fill(textures, UNKNOWN);
+            std::ranges::fill(samplers, UNKNOWN);
+            std::ranges::fill(uniform_ranges, UniformRange{});
+            viewport = {};
+            pipeline_state.reset();
+        }
+
+        void UseProgram(const uint32 new_program)
+        {
+            if (Skip(program, new_program)) return;
+            glUseProgram(new_program);
+        }
+
+        void BindVertexArray(const uint32 new_vertex_array)
+        {
+            if (Skip(vertex_array, new_vertex_array)) return;
+            glBindVertexArray(new_vertex_array);
+        }
+
+        void BindFramebuffer(const uint32 new_framebuffer)
+        {
+            if (Skip(framebuffer, new_framebuffer)) return;
+            glBindFramebuffer(GL_FRAMEBUFFER, new_framebuffer);
+        }
+
+        void Viewport(const sint32 width, const sint32 height)
+        {
+            const std::array<sint32, 2> new_viewport{width, height};
+            if (viewport == new_viewport)
+            {
+                skipped_changes++;
+                return;
+            }
+
+            viewport = new_viewport;
+            changes++;
+            glViewport(0, 0, width, height);
+        }
+
+        // OpenGL has no pipeline objects, the fixed function state of the pipeline is set directly when it changes.
+        void SetPipelineState(const PipelineState& new_state)
+        {
+            if (pipeline_state == new_state)
+            {
+                skipped_changes++;
+                return;
+            }
+
+            pipeline_state = new_state;
+            changes++;
+
+            SetEnabled(GL_BLEND, new_state.blend != PipelineState::BlendMode::REPLACE);
+            if (new_state.blend == PipelineState::BlendMode::ADDITIVE) glBlendFunc(GL_ONE, GL_ONE);
+            else glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+
+            SetEnabled(GL_CULL_FACE, new_state.cull != PipelineState::CullMode::NONE);
+            glCullFace(new_state.cull == PipelineState::CullMode::FRONT ? GL_FRONT : GL_BACK);
+            glPolygonMode(GL_FRONT_AND_BACK, new_state.wireframe ? GL_LINE : GL_FILL);
+
+            const GLboolean color_write = new_state.color_write ? GL_TRUE : GL_FALSE;
+            glColorMask(color_write, color_write, color_write, color_write);
+
+            SetEnabled(GL_DEPTH_TEST, new_state.depth_test);
+            glDepthMask(new_state.depth_write ? GL_TRUE : GL_FALSE);
+            switch (new_state.depth_compare)
+            {
+            case PipelineState::CompareOp::LESS_OR_EQUAL: glDepthFunc(GL_LEQUAL); break;
+            case PipelineState::CompareOp::EQUAL: glDepthFunc(GL_EQUAL); break;
+            case PipelineState::CompareOp::ALWAYS: glDepthFunc(GL_ALWAYS); break;
+            case PipelineState::CompareOp::LESS:
+            default: glDepthFunc(GL_LESS); break;
+            }
+        }
+
+        // Clears are masked like draws, so the buffers are cleared with all writes enabled before the state of the pass is set.
+        void EnableWrites()
+        {
+            if (pipeline_state.has_value() && pipeline_state->color_write && pipeline_state->depth_write) return;
+
+            glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
+            glDepthMask(GL_TRUE);
+            pipeline_state.reset();
+        }
+
+        void BindTexture(const uint32 unit, const uint32 texture)
+        {
+            if (unit >= TEXTURE_UNITS || Skip(textures[unit], texture)) return;
+
+            if (direct_state_access)
+            {
+                glBindTextureUnit(unit, texture);
+                return;
+            }
+
+            if (!Skip(active_texture_unit, unit)) glActiveTexture(GL_TEXTURE0 + unit);
+            glBindTexture(GL_TEXTURE_2D, texture);
+        }
+
+        void BindSampler(const uint32 unit, const uint32 sampler)
+        {
+            if (unit >= TEXTURE_UNITS || Skip(samplers[unit], sampler)) return;
+            glBindSampler(unit, sampler);
+        }
+
+        // Binds the texture to the first unit and makes it active, for the functions modifying the bound texture.
+        void BindTextureForUpdate(const uint32 texture)
+        {
+            if (!Skip(active_texture_unit, 0)) glActiveTexture(GL_TEXTURE0);
+            if (!Skip(textures[0], texture)) glBindTexture(GL_TEXTURE_2D, texture);
+        }
+
+        // A size of 0 binds the whole buffer.
+        void BindUniformBuffer(const uint32 slot, const uint32 buffer, const usize offset, const usize size)
+        {
+            const UniformRange range{buffer, offset, size};
+            if (slot < UNIFORM_SLOTS)
+            {
+                if (uniform_ranges[slot] == range)
+                {
+                    skipped_changes++;
+                    return;
+                }
+                uniform_ranges[slot] = range;
+            }
+
+            changes++;
+            if (size == 0) glBindBufferBase(GL_UNIFORM_BUFFER, slot, buffer);
+            else glBindBufferRange(GL_UNIFORM_BUFFER, slot, buffer, static_cast<GLintptr>(offset), static_cast<GLsizeiptr>(size));
+        }
+
+        // Deleted objects are unbound by OpenGL and their names can be reused, so they can't stay in the cache.
+        void ForgetTexture(const uint32 texture)
+        {
+            for (uint32& bound_texture : textures)
+            {
+                if (bound_texture == texture) bound_texture = UNKNOWN;
+            }
+        }
+        void ForgetVertexArray(const uint32 deleted) { Forget(vertex_array, deleted); }
+        void ForgetFramebuffer(const uint32 deleted) { Forget(framebuffer, deleted); }
+        void ForgetProgram(const uint32 deleted) { Forget(program, deleted); }
+
+        void ResetCounters()
+        {
+            changes = 0;
+            skipped_changes = 0;
+        }
+
+        [[nodiscard]] uint32 GetChanges() const { return changes; }
+        [[nodiscard]] uint32 GetSkippedChanges() const { return skipped_changes; }
+
+        // Uses the GL 4.5 functions that don't need objects to be bound to modify them.
+        bool direct_state_access{false};
+
+      private:
+        static constexpr uint32 UNKNOWN = ~0u;
+
+        struct UniformRange
+        {
+            uint32 buffer{UNKNOWN};
+            usize offset{0};
+            usize size{0};
+
+            bool operator==(const UniformRange&) const = default;
+        };
+
+        bool Skip(uint32& current, const uint32 value)
+        {
+            if (current == value)
+            {
+                skipped_changes++;
+                return true;
+            }
+
+            current = value;
+            changes++;
+            return false;
+        }
+
+        static void Forget(uint32& current, const uint32 deleted)
+        {
+            if (current == deleted) current = UNKNOWN;
+        }
+
+        static void SetEnabled(const uint32 capability, const bool enabled)
+        {
+            if (enabled) glEnable(capability);
+            else glDisable(capability);
+        }
+
+        uint32 program{UNKNOWN};
+        uint32 vertex_array{UNKNOWN};
+        uint32 framebuffer{UNKNOWN};
+        uint32 active_texture_unit{UNKNOWN};
+        std::array<uint32, TEXTURE_UNITS> textures{};
+        std::array<uint32, TEXTURE_UNITS> samplers{};
+        std::array<UniformRange, UNIFORM_SLOTS> uniform_ranges{};
+        std::array<sint32, 2> viewport{};
+        std::optional<PipelineState> pipeline_state;
+
+        uint32 changes{0};
+        uint32 skipped_changes{0};
+    };
+    StateCache state;
+
+    // Vertex and index buffers shared by all meshes, so draws of different meshes can be submitted with a single
+    // glMultiDrawElementsIndirect(). Where the meshes go is decided by the geometry allocator of the renderer.
+    // The vertex array also reads a model matrix per instance from binding 1. The positions are stored a second time on their
+    // own at the same vertex offsets, the position array only reads them for passes that don't need the other attributes.
+    class GeometryPool
+    {
+      public:
+        static constexpr uint32 VERTEX_BINDING = 0;
+        static constexpr uint32 INSTANCE_BINDING = 1;
+        static constexpr uint32 VERTEX_STRIDE = 8 * sizeof(float);
+        static constexpr uint32 POSITION_STRIDE = 3 * sizeof(float);
+
+        void Create()
+        {
+            glCreateVertexArrays(1, &vertex_array);
+            glCreateVertexArrays(1, &position_array);
+
+            glEnableVertexArrayAttrib(position_array, 0);
+            glVertexArrayAttribFormat(position_array, 0, 3, GL_FLOAT, GL_FALSE, 0);
+            glVertexArrayAttribBinding(position_array, 0, VERTEX_BINDING);
+
+            constexpr sint32 component_counts[] = {3, 3, 2};
+            constexpr uint32 offsets[] = {0, sizeof(float3), 2 * sizeof(float3)};
+            for (uint32 attribute = 0; attribute < 3; attribute++)
+            {
+                glEnableVertexArrayAttrib(vertex_array, attribute);
+                glVertexArrayAttribFormat(vertex_array, attribute, component_counts[attribute], GL_FLOAT, GL_FALSE, offsets[attribute]);
+                glVertexArrayAttribBinding(vertex_array, attribute, VERTEX_BINDING);
+            }
+
+            // The rows of the model matrix, the draw index is passed as base instance so every draw reads its own matrix.
+            for (uint32 row = 0; row < 4; row++)
+            {
+                glEnableVertexArrayAttrib(vertex_array, 3 + row);
+                glVertexArrayAttribFormat(vertex_array, 3 + row, 4, GL_FLOAT, GL_FALSE, row * sizeof(float4));
+                glVertexArrayAttribBinding(vertex_array, 3 + row, INSTANCE_BINDING);
+            }
+            glVertexArrayBindingDivisor(vertex_array, INSTANCE_BINDING, 1);
+
+            Reserve(GeometryAllocator::INITIAL_VERTEX_CAPACITY, GeometryAllocator::INITIAL_INDEX_CAPACITY);
+
+            // Pipelines that don't read the instance attributes still need a buffer bound to them.
+            BindInstanceBuffer(vertex_buffer, 0);
+        }
+
+        void Destroy()
+        {
+            glDeleteBuffers(1, &vertex_buffer);
+            glDeleteBuffers(1, &position_buffer);
+            glDeleteBuffers(1, &index_buffer);
+            glDeleteVertexArrays(1, &vertex_array);
+            glDeleteVertexArrays(1, &position_array);
+
+            vertex_buffer = 0;
+            position_buffer = 0;
+            index_buffer = 0;
+            vertex_array = 0;
+            position_array = 0;
+            vertex_capacity = 0;
+            index_capacity = 0;
+        }
+
+        void Upload(GeometryAllocator& allocator, Mesh& mesh, const std::vector<Vertex>& vertices, const std::vector<uint32>& indices)
+        {
+            if (!allocator.Allocate(mesh))
+            {
+                // Packing the existing meshes is cheaper than growing when there is enough free space in total.
+                if (allocator.FitsAfterDefragment(mesh)) { Defragment(allocator); }
+                else
+                {
+                    const auto [new_vertex_capacity, new_index_capacity] = allocator.GetGrownCapacities(mesh);
+                    Reserve(new_vertex_capacity, new_index_capacity);
+                    allocator.Grow(new_vertex_capacity, new_index_capacity);
+                }
+
+                if (!allocator.Allocate(mesh))
+                {
+                    Log::Error("Failed to allocate {} vertices and {} indices", mesh.GetVerticesCount(), mesh.GetIndicesCount());
+                    return;
+                }
+            }
+
+            const auto vertex_offset = static_cast<usize>(mesh.base_vertex);
+            glNamedBufferSubData(vertex_buffer, vertex_offset * VERTEX_STRIDE, vertices.size() * VERTEX_STRIDE, vertices.data());
+
+            positions.resize(vertices.size());
+            for (usize i = 0; i < vertices.size(); i++) { positions[i] = vertices[i].position; }
+            glNamedBufferSubData(position_buffer, vertex_offset * POSITION_STRIDE, positions.size() * POSITION_STRIDE, positions.data());
+
+            glNamedBufferSubData(index_buffer, mesh.first_index * sizeof(uint32), indices.size() * sizeof(uint32), indices.data());
+
+            mesh.bind = vertex_array;
+        }
+
+        // Copies the packed meshes to new buffers of the same size, copies within a buffer can't overlap in OpenGL.
+        void Defragment(GeometryAllocator& allocator)
+        {
+            std::vector<OffsetAllocator::Relocation> vertex_moves;
+            std::vector<OffsetAllocator::Relocation> index_moves;
+            allocator.Defragment(vertex_moves, index_moves);
+
+            Repack(vertex_buffer, vertex_capacity * VERTEX_STRIDE, vertex_moves, VERTEX_STRIDE, allocator.GetVertices());
+            Repack(position_buffer, vertex_capacity * POSITION_STRIDE, vertex_moves, POSITION_STRIDE, allocator.GetVertices());
+            Repack(index_buffer, index_capacity * sizeof(uint32), index_moves, sizeof(uint32), allocator.GetIndices());
+
+            BindBuffers();
+        }
+
+        void BindInstanceBuffer(const uint32 buffer, const usize offset) const
+        {
+            glVertexArrayVertexBuffer(vertex_array, INSTANCE_BINDING, buffer, static_cast<GLintptr>(offset), sizeof(Matrix4));
+        }
+
+        [[nodiscard]] bool IsValid() const { return vertex_array != 0; }
+        [[nodiscard]] uint32 GetVertexArray() const { return vertex_array; }
+        [[nodiscard]] uint32 GetPositionArray() const { return position_array; }
+
+      private:
+        // Creates larger buffers and copies the existing meshes over, their offsets stay the same.
+        void Reserve(const uint32 new_vertex_capacity, const uint32 new_index_capacity)
+        {
+            Resize(vertex_buffer, vertex_capacity * VERTEX_STRIDE, new_vertex_capacity * VERTEX_STRIDE);
+            Resize(position_buffer, vertex_capacity * POSITION_STRIDE, new_vertex_capacity * POSITION_STRIDE);
+            Resize(index_buffer, index_capacity * sizeof(uint32), new_index_capacity * sizeof(uint32));
+
+            vertex_capacity = new_vertex_capacity;
+            index_capacity = new_index_capacity;
+
+            BindBuffers();
+        }
+
+        void BindBuffers() const
+        {
+            glVertexArrayVertexBuffer(vertex_array, VERTEX_BINDING, vertex_buffer, 0, VERTEX_STRIDE);
+            glVertexArrayElementBuffer(vertex_array, index_buffer);
+
+            glVertexArrayVertexBuffer(position_array, VERTEX_BINDING, position_buffer, 0, POSITION_STRIDE);
+            glVertexArrayElementBuffer(position_array, index_buffer);
+        }
+
+        static uint32 CreateStorage(const usize size)
+        {
+            uint32 buffer;
+            glCreateBuffers(1, &buffer);
+            glNamedBufferStorage(buffer, static_cast<GLsizeiptr>(size), nullptr, GL_DYNAMIC_STORAGE_BIT);
+
+            return buffer;
+        }
+
+        static void Resize(uint32& buffer, const usize old_size, const usize new_size)
+        {
+            const uint32 new_buffer = CreateStorage(new_size);
+            if (buffer != 0)
+            {
+                glCopyNamedBufferSubData(buffer, new_buffer, 0, 0, static_cast<GLsizeiptr>(old_size));
+                glDeleteBuffers(1, &buffer);
+            }
+
+            buffer = new_buffer;
+        }
+
+        // Copies every allocation to its offset after defragmenting, the allocations that didn't move are copied as well.
+        static void Repack(
+            uint32& buffer, const usize size, const std::vector<OffsetAllocator::Relocation>& moves, const usize stride,
+            const OffsetAllocator& allocator
+        )
+        {
+            const uint32 new_buffer = CreateStorage(size);
+
+            // Allocations before the first move kept their offsets and are copied at once.
+            const usize unmoved_size = moves.empty() ? allocator.GetUsed() : moves.front().destination;
+            if (unmoved_size > 0) glCopyNamedBufferSubData(buffer, new_buffer, 0, 0, static_cast<GLsizeiptr>(unmoved_size * stride));
+
+            for (const OffsetAllocator::Relocation& move : moves)
+            {
+                glCopyNamedBufferSubData(
+                    buffer, new_buffer, static_cast<GLintptr>(move.source * stride), static_cast<GLintptr>(move.destination * stride),
+                    static_cast<GLsizeiptr>(move.size * stride)
+                );
+            }
+
+            glDeleteBuffers(1, &buffer);
+            buffer = new_buffer;
+        }
+
+        uint32 vertex_array{0};
+        uint32 position_array{0};
+        uint32 vertex_buffer{0};
+        uint32 position_buffer{0};
+        uint32 index_buffer{0};
+
+        uint32 vertex_capacity{0};
+        uint32 index_capacity{0};
+
+        // Scratch memory the positions of a mesh are gathered in before they are uploaded.
+        std::vector<float3> positions;
+    };
+    GeometryPool geometry_pool;
+
+    // Sampler objects by their settings, textures only reference them so thousands of textures share a handful of samplers.
+    // The sampler objects override the sampling parameters of the textures they are bound with.
+    class SamplerCache
+    {
+      public:
+        uint32 Get(const SamplerSettings& settings)
+        {
+            const auto [iterator, inserted] = samplers.try_emplace(settings, 0);
+            if (inserted) iterator->second = Create(settings);
+
+            return iterator->second;
+        }
+
+        void Destroy()
+        {
+            for (const auto& [settings, sampler] : samplers) { glDeleteSamplers(1, &sampler); }
+            samplers.clear();
+        }
+
+      private:
+        static sint32 ToWrapMode(const uint32 wrap_mode)
+        {
+            switch (wrap_mode)
+            {
+            case SamplerSettings::REPEAT: return GL_REPEAT;
+            case SamplerSettings::MIRRORED_REPEAT: return GL_MIRRORED_REPEAT;
+            case SamplerSettings::CLAMP_TO_EDGE:
+            default: return GL_CLAMP_TO_EDGE;
+            }
+        }
+
+        static sint32 ToMinFilter(const SamplerSettings& settings)
+        {
+            if (settings.down_filter == SamplerSettings::LINEAR)
+            {
+                return settings.mipmap_mode == SamplerSettings::LINEAR ? GL_LINEAR_MIPMAP_LINEAR : GL_LINEAR_MIPMAP_NEAREST;
+            }
+            return settings.mipmap_mode == SamplerSettings::LINEAR ? GL_NEAREST_MIPMAP_LINEAR : GL_NEAREST_MIPMAP_NEAREST;
+        }
+
+        static uint32 Create(const SamplerSettings& settings)
+        {
+            uint32 sampler = 0;
+            glGenSamplers(1, &sampler);
+
+            glSamplerParameteri(sampler, GL_TEXTURE_MIN_FILTER, ToMinFilter(settings));
+            glSamplerParameteri(sampler, GL_TEXTURE_MAG_FILTER, settings.up_filter == SamplerSettings::LINEAR ? GL_LINEAR : GL_NEAREST);
+            glSamplerParameteri(sampler, GL_TEXTURE_WRAP_S, ToWrapMode(settings.wrap_mode_u));
+            glSamplerParameteri(sampler, GL_TEXTURE_WRAP_T, ToWrapMode(settings.wrap_mode_v));
+
+            // Anisotropic filtering is core since OpenGL 4.6.
+            if (GLAD_GL_VERSION_4_6 && settings.max_anisotropy > 1.0f)
+            {
+                float max_anisotropy = 1.0f;
+                glGetFloatv(GL_MAX_TEXTURE_MAX_ANISOTROPY, &max_anisotropy);
+                glSamplerParameterf(sampler, GL_TEXTURE_MAX_ANISOTROPY, std::min(settings.max_anisotropy, max_anisotropy));
+            }
+
+            return sampler;
+        }
+
+        std::unordered_map<SamplerSettings, uint32> samplers;
+    };
+    SamplerCache sampler_cache;
+
+    // GL_TIMESTAMP queries (GL 3.3) written at the begin and end of every pass, with one set of queries per frame in flight.
+    // A frame is read back when its queries are reused FRAME_LATENCY frames later, the GPU has usually finished it by then
+    // and passes whose results still aren't available are dropped instead of waiting for them.
+    class PassTimer
+    {
+      public:
+        static constexpr uint32 FRAME_LATENCY = 4;
+        static constexpr uint32 MAX_PASSES = 32;
+
+        void Create()
+        {
+            glGenQueries(static_cast<sint32>(queries.size()), queries.data());
+            valid = true;
+        }
+
+        void Destroy()
+        {
+            glDeleteQueries(static_cast<sint32>(queries.size()), queries.data());
+            for (Frame& frame : frames) { frame.pass_count = 0; }
+            valid = false;
+        }
+
+        [[nodiscard]] bool IsValid() const { return valid; }
+
+        // Reports the passes of the oldest frame to the callback and starts recording the new frame into its queries.
+        template <typename Callback>
+        void BeginFrame(const Callback& report)
+        {
+            frame_index = (frame_index + 1) % FRAME_LATENCY;
+            Frame& frame = frames[frame_index];
+
+            for (uint32 pass = 0; pass < frame.pass_count; pass++)
+            {
+                // Queries finish in order, so the begin timestamp is available when the end one is.
+                uint32 available = 0;
+                glGetQueryObjectuiv(queries[GetQuery(pass, true)], GL_QUERY_RESULT_AVAILABLE, &available);
+                if (available == 0) continue;
+
+                GLuint64 begin = 0;
+                GLuint64 end = 0;
+                glGetQueryObjectui64v(queries[GetQuery(pass, false)], GL_QUERY_RESULT, &begin);
+                glGetQueryObjectui64v(queries[GetQuery(pass, true)], GL_QUERY_RESULT, &end);
+                report(frame.names[pass], static_cast<float>(end - begin) / 1e6f);
+            }
+
+            frame.pass_count = 0;
+        }
+
+        void BeginPass(const std::string_view name)
+        {
+            Frame& frame = frames[frame_index];
+            if (frame.pass_count == MAX_PASSES) return;
+
+            frame.names[frame.pass_count].assign(name);
+            glQueryCounter(queries[GetQuery(frame.pass_count, false)], GL_TIMESTAMP);
+            pass_active = true;
+        }
+
+        void EndPass()
+        {
+            if (!pass_active) return;
+
+            Frame& frame = frames[frame_index];
+            glQueryCounter(queries[GetQuery(frame.pass_count, true)], GL_TIMESTAMP);
+            frame.pass_count++;
+            pass_active = false;
+        }
+
+      private:
+        struct Frame
+        {
+            std::array<std::string, MAX_PASSES> names;
+            uint32 pass_count{0};
+        };
+
+        [[nodiscard]] uint32 GetQuery(const uint32 pass, const bool end) const
+        {
+            return (frame_index * MAX_PASSES + pass) * 2 + (end ? 1 : 0);
+        }
+
+        std::array<uint32, FRAME_LATENCY * MAX_PASSES * 2> queries{};
+        std::array<Frame, FRAME_LATENCY> frames;
+        uint32 frame_index{0};
+        bool pass_active{false};
+        bool valid{false};
+    };
+    PassTimer pass_timer;
+
+    // Program of the active render pass, restored after indirect draws switched to their own pipeline.
+    uint32 active_program{0};
+    // Vertex layout of the active render pass, meshes in the geometry pool are drawn with the position array for POSITION.
+    PipelineState::VertexLayout active_vertex_layout{PipelineState::VertexLayout::MESH};
+
+    struct DrawElementsIndirectCommand
+    {
+        uint32 count;
+        uint32 instance_count;
+        uint32 first_index;
+        sint32 base_vertex;
+        uint32 base_instance;
+    };
+
+    // OpenGL has one range of storage buffer bindings, the read-write buffers are bound after the read-only ones.
+    // Shaders declare them with BindReadOnly() and BindReadWrite() of Common.slang, which use the same offset.
+    // GL 4.3 guarantees 8 storage buffers per compute shader, so both kinds get half of them.
+    constexpr uint32 READ_WRITE_STORAGE_BINDING = 4;
+
+    bool BindStorageBuffers(const std::span<const StorageBinding> bindings)
+    {
+        uint32 read_only_count = 0;
+        uint32 read_write_count = 0;
+        for (const auto& [buffer, read_write] : bindings)
+        {
+            uint32& count = read_write ? read_write_count : read_only_count;
+            if (count == READ_WRITE_STORAGE_BINDING)
+            {
+                Log::Error("Dispatches can't bind more than {} storage buffers of the same access", READ_WRITE_STORAGE_BINDING);
+                return false;
+            }
+
+            const uint32 binding = read_write ? READ_WRITE_STORAGE_BINDING + count : count;
+            glBindBufferBase(GL_SHADER_STORAGE_BUFFER, binding, buffer->buffer.id);
+            count++;
+        }
+
+        return true;
+    }
+
+    // Makes the writes of a dispatch visible to the dispatches, draws and indirect arguments reading them afterwards.
+    void StorageBarrier()
+    {
+        glMemoryBarrier(
+            GL_SHADER_STORAGE_BARRIER_BIT | GL_COMMAND_BARRIER_BIT | GL_VERTEX_ATTRIB_ARRAY_BARRIER_BIT | GL_ELEMENT_ARRAY_BARRIER_BIT
+        );
+    }
+
+    Renderer::PresentMode applied_present_mode = Renderer::PresentMode::VSYNC;
+    // Time the last SDL_GL_SwapWindow() blocked, added to the statistics of the next frame once they are reset.
+    float swap_wait = 0.0f;
+
+    // OpenGL only has a swap interval, MAILBOX uses adaptive v-sync instead, which doesn't wait for frames that missed the blank.
+    void ApplyPresentMode(const Renderer::PresentMode mode)
+    {
+        bool applied = false;
+        switch (mode)
+        {
+        case Renderer::PresentMode::IMMEDIATE: applied = SDL_GL_SetSwapInterval(0); break;
+        case Renderer::PresentMode::MAILBOX: applied = SDL_GL_SetSwapInterval(-1); break;
+        case Renderer::PresentMode::VSYNC:
+        default: break;
+        }
+
+        // If the mode isn't supported we use regular v-sync.
+        if (!applied) SDL_GL_SetSwapInterval(1);
+        applied_present_mode = mode;
+    }
 } // namespace
 
 OpenGLRenderer::OpenGLRenderer() : Renderer{}
 {
-    backend_shader_info = {.file_extension = ".glsl", .binary = false, .profile = "glsl_150", .invert_y = true};
+    backend_shader_info = {
+        .file_extension = ".glsl", .binary = false, .profile = "glsl_150", .invert_y = true, .compute_profile = "glsl_430"
+    };
 }
 
 void OpenGLRenderer::InitBackend()
@@ -76,17 +853,12 @@ void OpenGLRenderer::InitBackend()
         Log::Error("Failed to initialize GLAD");
     }
 
-    if (!SDL_GL_SetSwapInterval(-1))
-    {
-        // If we fail to set adaptive v-sync we use regular v-sync.
-        SDL_GL_SetSwapInterval(1);
-    }
+    state.direct_state_access = GLAD_GL_VERSION_4_5;
+    state.Invalidate();
 
-    glEnable(GL_DEPTH_TEST);
-    glDepthFunc(GL_LESS);
+    ApplyPresentMode(present_mode);
 
-    glEnable(GL_CULL_FACE);
-    glCullFace(GL_BACK);
+    // Depth, blend and cull state are set per render pass from its pipeline state.
     glFrontFace(GL_CW);
 
     const Handle<GraphicsShaderPipeline>& graphics_pipeline = Resource::Load<GraphicsShaderPipeline>(
@@ -98,38 +870,223 @@ void OpenGLRenderer::InitBackend()
     CreateUniformBuffer<Matrix4>(1);
     CreateUniformBuffer<Matrix4>(2);
     glUseProgram(0);
+
+    // Older contexts keep using the uniform buffers per slot, which are reallocated on every push.
+    if (GLAD_GL_VERSION_4_4)
+    {
+        sint32 offset_alignment = 256;
+        glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &offset_alignment);
+
+        uniform_ring.Create(GL_UNIFORM_BUFFER, UNIFORM_RING_SEGMENT_SIZE, static_cast<usize>(offset_alignment));
+    }
+
+    // Meshes share buffers when they can be drawn with multi-draw indirect, the pool uses direct state access.
+    if (state.direct_state_access)
+    {
+        geometry_allocator.Reset();
+        geometry_pool.Create();
+    }
+
+    if (GLAD_GL_VERSION_3_3) pass_timer.Create();
 }
 
 void OpenGLRenderer::ExitBackend()
 {
+    if (uniform_ring.IsValid()) uniform_ring.Destroy();
+    if (geometry_pool.IsValid()) geometry_pool.Destroy();
+    if (pass_timer.IsValid()) pass_timer.Destroy();
+    sampler_cache.Destroy();
+
+    for (auto& [binding, UBO] : uniformBuffers) { glDeleteBuffers(1, &UBO); }
+    uniformBuffers.clear();
+
     if (!SDL_GL_DestroyContext(context)) Log::Error("Failed to destroy GL context: %s", SDL_GetError());
 }
 
-void OpenGLRenderer::Update() {}
+void OpenGLRenderer::Update()
+{
+    if (present_mode != applied_present_mode) ApplyPresentMode(present_mode);
+
+    statistics.swapchain_wait_milliseconds = swap_wait;
+    swap_wait = 0.0f;
+
+    state.Invalidate();
+    state.ResetCounters();
+
+    if (uniform_ring.IsValid()) uniform_ring.BeginFrame();
+
+    if (pass_timer.IsValid())
+    {
+        pass_timer.BeginFrame([this](const std::string_view name, const float milliseconds) { AddPassTiming(name, milliseconds); });
+    }
+}
+
+void OpenGLRenderer::EndFrame()
+{
+    // Passes don't unbind their state, ImGui renders to the default frame buffer afterwards.
+    state.BindFramebuffer(0);
+    state.UseProgram(0);
+    state.BindVertexArray(0);
+
+    statistics.state_changes = state.GetChanges();
+    statistics.skipped_state_changes = state.GetSkippedChanges();
+
+    state.Invalidate();
+}
 
 void OpenGLRenderer::SwapBuffer()
 {
+    if (uniform_ring.IsValid()) uniform_ring.EndFrame();
+
+    // Blocks until the frame can be queued with v-sync, there is no separate swapchain to wait for.
+    const uint64 start = SDL_GetTicksNS();
     auto* window = static_cast<SDL_Window*>(Window::GetHandle());
     SDL_GL_SwapWindow(window);
+    swap_wait = static_cast<float>(SDL_GetTicksNS() - start) / 1e6f;
 }
 
 void* OpenGLRenderer::GetContext() { return static_cast<void*>(&context); }
 
 void OpenGLRenderer::RenderMesh(const Mesh& mesh)
 {
-    glBindVertexArray(mesh.bind);
-    glDrawElements(GL_TRIANGLES, static_cast<sint32>(mesh.GetIndicesCount()), GL_UNSIGNED_INT, nullptr);
-    glBindVertexArray(0);
+    // Meshes with their own vertex array only have the interleaved vertices, the position of those is read from there.
+    const bool positions = active_vertex_layout == PipelineState::VertexLayout::POSITION && mesh.bind == geometry_pool.GetVertexArray();
+    state.BindVertexArray(positions ? geometry_pool.GetPositionArray() : mesh.bind);
+
+    const auto* first_index = reinterpret_cast<const void*>(static_cast<usize>(mesh.first_index) * sizeof(uint32));
+    glDrawElementsBaseVertex(GL_TRIANGLES, static_cast<sint32>(mesh.GetIndicesCount()), GL_UNSIGNED_INT, first_index, mesh.base_vertex);
+    statistics.draw_calls++;
+}
+
+void OpenGLRenderer::DefragmentGeometry()
+{
+    if (geometry_pool.IsValid()) geometry_pool.Defragment(geometry_allocator);
+}
+
+bool OpenGLRenderer::SupportsIndirectDraws() const { return geometry_pool.IsValid() && uniform_ring.IsValid(); }
+
+bool OpenGLRenderer::RenderMeshesIndirect(const GraphicsShaderPipeline& pipeline, const std::span<const DrawCommand> commands)
+{
+    if (!SupportsIndirectDraws() || commands.empty()) return false;
+
+    const uint32 vertex_array = geometry_pool.GetVertexArray();
+    if (std::ranges::any_of(commands, [vertex_array](const DrawCommand& command) { return command.mesh->bind != vertex_array; }))
+    {
+        return false;
+    }
+
+    // The model matrices and the draw commands are written to the ring buffer, the GPU reads them straight from there.
+    const usize models_offset = uniform_ring.Allocate(commands.size() * sizeof(Matrix4));
+    const usize commands_offset = uniform_ring.Allocate(commands.size() * sizeof(DrawElementsIndirectCommand));
+    if (models_offset == PersistentRing::NO_SPACE || commands_offset == PersistentRing::NO_SPACE) return false;
+
+    auto* models = reinterpret_cast<Matrix4*>(uniform_ring.GetMapping(models_offset));
+    auto* indirect_commands = reinterpret_cast<DrawElementsIndirectCommand*>(uniform_ring.GetMapping(commands_offset));
+    for (usize i = 0; i < commands.size(); i++)
+    {
+        const Mesh& mesh = *commands[i].mesh;
+
+        models[i] = commands[i].model;
+        indirect_commands[i] = DrawElementsIndirectCommand{
+            .count = mesh.GetIndicesCount(),
+            .instance_count = 1,
+            .first_index = mesh.first_index,
+            .base_vertex = mesh.base_vertex,
+            .base_instance = static_cast<uint32>(i)
+        };
+    }
+
+    state.UseProgram(pipeline.shader_pipeline.id);
+    state.BindVertexArray(vertex_array);
+    geometry_pool.BindInstanceBuffer(uniform_ring.GetBuffer(), models_offset);
+
+    glBindBuffer(GL_DRAW_INDIRECT_BUFFER, uniform_ring.GetBuffer());
+    const auto* indirect = reinterpret_cast<const void*>(commands_offset);
+    glMultiDrawElementsIndirect(GL_TRIANGLES, GL_UNSIGNED_INT, indirect, static_cast<sint32>(commands.size()), 0);
+    glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+    statistics.draw_calls++;
+
+    state.UseProgram(active_program);
+    return true;
+}
+
+bool OpenGLRenderer::RenderMeshesIndirectBuffer(
+    const GraphicsShaderPipeline& pipeline, const StorageBuffer& arguments, const uint32 offset, const uint32 draw_count,
+    const StorageBuffer& instances
+)
+{
+    // Every mesh is in the shared buffers when the pool exists, the arguments reference them by their offsets.
+    if (!SupportsIndirectDraws() || draw_count == 0 || arguments.buffer.id == 0 || instances.buffer.id == 0) return false;
+
+    state.UseProgram(pipeline.shader_pipeline.id);
+    state.BindVertexArray(geometry_pool.GetVertexArray());
+    geometry_pool.BindInstanceBuffer(instances.buffer.id, 0);
+
+    glBindBuffer(GL_DRAW_INDIRECT_BUFFER, arguments.buffer.id);
+    const auto* indirect = reinterpret_cast<const void*>(static_cast<usize>(offset));
+    glMultiDrawElementsIndirect(GL_TRIANGLES, GL_UNSIGNED_INT, indirect, static_cast<sint32>(draw_count), 0);
+    glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+    statistics.draw_calls++;
+
+    state.UseProgram(active_program);
+    return true;
+}
+
+bool OpenGLRenderer::SupportsCompute() const { return GLAD_GL_VERSION_4_3; }
+
+void OpenGLRenderer::Dispatch(
+    const ComputeShaderPipeline& pipeline, const std::span<const StorageBinding> bindings, const uint32 group_count_x,
+    const uint32 group_count_y, const uint32 group_count_z
+)
+{
+    if (!SupportsCompute() || pipeline.compute_pipeline.id == 0) return;
+
+    state.UseProgram(pipeline.compute_pipeline.id);
+    if (!BindStorageBuffers(bindings)) return;
+
+    glDispatchCompute(group_count_x, group_count_y, group_count_z);
+    StorageBarrier();
+    statistics.dispatches++;
+}
+
+void OpenGLRenderer::DispatchIndirect(
+    const ComputeShaderPipeline& pipeline, const std::span<const StorageBinding> bindings, const StorageBuffer& arguments,
+    const uint32 offset
+)
+{
+    if (!SupportsCompute() || pipeline.compute_pipeline.id == 0) return;
+
+    state.UseProgram(pipeline.compute_pipeline.id);
+    if (!BindStorageBuffers(bindings)) return;
+
+    glBindBuffer(GL_DISPATCH_INDIRECT_BUFFER, arguments.buffer.id);
+    glDispatchComputeIndirect(static_cast<GLintptr>(offset));
+    glBindBuffer(GL_DISPATCH_INDIRECT_BUFFER, 0);
+    StorageBarrier();
+    statistics.dispatches++;
 }
 
 void OpenGLRenderer::SetTextureSampler(const uint32 slot, const Texture& texture)
 {
-    glActiveTexture(GL_TEXTURE0 + slot);
-    glBindTexture(GL_TEXTURE_2D, texture.texture.id);
+    state.BindTexture(slot, texture.texture.id);
+    state.BindSampler(slot, texture.sampler.id);
 }
 
-void OpenGLRenderer::SetUniform(const uint32 slot, const void* data, const usize size)
+// Uniform buffers are shared by all stages in OpenGL, so the stages don't matter.
+void OpenGLRenderer::PushUniform(const uint32 slot, const void* data, const usize size, ShaderStages)
 {
+    if (uniform_ring.IsValid())
+    {
+        const usize offset = uniform_ring.Push(data, size);
+        if (offset != PersistentRing::NO_SPACE)
+        {
+            state.BindUniformBuffer(slot, uniform_ring.GetBuffer(), offset, size);
+            return;
+        }
+
+        // Only happens with a huge amount of draws, the rest of the frame falls back to the uniform buffers per slot.
+    }
+
     const auto iterator = uniformBuffers.find(static_cast<sint32>(slot));
     if (iterator == uniformBuffers.end())
     {
@@ -139,19 +1096,32 @@ void OpenGLRenderer::SetUniform(const uint32 slot, const void* data, const usize
 
     const unsigned int UBO = iterator->second;
 
-    glBindBuffer(GL_UNIFORM_BUFFER, UBO);
-    glBufferData(GL_UNIFORM_BUFFER, static_cast<GLsizeiptr>(size), data, GL_STATIC_DRAW);
-    glBindBuffer(GL_UNIFORM_BUFFER, 0);
+    if (state.direct_state_access) glNamedBufferData(UBO, static_cast<GLsizeiptr>(size), data, GL_STREAM_DRAW);
+    else
+    {
+        glBindBuffer(GL_UNIFORM_BUFFER, UBO);
+        glBufferData(GL_UNIFORM_BUFFER, static_cast<GLsizeiptr>(size), data, GL_STREAM_DRAW);
+        glBindBuffer(GL_UNIFORM_BUFFER, 0);
+    }
+
+    // The slot might still have a range of the ring buffer bound.
+    state.BindUniformBuffer(slot, UBO, 0, 0);
 }
 
 void OpenGLRenderer::BeginRenderPass(const RenderPassInterface& render_pass)
 {
-    const Handle<RenderTarget>& render_target = render_pass.render_target;
+    if (pass_timer.IsValid()) pass_timer.BeginPass(render_pass.GetName());
+
+    const Handle<RenderTarget>& render_target = render_pass.GetTarget();
+    active_target = render_target;
 
-    glBindFramebuffer(GL_FRAMEBUFFER, render_target->target_id);
-    glViewport(0, 0, render_target->GetWidth(), render_target->GetHeight());
+    state.BindFramebuffer(render_target->target_id);
+    state.Viewport(render_target->GetWidth(), render_target->GetHeight());
 
-    glUseProgram(render_pass.graphics_pipeline->shader_pipeline.id);
+    active_program = render_pass.graphics_pipeline->shader_pipeline.id;
+    active_vertex_layout = render_pass.pipeline_state.vertex_layout;
+    state.UseProgram(active_program);
+    state.EnableWrites();
 
     std::vector<uint32> draw_buffers;
     draw_buffers.reserve(render_target->render_buffers.size());
@@ -164,7 +1134,8 @@ void OpenGLRenderer::BeginRenderPass(const RenderPassInterface& render_pass)
 
         index++;
 
-        if (!render_pass.clear_render_targets) continue;
+        // The contents are kept by default, so there is nothing to do for LOAD and DONT_CARE.
+        if (render_buffer.load_op != RenderBuffer::LoadOp::CLEAR) continue;
 
         const float4 color = render_buffer.clear_color;
         glClearColor(color.x(), color.y(), color.z(), color.w());
@@ -174,39 +1145,76 @@ void OpenGLRenderer::BeginRenderPass(const RenderPassInterface& render_pass)
     }
 
     // If the target has a valid depth buffer clear the frame buffer's depth bit (you shouldn't set draw buffers to GL_DEPTH_ATTACHMENT for some reason).
-    if (render_pass.clear_render_targets && render_target->depth_buffer.GetTexture() != nullptr) { glClear(GL_DEPTH_BUFFER_BIT); }
+    const RenderBuffer& depth_buffer = render_target->depth_buffer;
+    if (depth_buffer.load_op == RenderBuffer::LoadOp::CLEAR && depth_buffer.GetTexture() != nullptr) { glClear(GL_DEPTH_BUFFER_BIT); }
 
     glDrawBuffers(static_cast<sint32>(draw_buffers.size()), draw_buffers.data());
+    state.SetPipelineState(render_pass.pipeline_state);
 }
 
 void OpenGLRenderer::EndRenderPass()
 {
-    glUseProgram(0);
-    glDrawBuffers(0, nullptr);
+    // Lets tiled GPUs skip writing buffers back to memory when no later pass uses their contents.
+    if (GLAD_GL_VERSION_4_3 && active_target != nullptr && active_target->target_id != 0)
+    {
+        std::vector<uint32> attachments;
+        for (usize i = 0; i < active_target->render_buffers.size(); i++)
+        {
+            const RenderBuffer& render_buffer = active_target->render_buffers[i];
+            if (render_buffer.store_op != RenderBuffer::StoreOp::DONT_CARE) continue;
+
+            attachments.push_back(GL_COLOR_ATTACHMENT0 + static_cast<uint32>(i));
+        }
+
+        const RenderBuffer& depth_buffer = active_target->depth_buffer;
+        if (depth_buffer.GetTexture() != nullptr && depth_buffer.store_op == RenderBuffer::StoreOp::DONT_CARE)
+        {
+            attachments.push_back(GL_DEPTH_ATTACHMENT);
+        }
+
+        if (!attachments.empty()) glInvalidateFramebuffer(GL_FRAMEBUFFER, static_cast<sint32>(attachments.size()), attachments.data());
+    }
+    active_target.reset();
 
-    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    if (pass_timer.IsValid()) pass_timer.EndPass();
 }
 
 void OpenGLRenderer::CreateTexture(Texture& texture, const uint8* data, const SamplerSettings& sampler_settings)
 {
-    glGenTextures(1, &texture.texture.id);
-
     const bool is_color_texture = texture.GetFormat() == Texture::COLOR_RGBA_32;
     const sint32 format = is_color_texture ? GL_RGBA : GL_DEPTH_COMPONENT;
 
-    glBindTexture(GL_TEXTURE_2D, texture.texture.id);
-    glTexImage2D(GL_TEXTURE_2D, 0, format, texture.GetWidth(), texture.GetHeight(), 0, format, GL_UNSIGNED_BYTE, data);
+    texture.sampler.id = sampler_cache.Get(sampler_settings);
 
-    if (is_color_texture)
+    // Render targets keep mutable storage, since they are resized in place and need to stay attached to their frame buffers.
+    const bool is_target = (texture.GetFlags() & (Texture::COLOR_TARGET | Texture::DEPTH_TARGET)) != 0;
+    // Sampled color textures get a full mip chain, render targets are only ever sampled at their own size.
+    const bool generate_mipmaps = is_color_texture && !is_target;
+    if (state.direct_state_access && !is_target)
     {
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-        glGenerateMipmap(GL_TEXTURE_2D);
+        glCreateTextures(GL_TEXTURE_2D, 1, &texture.texture.id);
+        const uint32 id = texture.texture.id;
+        const sint32 width = texture.GetWidth();
+        const sint32 height = texture.GetHeight();
+
+        const sint32 levels = generate_mipmaps ? static_cast<sint32>(std::bit_width(static_cast<uint32>(std::max(width, height)))) : 1;
+        glTextureStorage2D(id, levels, is_color_texture ? GL_RGBA8 : GL_DEPTH_COMPONENT24, width, height);
+        if (data != nullptr) glTextureSubImage2D(id, 0, 0, 0, width, height, format, GL_UNSIGNED_BYTE, data);
+
+        if (generate_mipmaps) glGenerateTextureMipmap(id);
+        return;
     }
 
-    glBindTexture(GL_TEXTURE_2D, 0);
+    glGenTextures(1, &texture.texture.id);
+
+    state.BindTextureForUpdate(texture.texture.id);
+    glTexImage2D(GL_TEXTURE_2D, 0, format, texture.GetWidth(), texture.GetHeight(), 0, format, GL_UNSIGNED_BYTE, data);
+
+    // Sampling is set by the sampler objects, textures without mipmaps only need to be complete with their single level.
+    if (generate_mipmaps) glGenerateMipmap(GL_TEXTURE_2D);
+    else glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, 0);
+
+    state.BindTextureForUpdate(0);
 }
 
 void OpenGLRenderer::ResizeTexture(Texture& texture, sint32 new_width, sint32 new_height)
@@ -214,60 +1222,106 @@ void OpenGLRenderer::ResizeTexture(Texture& texture, sint32 new_width, sint32 ne
     const bool is_color_texture = texture.GetFormat() == Texture::COLOR_RGBA_32;
     const sint32 format = is_color_texture ? GL_RGBA : GL_DEPTH_COMPONENT;
 
-    glBindTexture(GL_TEXTURE_2D, texture.texture.id);
+    // Only render targets are resized, they keep the single level set when they were created.
+    state.BindTextureForUpdate(texture.texture.id);
     glTexImage2D(GL_TEXTURE_2D, 0, format, new_width, new_height, 0, format, GL_UNSIGNED_BYTE, nullptr);
-
-    if (is_color_texture)
-    {
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-        glGenerateMipmap(GL_TEXTURE_2D);
-    }
-
-    glBindTexture(GL_TEXTURE_2D, 0);
+    state.BindTextureForUpdate(0);
 }
 
-void OpenGLRenderer::DestroyTexture(Texture& texture) { glDeleteTextures(1, &texture.texture.id); }
+void OpenGLRenderer::DestroyTexture(Texture& texture)
+{
+    state.ForgetTexture(texture.texture.id);
+    glDeleteTextures(1, &texture.texture.id);
+}
 
-void OpenGLRenderer::CreateRenderTarget(RenderTarget& target) { glGenFramebuffers(1, &target.target_id); }
+void OpenGLRenderer::CreateRenderTarget(RenderTarget& target)
+{
+    if (state.direct_state_access) glCreateFramebuffers(1, &target.target_id);
+    else glGenFramebuffers(1, &target.target_id);
+}
 
 void OpenGLRenderer::UpdateRenderBuffer(const RenderTarget& target, const usize index)
 {
-    glBindFramebuffer(GL_FRAMEBUFFER, target.target_id);
-
     const uint32 texture_id = target.render_buffers[index].GetTexture()->texture.id;
-    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0 + static_cast<uint32>(index), GL_TEXTURE_2D, texture_id, 0);
+    const uint32 attachment = GL_COLOR_ATTACHMENT0 + static_cast<uint32>(index);
 
-    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    if (state.direct_state_access)
+    {
+        glNamedFramebufferTexture(target.target_id, attachment, texture_id, 0);
+        return;
+    }
+
+    state.BindFramebuffer(target.target_id);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, attachment, GL_TEXTURE_2D, texture_id, 0);
+    state.BindFramebuffer(0);
 }
 
 void OpenGLRenderer::UpdateDepthBuffer(const RenderTarget& target)
 {
-    glBindFramebuffer(GL_FRAMEBUFFER, target.target_id);
-
     const uint32 texture_id = target.depth_buffer.GetTexture()->texture.id;
-    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_TEXTURE_2D, texture_id, 0);
 
-    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    if (state.direct_state_access)
+    {
+        glNamedFramebufferTexture(target.target_id, GL_DEPTH_ATTACHMENT, texture_id, 0);
+        return;
+    }
+
+    state.BindFramebuffer(target.target_id);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_TEXTURE_2D, texture_id, 0);
+    state.BindFramebuffer(0);
 }
 
-void OpenGLRenderer::DestroyRenderTarget(RenderTarget& target) { glDeleteFramebuffers(1, &target.target_id); }
+void OpenGLRenderer::DestroyRenderTarget(RenderTarget& target)
+{
+    state.ForgetFramebuffer(target.target_id);
+    glDeleteFramebuffers(1, &target.target_id);
+}
 
 void OpenGLRenderer::CreateMesh(Mesh& mesh, const std::vector<Vertex>& vertices, const std::vector<uint32>& indices)
 {
+    if (geometry_pool.IsValid())
+    {
+        geometry_pool.Upload(geometry_allocator, mesh, vertices, indices);
+        return;
+    }
+
+    const auto vertices_size = static_cast<GLsizeiptr>(vertices.size() * sizeof(Vertex));
+    const auto indices_size = static_cast<GLsizeiptr>(indices.size() * sizeof(uint32));
+
+    if (state.direct_state_access)
+    {
+        glCreateBuffers(1, &mesh.vertices_buffer.id);
+        glNamedBufferData(mesh.vertices_buffer.id, vertices_size, vertices.data(), GL_STATIC_DRAW);
+        glCreateBuffers(1, &mesh.indices_buffer.id);
+        glNamedBufferData(mesh.indices_buffer.id, indices_size, indices.data(), GL_STATIC_DRAW);
+
+        glCreateVertexArrays(1, &mesh.bind);
+        glVertexArrayVertexBuffer(mesh.bind, 0, mesh.vertices_buffer.id, 0, 8 * sizeof(float));
+        glVertexArrayElementBuffer(mesh.bind, mesh.indices_buffer.id);
+
+        constexpr sint32 component_counts[] = {3, 3, 2};
+        constexpr uint32 offsets[] = {0, sizeof(float3), 2 * sizeof(float3)};
+        for (uint32 attribute = 0; attribute < 3; attribute++)
+        {
+            glEnableVertexArrayAttrib(mesh.bind, attribute);
+            glVertexArrayAttribFormat(mesh.bind, attribute, component_counts[attribute], GL_FLOAT, GL_FALSE, offsets[attribute]);
+            glVertexArrayAttribBinding(mesh.bind, attribute, 0);
+        }
+
+        return;
+    }
+
     glGenVertexArrays(1, &mesh.bind);
     glGenBuffers(1, &mesh.vertices_buffer.id);
     glGenBuffers(1, &mesh.indices_buffer.id);
 
-    glBindVertexArray(mesh.bind);
+    state.BindVertexArray(mesh.bind);
 
     glBindBuffer(GL_ARRAY_BUFFER, mesh.vertices_buffer.id);
-    glBufferData(GL_ARRAY_BUFFER, static_cast<sint32>(vertices.size() * sizeof(Vertex)), vertices.data(), GL_STATIC_DRAW);
+    glBufferData(GL_ARRAY_BUFFER, vertices_size, vertices.data(), GL_STATIC_DRAW);
 
     glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, mesh.indices_buffer.id);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, static_cast<sint32>(indices.size() * sizeof(uint32)), indices.data(), GL_STATIC_DRAW);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices_size, indices.data(), GL_STATIC_DRAW);
 
     const uint8* offset = nullptr;
     glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), offset);
@@ -281,13 +1335,21 @@ void OpenGLRenderer::CreateMesh(Mesh& mesh, const std::vector<Vertex>& vertices,
     glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, 8 * sizeof(float), offset);
     glEnableVertexAttribArray(2);
 
-    glBindVertexArray(0);
+    state.BindVertexArray(0);
     glBindBuffer(GL_ARRAY_BUFFER, 0);
     glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
 }
 
 void OpenGLRenderer::DestroyMesh(Mesh& mesh)
 {
+    if (GeometryAllocator::IsAllocated(mesh))
+    {
+        geometry_allocator.Free(mesh);
+        return;
+    }
+
+    state.ForgetVertexArray(mesh.bind);
+
     glDeleteBuffers(1, &mesh.vertices_buffer.id);
     glDeleteBuffers(1, &mesh.indices_buffer.id);
     glDeleteVertexArrays(1, &mesh.bind);
@@ -320,4 +1382,83 @@ void OpenGLRenderer::CreateShaderPipeline(
     CheckCompileErrors(pipeline.shader_pipeline.id);
 }
 
-void OpenGLRenderer::DestroyShaderPipeline(GraphicsShaderPipeline& pipeline) { glDeleteProgram(pipeline.shader_pipeline.id); }
\ No newline at end of file
+void OpenGLRenderer::DestroyShaderPipeline(GraphicsShaderPipeline& pipeline)
+{
+    state.ForgetProgram(pipeline.shader_pipeline.id);
+    glDeleteProgram(pipeline.shader_pipeline.id);
+}
+
+void OpenGLRenderer::CreateComputePipeline(ComputeShaderPipeline& pipeline, const void* data, usize)
+{
+    if (!SupportsCompute())
+    {
+        Log::Error("Compute shaders need OpenGL 4.3");
+        return;
+    }
+
+    const uint32 shader = glCreateShader(GL_COMPUTE_SHADER);
+    const char* code = static_cast<const char*>(data);
+    glShaderSource(shader, 1, &code, nullptr);
+    glCompileShader(shader);
+    CheckCompileErrors(shader, "compute");
+
+    pipeline.compute_pipeline.id = glCreateProgram();
+    glAttachShader(pipeline.compute_pipeline.id, shader);
+    glLinkProgram(pipeline.compute_pipeline.id);
+    CheckCompileErrors(pipeline.compute_pipeline.id);
+
+    // The program keeps the compiled code, the shader isn't needed by anything else.
+    glDeleteShader(shader);
+}
+
+void OpenGLRenderer::DestroyComputePipeline(ComputeShaderPipeline& pipeline)
+{
+    if (pipeline.compute_pipeline.id == 0) return;
+
+    state.ForgetProgram(pipeline.compute_pipeline.id);
+    glDeleteProgram(pipeline.compute_pipeline.id);
+    pipeline.compute_pipeline.id = 0;
+}
+
+void OpenGLRenderer::CreateStorageBuffer(StorageBuffer& buffer, const void* data)
+{
+    if (!SupportsCompute())
+    {
+        Log::Error("Storage buffers need OpenGL 4.3");
+        return;
+    }
+
+    const auto size = static_cast<GLsizeiptr>(buffer.GetSize());
+    if (state.direct_state_access)
+    {
+        glCreateBuffers(1, &buffer.buffer.id);
+        glNamedBufferData(buffer.buffer.id, size, data, GL_DYNAMIC_DRAW);
+        return;
+    }
+
+    glGenBuffers(1, &buffer.buffer.id);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, buffer.buffer.id);
+    glBufferData(GL_SHADER_STORAGE_BUFFER, size, data, GL_DYNAMIC_DRAW);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+}
+
+void OpenGLRenderer::UpdateStorageBuffer(StorageBuffer& buffer, const void* data, const usize size, const usize offset)
+{
+    if (buffer.buffer.id == 0) return;
+
+    if (state.direct_state_access)
+    {
+        glNamedBufferSubData(buffer.buffer.id, static_cast<GLintptr>(offset), static_cast<GLsizeiptr>(size), data);
+        return;
+    }
+
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, buffer.buffer.id);
+    glBufferSubData(GL_SHADER_STORAGE_BUFFER, static_cast<GLintptr>(offset), static_cast<GLsizeiptr>(size), data);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+}
+
+void OpenGLRenderer::DestroyStorageBuffer(StorageBuffer& buffer)
+{
+    glDeleteBuffers(1, &buffer.buffer.id);
+    buffer.buffer.id = 0;
+}
\ No newline at end of file
@@ -2,6 +2,7 @@
 #include "Renderer.hpp"
 
 #include "Tools/Logging.hpp"
+#include "Tools/Profiler.hpp"
 #include "Core/ECS.hpp"
 #include "Core/Window.hpp"
 #include "Core/Physics/Physics.hpp"
@@ -9,13 +10,26 @@
 #include "Core/Rendering/RenderPassInterface.hpp"
 
 #include <SDL3/SDL_gpu.h>
-
+#include <SDL3/SDL_timer.h>
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <chrono>
+#include <cstring>
+#include <deque>
 #include <filesystem>
+#include <future>
+#include <unordered_map>
+#include <unordered_set>
 
 namespace
 {
     SDL_GPUCommandBuffer* render_command_buffer = nullptr;
     SDL_GPURenderPass* active_render_pass = nullptr;
+    // Pass being rendered and its pipeline, draws with another vertex layout bind their own pipeline and restore this one afterwards.
+    const RenderPassInterface* active_pass = nullptr;
+    SDL_GPUGraphicsPipeline* active_pipeline = nullptr;
 
     struct TextureCopyInfo
     {
@@ -33,36 +47,377 @@ namespace
 
     SDL_GPUDevice* device = nullptr;
 
-    SDL_GPUTransferBuffer* CreateUploadTransferBuffer(const void* upload_data, const usize data_size)
+    // The CPU records the next frame while the GPU is still rendering up to this many earlier frames.
+    constexpr uint32 FRAMES_IN_FLIGHT = 2;
+
+    // Render target textures replaced by a resize, reused by later resizes to the same size instead of creating new textures.
+    // Dragging a window back and forth between two size classes then doesn't allocate anything.
+    class RenderTexturePool
     {
-        const SDL_GPUTransferBufferCreateInfo transfer_buffer_info{
-            .usage = SDL_GPU_TRANSFERBUFFERUSAGE_UPLOAD, .size = static_cast<uint32>(data_size), .props = 0
+      public:
+        static constexpr usize MAX_TEXTURES = 8;
+        // Textures that weren't reused for this many frames are released.
+        static constexpr uint32 MAX_UNUSED_FRAMES = 300;
+
+        struct Entry
+        {
+            SDL_GPUTexture* texture{nullptr};
+            SDL_GPUTextureFormat format{};
+            SDL_GPUTextureUsageFlags usage{0};
+            uint32 width{0};
+            uint32 height{0};
+            uint32 unused_frames{0};
         };
 
-        SDL_GPUTransferBuffer* transfer_buffer = SDL_CreateGPUTransferBuffer(device, &transfer_buffer_info);
-        if (transfer_buffer == nullptr)
+        // Returns a pooled texture matching the create info, or nullptr.
+        SDL_GPUTexture* Acquire(const SDL_GPUTextureCreateInfo& create_info)
         {
-            Log::Error("Failed to create vertex transfer buffer: {}", SDL_GetError());
-            return nullptr;
+            const auto entry = std::ranges::find_if(entries, [&create_info](const Entry& pooled) {
+                return pooled.format == create_info.format && pooled.usage == create_info.usage && pooled.width == create_info.width &&
+                       pooled.height == create_info.height;
+            });
+            if (entry == entries.end()) return nullptr;
+
+            SDL_GPUTexture* texture = entry->texture;
+            entries.erase(entry);
+            return texture;
+        }
+
+        // Only called for textures the GPU no longer uses.
+        void Add(const Entry& entry)
+        {
+            if (entries.size() == MAX_TEXTURES)
+            {
+                SDL_ReleaseGPUTexture(device, entries.front().texture);
+                entries.erase(entries.begin());
+            }
+            entries.push_back(entry);
+        }
+
+        void Update()
+        {
+            std::erase_if(entries, [](Entry& entry) {
+                if (++entry.unused_frames <= MAX_UNUSED_FRAMES) return false;
+
+                SDL_ReleaseGPUTexture(device, entry.texture);
+                return true;
+            });
+        }
+
+        void Destroy()
+        {
+            for (const Entry& entry : entries) { SDL_ReleaseGPUTexture(device, entry.texture); }
+            entries.clear();
+        }
+
+      private:
+        std::vector<Entry> entries;
+    };
+    RenderTexturePool render_texture_pool;
+
+    // Objects destroyed during a frame, released once the GPU finished that frame since frames in flight might still use them.
+    struct DeletionQueue
+    {
+        std::vector<SDL_GPUTexture*> textures;
+        // Added to the render texture pool instead of being released.
+        std::vector<RenderTexturePool::Entry> pooled_textures;
+        std::vector<SDL_GPUBuffer*> buffers;
+        std::vector<SDL_GPUGraphicsPipeline*> pipelines;
+        std::vector<SDL_GPUComputePipeline*> compute_pipelines;
+        std::vector<GeometryAllocator::Ranges> geometry_ranges;
+
+        void Flush(GeometryAllocator& geometry_allocator)
+        {
+            for (SDL_GPUTexture* texture : textures) { SDL_ReleaseGPUTexture(device, texture); }
+            for (const RenderTexturePool::Entry& entry : pooled_textures) { render_texture_pool.Add(entry); }
+            for (SDL_GPUBuffer* buffer : buffers) { SDL_ReleaseGPUBuffer(device, buffer); }
+            for (SDL_GPUGraphicsPipeline* pipeline : pipelines) { SDL_ReleaseGPUGraphicsPipeline(device, pipeline); }
+            for (SDL_GPUComputePipeline* pipeline : compute_pipelines) { SDL_ReleaseGPUComputePipeline(device, pipeline); }
+            for (const GeometryAllocator::Ranges& ranges : geometry_ranges) { geometry_allocator.Free(ranges); }
+
+            textures.clear();
+            pooled_textures.clear();
+            buffers.clear();
+            pipelines.clear();
+            compute_pipelines.clear();
+            geometry_ranges.clear();
+        }
+    };
+
+    struct FrameData
+    {
+        // Signaled when the GPU finished the render command buffer of the frame.
+        SDL_GPUFence* fence{nullptr};
+        DeletionQueue deletions;
+    };
+    std::array<FrameData, FRAMES_IN_FLIGHT> frames;
+    uint32 frame_index = 0;
+
+    // Objects destroyed after the render command buffer was submitted are added to the submitted frame, it is the last one using them.
+    DeletionQueue& GetDeletionQueue() { return frames[frame_index].deletions; }
+
+    // Transfer buffers reused for all uploads, split into chunks of a fixed size that are filled one after another.
+    // Small uploads are packed into the same chunk and large uploads are split over multiple chunks.
+    // The chunks of a submitted batch are only reused once its fence is signaled, so data in flight is never overwritten.
+    class UploadRing
+    {
+      public:
+        static constexpr uint32 CHUNK_SIZE = 4 * 1024 * 1024;
+        // Waits for the oldest batch instead of creating more chunks once this many exist.
+        static constexpr usize MAX_CHUNKS = 32;
+
+        struct Span
+        {
+            SDL_GPUTransferBuffer* buffer{nullptr};
+            uint32 offset{0};
+            uint32 size{0};
+            uint8* data{nullptr};
+        };
+
+        /// @brief Reserves space for up to size bytes, large uploads call this until all of their data is written.
+        /// @param granularity The returned size is a multiple of it, so texture uploads are split at rows.
+        Span Allocate(const uint32 size, const uint32 granularity = 1)
+        {
+            if (size == 0 || granularity > CHUNK_SIZE)
+            {
+                if (size != 0) Log::Error("Upload granularity of {} bytes is larger than the upload chunks", granularity);
+                return {};
+            }
+
+            while (true)
+            {
+                if (!batch.empty())
+                {
+                    Chunk& chunk = chunks[batch.back()];
+
+                    const uint32 offset = std::min((chunk.used + ALIGNMENT - 1) & ~(ALIGNMENT - 1), CHUNK_SIZE);
+                    const uint32 available = (CHUNK_SIZE - offset) / granularity * granularity;
+                    const uint32 span_size = std::min(size, available);
+
+                    // Splitting off a few bytes at the end of a chunk isn't worth an extra copy command.
+                    if (span_size == size || (span_size > 0 && span_size >= MIN_SPLIT_SIZE))
+                    {
+                        chunk.used = offset + span_size;
+                        return Span{chunk.buffer, offset, span_size, chunk.mapping + offset};
+                    }
+                }
+
+                if (!OpenChunk()) return {};
+            }
+        }
+
+        // Chunks need to be unmapped before the copy pass reads from them.
+        void Unmap()
+        {
+            for (const uint32 index : batch)
+            {
+                if (chunks[index].mapping == nullptr) continue;
+
+                SDL_UnmapGPUTransferBuffer(device, chunks[index].buffer);
+                chunks[index].mapping = nullptr;
+            }
+        }
+
+        // The chunks written since the last call are in flight until the fence of the copy command buffer is signaled.
+        void Submit(SDL_GPUFence* fence)
+        {
+            Unmap();
+            if (batch.empty()) return;
+
+            if (fence == nullptr)
+            {
+                // Without a fence there is no way to know when the GPU is done, so the chunks are waited for with the device.
+                SDL_WaitForGPUIdle(device);
+                for (const uint32 index : batch) { free_chunks.push_back(index); }
+            }
+            else { in_flight.push_back(Batch{fence, std::move(batch)}); }
+
+            batch.clear();
+        }
+
+        // The chunks written since the last call were recorded into the render command buffer of the frame,
+        // they are in flight until the fence of that frame is waited for and ReleaseFrame is called with its slot.
+        void SubmitWithFrame(const uint32 frame)
+        {
+            Unmap();
+            frame_batches[frame].insert(frame_batches[frame].end(), batch.begin(), batch.end());
+            batch.clear();
+        }
+
+        void ReleaseFrame(const uint32 frame)
+        {
+            free_chunks.insert(free_chunks.end(), frame_batches[frame].begin(), frame_batches[frame].end());
+            frame_batches[frame].clear();
+        }
+
+        void Destroy()
+        {
+            Unmap();
+            for (const Batch& in_flight_batch : in_flight)
+            {
+                SDL_WaitForGPUFences(device, true, &in_flight_batch.fence, 1);
+                SDL_ReleaseGPUFence(device, in_flight_batch.fence);
+            }
+
+            for (const Chunk& chunk : chunks) { SDL_ReleaseGPUTransferBuffer(device, chunk.buffer); }
+
+            chunks.clear();
+            free_chunks.clear();
+            in_flight.clear();
+            batch.clear();
+            for (std::vector<uint32>& frame_batch : frame_batches) { frame_batch.clear(); }
+        }
+
+        [[nodiscard]] usize GetChunkCount() const { return chunks.size(); }
+
+      private:
+        static constexpr uint32 ALIGNMENT = 16;
+        static constexpr uint32 MIN_SPLIT_SIZE = 64 * 1024;
+
+        struct Chunk
+        {
+            SDL_GPUTransferBuffer* buffer{nullptr};
+            uint8* mapping{nullptr};
+            uint32 used{0};
+        };
+
+        struct Batch
+        {
+            SDL_GPUFence* fence;
+            std::vector<uint32> chunks;
+        };
+
+        bool OpenChunk()
+        {
+            Reclaim(false);
+            if (free_chunks.empty() && chunks.size() >= MAX_CHUNKS) Reclaim(true);
+
+            uint32 index;
+            if (free_chunks.empty())
+            {
+                const SDL_GPUTransferBufferCreateInfo transfer_buffer_info{
+                    .usage = SDL_GPU_TRANSFERBUFFERUSAGE_UPLOAD, .size = CHUNK_SIZE, .props = 0
+                };
+
+                SDL_GPUTransferBuffer* buffer = SDL_CreateGPUTransferBuffer(device, &transfer_buffer_info);
+                if (buffer == nullptr)
+                {
+                    Log::Error("Failed to create upload transfer buffer: {}", SDL_GetError());
+                    return false;
+                }
+
+                index = static_cast<uint32>(chunks.size());
+                chunks.push_back(Chunk{buffer});
+            }
+            else
+            {
+                index = free_chunks.back();
+                free_chunks.pop_back();
+            }
+
+            Chunk& chunk = chunks[index];
+            chunk.mapping = static_cast<uint8*>(SDL_MapGPUTransferBuffer(device, chunk.buffer, false));
+            chunk.used = 0;
+            if (chunk.mapping == nullptr)
+            {
+                Log::Error("Failed to map upload transfer buffer: {}", SDL_GetError());
+                free_chunks.push_back(index);
+                return false;
+            }
+
+            batch.push_back(index);
+            return true;
         }
 
-        void* buffer_mapping = SDL_MapGPUTransferBuffer(device, transfer_buffer, false);
-        if (buffer_mapping == nullptr)
+        // Returns the chunks of finished batches, wait blocks until at least the oldest batch is finished.
+        void Reclaim(const bool wait)
         {
-            Log::Error("Failed to map transfer buffer: {}", SDL_GetError());
-            return transfer_buffer;
+            if (wait && !in_flight.empty()) SDL_WaitForGPUFences(device, true, &in_flight.front().fence, 1);
+
+            while (!in_flight.empty() && SDL_QueryGPUFence(device, in_flight.front().fence))
+            {
+                SDL_ReleaseGPUFence(device, in_flight.front().fence);
+                free_chunks.insert(free_chunks.end(), in_flight.front().chunks.begin(), in_flight.front().chunks.end());
+                in_flight.pop_front();
+            }
         }
 
-        memcpy(buffer_mapping, upload_data, data_size);
-        SDL_UnmapGPUTransferBuffer(device, transfer_buffer);
+        std::vector<Chunk> chunks;
+        std::vector<uint32> free_chunks;
+        // Chunks written since the last submit, the last one is still being filled.
+        std::vector<uint32> batch;
+        std::deque<Batch> in_flight;
+        std::array<std::vector<uint32>, FRAMES_IN_FLIGHT> frame_batches;
+    };
+    UploadRing upload_ring;
+
+    void QueueBufferUpload(SDL_GPUBuffer* buffer, const uint32 offset, const void* data, const uint32 size)
+    {
+        const auto* source = static_cast<const uint8*>(data);
+        for (uint32 written = 0; written < size;)
+        {
+            const UploadRing::Span span = upload_ring.Allocate(size - written);
+            if (span.buffer == nullptr) return;
+
+            std::memcpy(span.data, source + written, span.size);
+
+            auto& [transfer_location, region] = buffer_copies.emplace_back();
+            transfer_location = SDL_GPUTransferBufferLocation{.transfer_buffer = span.buffer, .offset = span.offset};
+            region = SDL_GPUBufferRegion{.buffer = buffer, .offset = offset + written, .size = span.size};
+
+            written += span.size;
+        }
+    }
+
+    // Uploads the rows starting at first_row, data points to the first of them.
+    void QueueTextureUpload(
+        SDL_GPUTexture* texture, const uint32 width, const uint32 first_row, const uint32 row_count, const uint8* data,
+        const uint32 row_size
+    )
+    {
+        for (uint32 row = 0; row < row_count;)
+        {
+            const UploadRing::Span span = upload_ring.Allocate((row_count - row) * row_size, row_size);
+            if (span.buffer == nullptr) return;
 
-        return transfer_buffer;
+            const uint32 span_rows = span.size / row_size;
+            std::memcpy(span.data, data + static_cast<usize>(row) * row_size, span.size);
+
+            auto& [transfer_info, region] = texture_copies.emplace_back();
+            transfer_info = SDL_GPUTextureTransferInfo{
+                .transfer_buffer = span.buffer, .offset = span.offset, .pixels_per_row = width, .rows_per_layer = span_rows
+            };
+            region = SDL_GPUTextureRegion{.texture = texture, .y = first_row + row, .w = width, .h = span_rows, .d = 1};
+
+            row += span_rows;
+        }
+    }
+
+    // Records a copy pass with the queued uploads, the caller hands the written chunks to the upload ring with the command buffer.
+    void RecordUploads(SDL_GPUCommandBuffer* command_buffer)
+    {
+        upload_ring.Unmap();
+        SDL_GPUCopyPass* copy_pass = SDL_BeginGPUCopyPass(command_buffer);
+
+        for (const auto& [transfer_info, region] : texture_copies) { SDL_UploadToGPUTexture(copy_pass, &transfer_info, &region, false); }
+
+        for (const auto& [transfer_location, region] : buffer_copies)
+        {
+            SDL_UploadToGPUBuffer(copy_pass, &transfer_location, &region, false);
+        }
+
+        SDL_EndGPUCopyPass(copy_pass);
+
+        texture_copies.clear();
+        buffer_copies.clear();
     }
 
     void DataUploadPass()
     {
         if (texture_copies.empty() && buffer_copies.empty()) return;
 
+        PROFILE_ZONE("DataUploadPass");
+
         SDL_GPUCommandBuffer* command_buffer = SDL_AcquireGPUCommandBuffer(device);
         if (command_buffer == nullptr)
         {
@@ -70,26 +425,730 @@ namespace
             return;
         }
 
+        RecordUploads(command_buffer);
+
+        SDL_GPUFence* fence = SDL_SubmitGPUCommandBufferAndAcquireFence(command_buffer);
+        if (fence == nullptr) { Log::Error("Failed to submit copy command buffer: {}", SDL_GetError()); }
+        upload_ring.Submit(fence);
+    }
+
+    // Vertex and index buffers shared by all meshes, the geometry allocator of the renderer decides where the meshes go.
+    // The positions are also stored on their own at the same vertex offsets, for passes that only need depth.
+    SDL_GPUBuffer* geometry_vertex_buffer = nullptr;
+    SDL_GPUBuffer* geometry_position_buffer = nullptr;
+    SDL_GPUBuffer* geometry_index_buffer = nullptr;
+    uint32 geometry_vertex_capacity = 0;
+    uint32 geometry_index_capacity = 0;
+
+    // Whether the shared buffers are bound in the active render pass, so consecutive draws don't bind them again.
+    bool geometry_bound = false;
+
+    void ReleaseGeometryBuffers(SDL_GPUBuffer* vertex_buffer, SDL_GPUBuffer* position_buffer, SDL_GPUBuffer* index_buffer)
+    {
+        SDL_ReleaseGPUBuffer(device, vertex_buffer);
+        SDL_ReleaseGPUBuffer(device, position_buffer);
+        SDL_ReleaseGPUBuffer(device, index_buffer);
+    }
+
+    struct BufferMove
+    {
+        SDL_GPUBuffer* source;
+        SDL_GPUBuffer* destination;
+        uint32 source_offset;
+        uint32 destination_offset;
+        uint32 size;
+    };
+
+    // Copies the ranges on the GPU, pending uploads are submitted first since they might still target the source buffers.
+    void CopyBufferRanges(const std::vector<BufferMove>& moves)
+    {
+        DataUploadPass();
+        if (moves.empty()) return;
+
+        SDL_GPUCommandBuffer* command_buffer = SDL_AcquireGPUCommandBuffer(device);
+        if (command_buffer == nullptr)
+        {
+            Log::Error("Failed to acquire buffer copy command buffer: {}", SDL_GetError());
+            return;
+        }
+
         SDL_GPUCopyPass* copy_pass = SDL_BeginGPUCopyPass(command_buffer);
+        for (const auto& [source, destination, source_offset, destination_offset, size] : moves)
+        {
+            const SDL_GPUBufferLocation source_location{.buffer = source, .offset = source_offset};
+            const SDL_GPUBufferLocation destination_location{.buffer = destination, .offset = destination_offset};
+            SDL_CopyGPUBufferToBuffer(copy_pass, &source_location, &destination_location, size, false);
+        }
+        SDL_EndGPUCopyPass(copy_pass);
+
+        if (!SDL_SubmitGPUCommandBuffer(command_buffer)) { Log::Error("Failed to submit buffer copy command buffer: {}", SDL_GetError()); }
+    }
+
+    SDL_GPUBuffer* CreateGeometryBuffer(const SDL_GPUBufferUsageFlags usage, const uint32 size)
+    {
+        const SDL_GPUBufferCreateInfo buffer_info{.usage = usage, .size = size, .props = 0};
+
+        SDL_GPUBuffer* buffer = SDL_CreateGPUBuffer(device, &buffer_info);
+        if (buffer == nullptr) Log::Error("Failed to create geometry buffer: {}", SDL_GetError());
+
+        return buffer;
+    }
 
-        for (const auto& [transfer_info, region] : texture_copies)
+    // Creates buffers of the new capacities and copies the existing meshes over, their offsets stay the same.
+    void ReserveGeometry(const uint32 vertex_capacity, const uint32 index_capacity)
+    {
+        SDL_GPUBuffer* vertex_buffer = CreateGeometryBuffer(SDL_GPU_BUFFERUSAGE_VERTEX, vertex_capacity * sizeof(Vertex));
+        SDL_GPUBuffer* position_buffer = CreateGeometryBuffer(SDL_GPU_BUFFERUSAGE_VERTEX, vertex_capacity * sizeof(float3));
+        SDL_GPUBuffer* index_buffer = CreateGeometryBuffer(SDL_GPU_BUFFERUSAGE_INDEX, index_capacity * sizeof(uint32));
+        if (vertex_buffer == nullptr || position_buffer == nullptr || index_buffer == nullptr)
         {
-            SDL_UploadToGPUTexture(copy_pass, &transfer_info, &region, false);
-            SDL_ReleaseGPUTransferBuffer(device, transfer_info.transfer_buffer);
+            ReleaseGeometryBuffers(vertex_buffer, position_buffer, index_buffer);
+            return;
         }
 
-        for (const auto& [transfer_location, region] : buffer_copies)
+        std::vector<BufferMove> moves;
+        if (geometry_vertex_buffer != nullptr)
         {
-            SDL_UploadToGPUBuffer(copy_pass, &transfer_location, &region, false);
-            SDL_ReleaseGPUTransferBuffer(device, transfer_location.transfer_buffer);
+            const auto vertices_size = static_cast<uint32>(geometry_vertex_capacity * sizeof(Vertex));
+            const auto positions_size = static_cast<uint32>(geometry_vertex_capacity * sizeof(float3));
+            const auto indices_size = static_cast<uint32>(geometry_index_capacity * sizeof(uint32));
+
+            moves.push_back(BufferMove{geometry_vertex_buffer, vertex_buffer, 0, 0, vertices_size});
+            moves.push_back(BufferMove{geometry_position_buffer, position_buffer, 0, 0, positions_size});
+            moves.push_back(BufferMove{geometry_index_buffer, index_buffer, 0, 0, indices_size});
         }
+        CopyBufferRanges(moves);
 
-        SDL_EndGPUCopyPass(copy_pass);
+        if (geometry_vertex_buffer != nullptr)
+        {
+            GetDeletionQueue().buffers.push_back(geometry_vertex_buffer);
+            GetDeletionQueue().buffers.push_back(geometry_position_buffer);
+            GetDeletionQueue().buffers.push_back(geometry_index_buffer);
+        }
 
-        texture_copies.clear();
-        buffer_copies.clear();
+        geometry_vertex_buffer = vertex_buffer;
+        geometry_position_buffer = position_buffer;
+        geometry_index_buffer = index_buffer;
+        geometry_vertex_capacity = vertex_capacity;
+        geometry_index_capacity = index_capacity;
+        geometry_bound = false;
+    }
+
+    void AddRepackMoves(
+        std::vector<BufferMove>& moves, SDL_GPUBuffer* source, SDL_GPUBuffer* destination,
+        const std::vector<OffsetAllocator::Relocation>& relocations, const OffsetAllocator& allocator, const uint32 stride
+    )
+    {
+        // Allocations before the first relocation kept their offsets and are copied at once.
+        const uint32 unmoved_size = relocations.empty() ? allocator.GetUsed() : relocations.front().destination;
+        if (unmoved_size > 0) moves.push_back(BufferMove{source, destination, 0, 0, unmoved_size * stride});
+
+        for (const OffsetAllocator::Relocation& relocation : relocations)
+        {
+            moves.push_back(
+                BufferMove{source, destination, relocation.source * stride, relocation.destination * stride, relocation.size * stride}
+            );
+        }
+    }
+
+    // Packs the meshes to the start of new buffers of the same size, copies within a buffer can't overlap.
+    void DefragmentGeometryBuffers(GeometryAllocator& allocator)
+    {
+        SDL_GPUBuffer* vertex_buffer = CreateGeometryBuffer(SDL_GPU_BUFFERUSAGE_VERTEX, geometry_vertex_capacity * sizeof(Vertex));
+        SDL_GPUBuffer* position_buffer = CreateGeometryBuffer(SDL_GPU_BUFFERUSAGE_VERTEX, geometry_vertex_capacity * sizeof(float3));
+        SDL_GPUBuffer* index_buffer = CreateGeometryBuffer(SDL_GPU_BUFFERUSAGE_INDEX, geometry_index_capacity * sizeof(uint32));
+        if (vertex_buffer == nullptr || position_buffer == nullptr || index_buffer == nullptr)
+        {
+            ReleaseGeometryBuffers(vertex_buffer, position_buffer, index_buffer);
+            return;
+        }
+
+        std::vector<OffsetAllocator::Relocation> vertex_relocations;
+        std::vector<OffsetAllocator::Relocation> index_relocations;
+        allocator.Defragment(vertex_relocations, index_relocations);
+
+        std::vector<BufferMove> moves;
+        AddRepackMoves(moves, geometry_vertex_buffer, vertex_buffer, vertex_relocations, allocator.GetVertices(), sizeof(Vertex));
+        AddRepackMoves(moves, geometry_position_buffer, position_buffer, vertex_relocations, allocator.GetVertices(), sizeof(float3));
+        AddRepackMoves(moves, geometry_index_buffer, index_buffer, index_relocations, allocator.GetIndices(), sizeof(uint32));
+        CopyBufferRanges(moves);
+
+        GetDeletionQueue().buffers.push_back(geometry_vertex_buffer);
+        GetDeletionQueue().buffers.push_back(geometry_position_buffer);
+        GetDeletionQueue().buffers.push_back(geometry_index_buffer);
+
+        geometry_vertex_buffer = vertex_buffer;
+        geometry_position_buffer = position_buffer;
+        geometry_index_buffer = index_buffer;
+        geometry_bound = false;
+    }
+
+    // Uploads waiting to be copied to the upload ring, at most the upload budget is sent to the GPU per frame.
+    // Uploads keep their own copy of the data, mesh uploads look up their offsets when they are sent since defragmenting moves them.
+    class UploadScheduler
+    {
+      public:
+        void QueueMesh(
+            Mesh& mesh, const std::vector<Vertex>& vertices, const std::vector<uint32>& indices, const Renderer::UploadPriority priority
+        )
+        {
+            positions.resize(vertices.size());
+            for (usize i = 0; i < vertices.size(); i++) { positions[i] = vertices[i].position; }
+
+            Queue(PendingUpload{Target::VERTICES, priority, &mesh, &mesh}, vertices.data(), vertices.size() * sizeof(Vertex));
+            Queue(PendingUpload{Target::POSITIONS, priority, &mesh, &mesh}, positions.data(), positions.size() * sizeof(float3));
+            Queue(PendingUpload{Target::INDICES, priority, &mesh, &mesh}, indices.data(), indices.size() * sizeof(uint32));
+
+            mesh.resident = !pending_counts.contains(&mesh);
+        }
+
+        // Only the base level is uploaded, the other levels are generated from it once all of its rows are sent.
+        void QueueTexture(
+            SDL_GPUTexture* texture, const uint32 width, const uint32 height, const uint8* data, const uint32 size,
+            const bool generate_mipmaps, const Renderer::UploadPriority priority
+        )
+        {
+            if (height == 0) return;
+
+            PendingUpload upload{Target::TEXTURE, priority, texture};
+            upload.texture = texture;
+            upload.width = width;
+            upload.row_size = size / height;
+            upload.generate_mipmaps = generate_mipmaps;
+            Queue(std::move(upload), data, size);
+        }
+
+        // Textures are keyed by their backend texture, so moving the Texture that owns it doesn't matter.
+        [[nodiscard]] bool IsPending(const void* owner) const { return pending_counts.contains(owner); }
+
+        // Sends the uploads of the resource before the ones of lower priority.
+        void Promote(const void* owner)
+        {
+            if (pending_counts.contains(owner)) promoted.insert(owner);
+        }
+
+        // Drops the pending uploads of a resource that is destroyed.
+        void Cancel(const void* owner)
+        {
+            if (!pending_counts.contains(owner)) return;
+
+            std::erase_if(pending, [owner](const PendingUpload& upload) { return upload.owner == owner; });
+            pending_counts.erase(owner);
+            promoted.erase(owner);
+            std::erase(mipmap_textures, owner);
+        }
+
+        // Sends all pending uploads of the resource right away regardless of the budget, for copies that read it outside of a pass.
+        void Flush(const void* owner)
+        {
+            if (!pending_counts.contains(owner)) return;
+
+            for (PendingUpload& upload : pending)
+            {
+                if (upload.owner == owner) Send(upload, upload.data.size() - upload.sent);
+            }
+            Cancel(owner);
+        }
+
+        /// @brief Copies the data of the pending uploads to the upload ring, visible and promoted uploads first.
+        /// @return The amount of bytes sent, can be slightly above the budget since texture uploads always send at least a row.
+        usize Schedule(const usize budget)
+        {
+            usize sent = 0;
+            for (const bool visible : {true, false})
+            {
+                for (PendingUpload& upload : pending)
+                {
+                    if (sent >= budget) break;
+                    if (IsVisible(upload) != visible || upload.sent == upload.data.size()) continue;
+
+                    sent += Send(upload, budget - sent);
+                }
+            }
+
+            for (const PendingUpload& upload : pending)
+            {
+                if (upload.sent < upload.data.size() || --pending_counts[upload.owner] > 0) continue;
+
+                pending_counts.erase(upload.owner);
+                promoted.erase(upload.owner);
+                if (upload.mesh != nullptr) upload.mesh->resident = true;
+                // The mipmaps are generated at the start of the frame's command buffer, before any pass samples the texture.
+                if (upload.generate_mipmaps) mipmap_textures.push_back(upload.texture);
+            }
+            std::erase_if(pending, [](const PendingUpload& upload) { return upload.sent == upload.data.size(); });
+
+            return sent;
+        }
+
+        // Records the mipmap generation of the textures whose upload finished, must be called outside of a pass after the upload pass.
+        void GenerateMipmaps(SDL_GPUCommandBuffer* command_buffer)
+        {
+            for (SDL_GPUTexture* texture : mipmap_textures) { SDL_GenerateMipmapsForGPUTexture(command_buffer, texture); }
+            mipmap_textures.clear();
+        }
+
+        [[nodiscard]] uint32 GetPendingCount() const { return static_cast<uint32>(pending.size()); }
+        [[nodiscard]] usize GetPendingBytes() const
+        {
+            usize bytes = 0;
+            for (const PendingUpload& upload : pending) { bytes += upload.data.size() - upload.sent; }
+            return bytes;
+        }
+
+      private:
+        enum class Target : uint8
+        {
+            VERTICES,
+            POSITIONS,
+            INDICES,
+            TEXTURE
+        };
+
+        struct PendingUpload
+        {
+            Target target;
+            Renderer::UploadPriority priority;
+            const void* owner;
+
+            Mesh* mesh{nullptr};
+            SDL_GPUTexture* texture{nullptr};
+            uint32 width{0};
+            uint32 row_size{0};
+            bool generate_mipmaps{false};
+
+            std::vector<uint8> data;
+            usize sent{0};
+        };
+
+        void Queue(PendingUpload&& upload, const void* data, const usize size)
+        {
+            if (size == 0) return;
+
+            const auto* bytes = static_cast<const uint8*>(data);
+            upload.data.assign(bytes, bytes + size);
+
+            pending_counts[upload.owner]++;
+            pending.push_back(std::move(upload));
+        }
+
+        [[nodiscard]] bool IsVisible(const PendingUpload& upload) const
+        {
+            return upload.priority == Renderer::UploadPriority::VISIBLE || promoted.contains(upload.owner);
+        }
+
+        // Sends as much of the upload as the budget allows, returns the amount of bytes sent.
+        static usize Send(PendingUpload& upload, const usize budget)
+        {
+            const usize remaining = upload.data.size() - upload.sent;
+            const uint8* data = upload.data.data() + upload.sent;
+
+            if (upload.target == Target::TEXTURE)
+            {
+                const uint32 first_row = static_cast<uint32>(upload.sent / upload.row_size);
+                const auto row_count = static_cast<uint32>(std::clamp<usize>(budget / upload.row_size, 1, remaining / upload.row_size));
+
+                QueueTextureUpload(upload.texture, upload.width, first_row, row_count, data, upload.row_size);
+                upload.sent += static_cast<usize>(row_count) * upload.row_size;
+                return static_cast<usize>(row_count) * upload.row_size;
+            }
+
+            const auto size = static_cast<uint32>(std::min(remaining, budget));
+            if (upload.target == Target::VERTICES)
+            {
+                const usize offset = static_cast<usize>(upload.mesh->base_vertex) * sizeof(Vertex) + upload.sent;
+                QueueBufferUpload(geometry_vertex_buffer, static_cast<uint32>(offset), data, size);
+            }
+            else if (upload.target == Target::POSITIONS)
+            {
+                const usize offset = static_cast<usize>(upload.mesh->base_vertex) * sizeof(float3) + upload.sent;
+                QueueBufferUpload(geometry_position_buffer, static_cast<uint32>(offset), data, size);
+            }
+            else
+            {
+                const usize offset = static_cast<usize>(upload.mesh->first_index) * sizeof(uint32) + upload.sent;
+                QueueBufferUpload(geometry_index_buffer, static_cast<uint32>(offset), data, size);
+            }
+
+            upload.sent += size;
+            return size;
+        }
+
+        std::vector<PendingUpload> pending;
+        // Uploads left per owner, a mesh becomes resident once all of its uploads are sent.
+        std::unordered_map<const void*, uint32> pending_counts;
+        std::unordered_set<const void*> promoted;
+        std::vector<SDL_GPUTexture*> mipmap_textures;
+        // Scratch memory the positions of a mesh are gathered in before they are queued.
+        std::vector<float3> positions;
+    };
+    UploadScheduler upload_scheduler;
+
+    // Sampled instead of textures that aren't resident yet, a single grey texel.
+    SDL_GPUTexture* fallback_texture = nullptr;
 
-        if (!SDL_SubmitGPUCommandBuffer(command_buffer)) { Log::Error("Failed to submit copy command buffer: {}", SDL_GetError()); }
+    void CreateFallbackTexture()
+    {
+        const SDL_GPUTextureCreateInfo texture_create_info{
+            .type = SDL_GPU_TEXTURETYPE_2D,
+            .format = SDL_GPU_TEXTUREFORMAT_R8G8B8A8_UNORM,
+            .usage = SDL_GPU_TEXTUREUSAGE_SAMPLER,
+            .width = 1,
+            .height = 1,
+            .layer_count_or_depth = 1,
+            .num_levels = 1,
+        };
+
+        fallback_texture = SDL_CreateGPUTexture(device, &texture_create_info);
+        if (fallback_texture == nullptr)
+        {
+            Log::Error("Failed to create fallback texture: {}", SDL_GetError());
+            return;
+        }
+
+        // Visible uploads are sent before the first pass, so the fallback is ready before anything samples it.
+        constexpr uint8 texel[4] = {128, 128, 128, 255};
+        upload_scheduler.QueueTexture(fallback_texture, 1, 1, texel, sizeof(texel), false, Renderer::UploadPriority::VISIBLE);
+    }
+
+    // Samplers by their settings, textures only reference them so thousands of textures share a handful of samplers.
+    // Samplers are never released before the device, there are only as many as there are distinct settings.
+    class SamplerCache
+    {
+      public:
+        SDL_GPUSampler* Get(const SamplerSettings& settings)
+        {
+            const auto [iterator, inserted] = samplers.try_emplace(settings, nullptr);
+            if (inserted) iterator->second = Create(settings);
+
+            return iterator->second;
+        }
+
+        // Only called once the GPU is idle.
+        void Destroy()
+        {
+            for (const auto& [settings, sampler] : samplers)
+            {
+                if (sampler != nullptr) SDL_ReleaseGPUSampler(device, sampler);
+            }
+            samplers.clear();
+        }
+
+      private:
+        // SDL doesn't expose the limit of the device, every device with anisotropic filtering supports at least 16.
+        static constexpr float MAX_ANISOTROPY = 16.0f;
+
+        static SDL_GPUSampler* Create(const SamplerSettings& settings)
+        {
+            const SDL_GPUSamplerCreateInfo sampler_info{
+                .min_filter = static_cast<SDL_GPUFilter>(settings.down_filter),
+                .mag_filter = static_cast<SDL_GPUFilter>(settings.up_filter),
+                .mipmap_mode = static_cast<SDL_GPUSamplerMipmapMode>(settings.mipmap_mode),
+                .address_mode_u = static_cast<SDL_GPUSamplerAddressMode>(settings.wrap_mode_u),
+                .address_mode_v = static_cast<SDL_GPUSamplerAddressMode>(settings.wrap_mode_v),
+                .address_mode_w = SDL_GPU_SAMPLERADDRESSMODE_CLAMP_TO_EDGE,
+                .max_anisotropy = std::min(settings.max_anisotropy, MAX_ANISOTROPY),
+                .min_lod = 0.0f,
+                // Doesn't limit the levels, like VK_LOD_CLAMP_NONE. The default of 0 would only ever sample the base level.
+                .max_lod = 1000.0f,
+                .enable_anisotropy = settings.max_anisotropy > 1.0f
+            };
+
+            SDL_GPUSampler* sampler = SDL_CreateGPUSampler(device, &sampler_info);
+            if (sampler == nullptr) Log::Error("Failed to create sampler: {}", SDL_GetError());
+
+            return sampler;
+        }
+
+        std::unordered_map<SamplerSettings, SDL_GPUSampler*> samplers;
+    };
+    SamplerCache sampler_cache;
+
+    // Graphics pipelines by the hash of their description: the shaders, the fixed function state and the formats of the target.
+    // Passes with the same description share one pipeline, prewarmed pipelines are created on a worker thread ahead of their first use.
+    class PipelineCache
+    {
+      public:
+        static constexpr uint32 MAX_COLOR_TARGETS = 4;
+
+        struct Description
+        {
+            SDL_GPUShader* vertex_shader{nullptr};
+            SDL_GPUShader* fragment_shader{nullptr};
+            PipelineState state;
+
+            std::array<SDL_GPUTextureFormat, MAX_COLOR_TARGETS> color_formats{};
+            uint32 color_target_count{0};
+            // SDL_GPU_TEXTUREFORMAT_INVALID when the target has no depth buffer.
+            SDL_GPUTextureFormat depth_format{SDL_GPU_TEXTUREFORMAT_INVALID};
+
+            bool operator==(const Description&) const = default;
+        };
+
+        /// @brief Returns the pipeline of the description, nullptr when it failed to be created.
+        /// @param stalled Set when the pipeline had to be created or waited for because it wasn't prewarmed in time.
+        SDL_GPUGraphicsPipeline* Get(const Description& description, bool& stalled)
+        {
+            const auto [iterator, inserted] = entries.try_emplace(description);
+            Entry& entry = iterator->second;
+
+            if (inserted)
+            {
+                entry.pipeline = Create(description);
+                stalled = true;
+            }
+            else if (entry.pending.valid())
+            {
+                stalled = entry.pending.wait_for(std::chrono::seconds{0}) != std::future_status::ready;
+                entry.pipeline = entry.pending.get();
+            }
+
+            return entry.pipeline;
+        }
+
+        // Starts creating the pipeline on a worker thread if it doesn't exist yet.
+        void Prewarm(const Description& description)
+        {
+            const auto [iterator, inserted] = entries.try_emplace(description);
+            if (inserted) iterator->second.pending = std::async(std::launch::async, &PipelineCache::Create, description);
+        }
+
+        // The pointer of a released shader can be reused by a new one, so the pipelines created from it can't stay in the cache.
+        void Evict(const SDL_GPUShader* shader, std::vector<SDL_GPUGraphicsPipeline*>& deletions)
+        {
+            for (auto iterator = entries.begin(); iterator != entries.end();)
+            {
+                const Description& description = iterator->first;
+                if (description.vertex_shader != shader && description.fragment_shader != shader)
+                {
+                    ++iterator;
+                    continue;
+                }
+
+                Entry& entry = iterator->second;
+                SDL_GPUGraphicsPipeline* pipeline = entry.pending.valid() ? entry.pending.get() : entry.pipeline;
+                if (pipeline != nullptr) deletions.push_back(pipeline);
+
+                iterator = entries.erase(iterator);
+            }
+        }
+
+        // Only called once the GPU is idle.
+        void Destroy()
+        {
+            for (auto& [description, entry] : entries)
+            {
+                SDL_GPUGraphicsPipeline* pipeline = entry.pending.valid() ? entry.pending.get() : entry.pipeline;
+                if (pipeline != nullptr) SDL_ReleaseGPUGraphicsPipeline(device, pipeline);
+            }
+            entries.clear();
+        }
+
+      private:
+        struct DescriptionHash
+        {
+            usize operator()(const Description& description) const
+            {
+                usize hash = std::hash<const void*>{}(description.vertex_shader);
+                const auto combine = [&hash](const uint64 value) { hash ^= value + 0x9E3779B97F4A7C15ull + (hash << 6) + (hash >> 2); };
+
+                combine(reinterpret_cast<uintptr_t>(description.fragment_shader));
+                combine(description.state.GetHash());
+                for (uint32 i = 0; i < description.color_target_count; i++) { combine(description.color_formats[i]); }
+                combine(description.color_target_count);
+                combine(description.depth_format);
+
+                return hash;
+            }
+        };
+
+        struct Entry
+        {
+            SDL_GPUGraphicsPipeline* pipeline{nullptr};
+            // Valid while the pipeline is created on a worker thread.
+            std::future<SDL_GPUGraphicsPipeline*> pending;
+        };
+
+        static SDL_GPUColorTargetBlendState ToBlendState(const PipelineState::BlendMode blend)
+        {
+            switch (blend)
+            {
+            case PipelineState::BlendMode::ALPHA:
+                return SDL_GPUColorTargetBlendState{
+                    .src_color_blendfactor = SDL_GPU_BLENDFACTOR_SRC_ALPHA,
+                    .dst_color_blendfactor = SDL_GPU_BLENDFACTOR_ONE_MINUS_SRC_ALPHA,
+                    .color_blend_op = SDL_GPU_BLENDOP_ADD,
+                    .src_alpha_blendfactor = SDL_GPU_BLENDFACTOR_SRC_ALPHA,
+                    .dst_alpha_blendfactor = SDL_GPU_BLENDFACTOR_ONE_MINUS_SRC_ALPHA,
+                    .alpha_blend_op = SDL_GPU_BLENDOP_ADD,
+                    .enable_blend = true
+                };
+            case PipelineState::BlendMode::ADDITIVE:
+                return SDL_GPUColorTargetBlendState{
+                    .src_color_blendfactor = SDL_GPU_BLENDFACTOR_ONE,
+                    .dst_color_blendfactor = SDL_GPU_BLENDFACTOR_ONE,
+                    .color_blend_op = SDL_GPU_BLENDOP_ADD,
+                    .src_alpha_blendfactor = SDL_GPU_BLENDFACTOR_ONE,
+                    .dst_alpha_blendfactor = SDL_GPU_BLENDFACTOR_ONE,
+                    .alpha_blend_op = SDL_GPU_BLENDOP_ADD,
+                    .enable_blend = true
+                };
+            case PipelineState::BlendMode::REPLACE:
+            default: return SDL_GPUColorTargetBlendState{};
+            }
+        }
+
+        static SDL_GPUCompareOp ToCompareOp(const PipelineState::CompareOp compare)
+        {
+            switch (compare)
+            {
+            case PipelineState::CompareOp::LESS_OR_EQUAL: return SDL_GPU_COMPAREOP_LESS_OR_EQUAL;
+            case PipelineState::CompareOp::EQUAL: return SDL_GPU_COMPAREOP_EQUAL;
+            case PipelineState::CompareOp::ALWAYS: return SDL_GPU_COMPAREOP_ALWAYS;
+            case PipelineState::CompareOp::LESS:
+            default: return SDL_GPU_COMPAREOP_LESS;
+            }
+        }
+
+        static SDL_GPUCullMode ToCullMode(const PipelineState::CullMode cull)
+        {
+            switch (cull)
+            {
+            case PipelineState::CullMode::NONE: return SDL_GPU_CULLMODE_NONE;
+            case PipelineState::CullMode::FRONT: return SDL_GPU_CULLMODE_FRONT;
+            case PipelineState::CullMode::BACK:
+            default: return SDL_GPU_CULLMODE_BACK;
+            }
+        }
+
+        // Called from worker threads, SDL allows creating GPU resources on any thread.
+        static SDL_GPUGraphicsPipeline* Create(const Description& description)
+        {
+            const PipelineState& state = description.state;
+
+            std::array<SDL_GPUColorTargetDescription, MAX_COLOR_TARGETS> color_target_descriptions{};
+            for (uint32 i = 0; i < description.color_target_count; i++)
+            {
+                color_target_descriptions[i] = {.format = description.color_formats[i], .blend_state = ToBlendState(state.blend)};
+                if (!state.color_write)
+                {
+                    color_target_descriptions[i].blend_state.color_write_mask = 0;
+                    color_target_descriptions[i].blend_state.enable_color_write_mask = true;
+                }
+            }
+
+            const SDL_GPUGraphicsPipelineTargetInfo target_info{
+                .color_target_descriptions = color_target_descriptions.data(),
+                .num_color_targets = description.color_target_count,
+                .depth_stencil_format = description.depth_format,
+                .has_depth_stencil_target = description.depth_format != SDL_GPU_TEXTUREFORMAT_INVALID
+            };
+
+            // The instanced layout reads the rows of the model matrix from a second buffer, after the attributes of the vertex.
+            static constexpr SDL_GPUVertexBufferDescription vertex_buffer_descriptions[2]{
+                {.slot = 0, .pitch = sizeof(float) * 8, .input_rate = SDL_GPU_VERTEXINPUTRATE_VERTEX  },
+                {.slot = 1, .pitch = sizeof(Matrix4),   .input_rate = SDL_GPU_VERTEXINPUTRATE_INSTANCE}
+            };
+            // The position layout reads the tightly packed position buffer, with the position as its only attribute.
+            static constexpr SDL_GPUVertexBufferDescription position_buffer_description{
+                .slot = 0, .pitch = sizeof(float) * 3, .input_rate = SDL_GPU_VERTEXINPUTRATE_VERTEX
+            };
+
+            static constexpr SDL_GPUVertexAttribute vertex_attributes[7]{
+                {.location = 0, .buffer_slot = 0, .format = SDL_GPU_VERTEXELEMENTFORMAT_FLOAT3, .offset = 0                 },
+                {.location = 1, .buffer_slot = 0, .format = SDL_GPU_VERTEXELEMENTFORMAT_FLOAT3, .offset = sizeof(float) * 3 },
+                {.location = 2, .buffer_slot = 0, .format = SDL_GPU_VERTEXELEMENTFORMAT_FLOAT2, .offset = sizeof(float) * 6 },
+                {.location = 3, .buffer_slot = 1, .format = SDL_GPU_VERTEXELEMENTFORMAT_FLOAT4, .offset = 0                 },
+                {.location = 4, .buffer_slot = 1, .format = SDL_GPU_VERTEXELEMENTFORMAT_FLOAT4, .offset = sizeof(float) * 4 },
+                {.location = 5, .buffer_slot = 1, .format = SDL_GPU_VERTEXELEMENTFORMAT_FLOAT4, .offset = sizeof(float) * 8 },
+                {.location = 6, .buffer_slot = 1, .format = SDL_GPU_VERTEXELEMENTFORMAT_FLOAT4, .offset = sizeof(float) * 12}
+            };
+
+            const bool instanced = state.vertex_layout == PipelineState::VertexLayout::MESH_INSTANCED_MODEL;
+            const bool positions = state.vertex_layout == PipelineState::VertexLayout::POSITION;
+            const SDL_GPUVertexInputState vertex_input_state{
+                .vertex_buffer_descriptions = positions ? &position_buffer_description : vertex_buffer_descriptions,
+                .num_vertex_buffers = instanced ? 2u : 1u,
+                .vertex_attributes = vertex_attributes,
+                .num_vertex_attributes = instanced ? 7u : (positions ? 1u : 3u)
+            };
+
+            const SDL_GPUDepthStencilState depth_stencil_state{
+                .compare_op = ToCompareOp(state.depth_compare),
+                .enable_depth_test = state.depth_test,
+                .enable_depth_write = state.depth_write,
+            };
+            const SDL_GPURasterizerState rasterizer_state{
+                .fill_mode = state.wireframe ? SDL_GPU_FILLMODE_LINE : SDL_GPU_FILLMODE_FILL,
+                .cull_mode = ToCullMode(state.cull),
+                .front_face = SDL_GPU_FRONTFACE_COUNTER_CLOCKWISE,
+                .enable_depth_clip = true,
+            };
+
+            const SDL_GPUGraphicsPipelineCreateInfo pipeline_create_info{
+                .vertex_shader = description.vertex_shader,
+                .fragment_shader = description.fragment_shader,
+                .vertex_input_state = vertex_input_state,
+                .primitive_type = SDL_GPU_PRIMITIVETYPE_TRIANGLELIST,
+                .rasterizer_state = rasterizer_state,
+                .multisample_state = {},
+                .depth_stencil_state = depth_stencil_state,
+                .target_info = target_info,
+                .props = 0
+            };
+
+            SDL_GPUGraphicsPipeline* pipeline = SDL_CreateGPUGraphicsPipeline(device, &pipeline_create_info);
+            if (pipeline == nullptr) Log::Error("Failed to create shader pipeline: {}", SDL_GetError());
+
+            return pipeline;
+        }
+
+        std::unordered_map<Description, Entry, DescriptionHash> entries;
+    };
+    PipelineCache pipeline_cache;
+
+    SDL_GPUTextureFormat ToTextureFormat(const Texture::ColorFormat format)
+    {
+        return format == Texture::COLOR_RGBA_32 ? SDL_GPU_TEXTUREFORMAT_R8G8B8A8_UNORM : SDL_GPU_TEXTUREFORMAT_D24_UNORM;
+    }
+
+    // Levels down to 1x1, the same amount glGenerateMipmap creates.
+    uint32 GetMipCount(const uint32 width, const uint32 height) { return static_cast<uint32>(std::bit_width(std::max(width, height))); }
+
+    // The swapchain format is only known once the window is claimed, so the description is built from the actual target.
+    PipelineCache::Description DescribePipeline(
+        const GraphicsShaderPipeline& pipeline, const PipelineState& state, const RenderTarget& target
+    )
+    {
+        PipelineCache::Description description{
+            .vertex_shader = static_cast<SDL_GPUShader*>(pipeline.GetVertexShader()->shader.pointer),
+            .fragment_shader = static_cast<SDL_GPUShader*>(pipeline.GetFragmentShader()->shader.pointer),
+            .state = state
+        };
+
+        if (target.render_buffers.empty())
+        {
+            auto* window = static_cast<SDL_Window*>(Window::GetHandle());
+            description.color_formats[0] = SDL_GetGPUSwapchainTextureFormat(device, window);
+            description.color_target_count = 1;
+        }
+        else
+        {
+            for (const RenderBuffer& render_buffer : target.render_buffers)
+            {
+                if (description.color_target_count == PipelineCache::MAX_COLOR_TARGETS) break;
+
+                // Render buffers are always color textures, even when their texture isn't created yet.
+                const Handle<Texture> texture = render_buffer.GetTexture();
+                const Texture::ColorFormat format = texture != nullptr ? texture->GetFormat() : Texture::COLOR_RGBA_32;
+                description.color_formats[description.color_target_count++] = ToTextureFormat(format);
+            }
+        }
+
+        const Handle<Texture> depth_texture = target.depth_buffer.GetTexture();
+        if (depth_texture != nullptr) description.depth_format = ToTextureFormat(depth_texture->GetFormat());
+
+        return description;
     }
 
     SDL_GPUTextureUsageFlags ToUsageFlags(const uint32 in_flags)
@@ -102,6 +1161,118 @@ namespace
 
         return out_flags;
     }
+
+    SDL_GPUBufferUsageFlags ToBufferUsageFlags(const uint32 in_flags)
+    {
+        SDL_GPUBufferUsageFlags out_flags = 0;
+
+        if (in_flags & StorageBuffer::COMPUTE_READ) out_flags |= SDL_GPU_BUFFERUSAGE_COMPUTE_STORAGE_READ;
+        if (in_flags & StorageBuffer::COMPUTE_WRITE) out_flags |= SDL_GPU_BUFFERUSAGE_COMPUTE_STORAGE_WRITE;
+        if (in_flags & StorageBuffer::GRAPHICS_READ) out_flags |= SDL_GPU_BUFFERUSAGE_GRAPHICS_STORAGE_READ;
+        if (in_flags & StorageBuffer::INDIRECT) out_flags |= SDL_GPU_BUFFERUSAGE_INDIRECT;
+        if (in_flags & StorageBuffer::VERTEX) out_flags |= SDL_GPU_BUFFERUSAGE_VERTEX;
+
+        return out_flags;
+    }
+
+    SDL_GPUPresentMode ToPresentMode(const Renderer::PresentMode mode)
+    {
+        switch (mode)
+        {
+        case Renderer::PresentMode::MAILBOX: return SDL_GPU_PRESENTMODE_MAILBOX;
+        case Renderer::PresentMode::IMMEDIATE: return SDL_GPU_PRESENTMODE_IMMEDIATE;
+        case Renderer::PresentMode::VSYNC:
+        default: return SDL_GPU_PRESENTMODE_VSYNC;
+        }
+    }
+
+    Renderer::PresentMode applied_present_mode = Renderer::PresentMode::VSYNC;
+
+    // Every swapchain supports VSYNC, the other modes depend on the driver and the window system.
+    void ApplyPresentMode(const Renderer::PresentMode mode)
+    {
+        auto* window = static_cast<SDL_Window*>(Window::GetHandle());
+
+        SDL_GPUPresentMode present_mode = ToPresentMode(mode);
+        if (!SDL_WindowSupportsGPUPresentMode(device, window, present_mode))
+        {
+            Log::Log("Present mode {} isn't supported by the window, using VSYNC", static_cast<uint32>(mode));
+            present_mode = SDL_GPU_PRESENTMODE_VSYNC;
+        }
+
+        if (!SDL_SetGPUSwapchainParameters(device, window, SDL_GPU_SWAPCHAINCOMPOSITION_SDR, present_mode))
+        {
+            Log::Error("Failed to set the present mode: {}", SDL_GetError());
+        }
+        applied_present_mode = mode;
+    }
+
+    // Time WaitForSwapchain() blocked before the frame started, added to the statistics of the frame once they are reset.
+    float swapchain_wait_before_frame = 0.0f;
+
+    float GetMillisecondsSince(const uint64 start) { return static_cast<float>(SDL_GetTicksNS() - start) / 1e6f; }
+
+    // Picks the first shader format the device supports, along with the name the entry point has in that format.
+    bool GetShaderFormat(SDL_GPUShaderFormat& format, const char*& entrypoint)
+    {
+        const SDL_GPUShaderFormat backend_formats = SDL_GetGPUShaderFormats(device);
+
+        if (backend_formats & SDL_GPU_SHADERFORMAT_SPIRV)
+        {
+            format = SDL_GPU_SHADERFORMAT_SPIRV;
+            entrypoint = "main";
+        }
+        else if (backend_formats & SDL_GPU_SHADERFORMAT_MSL)
+        {
+            format = SDL_GPU_SHADERFORMAT_MSL;
+            entrypoint = "main0";
+        }
+        else if (backend_formats & SDL_GPU_SHADERFORMAT_DXIL)
+        {
+            format = SDL_GPU_SHADERFORMAT_DXIL;
+            entrypoint = "main";
+        }
+        else
+        {
+            Log::Error("Unrecognized backend shader format!");
+            return false;
+        }
+
+        return true;
+    }
+
+    // Read-write buffers are bound when the compute pass begins, the read-only ones are bound to the pass afterwards.
+    SDL_GPUComputePass* BeginComputePass(
+        const ComputeShaderPipeline& pipeline, const std::span<const StorageBinding> bindings, uint32& state_changes
+    )
+    {
+        std::vector<SDL_GPUStorageBufferReadWriteBinding> read_write_buffers;
+        std::vector<SDL_GPUBuffer*> read_only_buffers;
+        for (const auto& [buffer, read_write] : bindings)
+        {
+            auto* gpu_buffer = static_cast<SDL_GPUBuffer*>(buffer->buffer.pointer);
+            if (read_write) read_write_buffers.push_back(SDL_GPUStorageBufferReadWriteBinding{.buffer = gpu_buffer, .cycle = false});
+            else read_only_buffers.push_back(gpu_buffer);
+        }
+
+        SDL_GPUComputePass* compute_pass = SDL_BeginGPUComputePass(
+            render_command_buffer, nullptr, 0, read_write_buffers.data(), static_cast<uint32>(read_write_buffers.size())
+        );
+        if (compute_pass == nullptr)
+        {
+            Log::Error("Failed to begin compute pass: {}", SDL_GetError());
+            return nullptr;
+        }
+
+        SDL_BindGPUComputePipeline(compute_pass, static_cast<SDL_GPUComputePipeline*>(pipeline.compute_pipeline.pointer));
+        if (!read_only_buffers.empty())
+        {
+            SDL_BindGPUComputeStorageBuffers(compute_pass, 0, read_only_buffers.data(), static_cast<uint32>(read_only_buffers.size()));
+        }
+
+        state_changes++;
+        return compute_pass;
+    }
 } // namespace
 
 SDL3GPURenderer::SDL3GPURenderer() : Renderer{}
@@ -110,7 +1281,8 @@ SDL3GPURenderer::SDL3GPURenderer() : Renderer{}
         .file_extension = ".spv",
         .binary = true,
         .profile = "spirv_1_3",
-        .invert_y = false
+        .invert_y = false,
+        .compute_profile = "spirv_1_3"
     };
 }
 
@@ -132,8 +1304,12 @@ void SDL3GPURenderer::InitBackend()
         return;
     }
 
-    // SDL_GPU_PRESENTMODE_MAILBOX is a non-tearing alternative to SDL_GPU_PRESENTMODE_IMMIDATE, but we want to limit FPS so we choose SDL_GPU_PRESENTMODE_VSYNC.
-    SDL_SetGPUSwapchainParameters(device, window, SDL_GPU_SWAPCHAINCOMPOSITION_SDR, SDL_GPU_PRESENTMODE_VSYNC);
+    ApplyPresentMode(present_mode);
+    SDL_SetGPUAllowedFramesInFlight(device, FRAMES_IN_FLIGHT);
+
+    geometry_allocator.Reset();
+    ReserveGeometry(GeometryAllocator::INITIAL_VERTEX_CAPACITY, GeometryAllocator::INITIAL_INDEX_CAPACITY);
+    CreateFallbackTexture();
 
     Resource::Load<GraphicsShaderPipeline>(
         "Assets/Shaders/TestShader.slang", ShaderSettings{Shader::VERTEX, 0, 0, 3}, ShaderSettings{Shader::FRAGMENT, 1, 0, 0}
@@ -144,58 +1320,221 @@ void SDL3GPURenderer::ExitBackend()
 {
     auto* window = static_cast<SDL_Window*>(Window::GetHandle());
 
+    SDL_WaitForGPUIdle(device);
+    pipeline_cache.Destroy();
+    sampler_cache.Destroy();
+    for (FrameData& frame : frames)
+    {
+        if (frame.fence != nullptr) SDL_ReleaseGPUFence(device, frame.fence);
+        frame.fence = nullptr;
+        frame.deletions.Flush(geometry_allocator);
+    }
+    render_texture_pool.Destroy();
+
+    SDL_ReleaseGPUTexture(device, fallback_texture);
+    fallback_texture = nullptr;
+
+    upload_ring.Destroy();
+
+    ReleaseGeometryBuffers(geometry_vertex_buffer, geometry_position_buffer, geometry_index_buffer);
+    geometry_vertex_buffer = nullptr;
+    geometry_position_buffer = nullptr;
+    geometry_index_buffer = nullptr;
+
     SDL_ReleaseWindowFromGPUDevice(device, window);
     SDL_DestroyGPUDevice(device);
 }
 
 void SDL3GPURenderer::Update()
 {
+    if (present_mode != applied_present_mode) ApplyPresentMode(present_mode);
+
+    statistics.swapchain_wait_milliseconds = swapchain_wait_before_frame;
+    swapchain_wait_before_frame = 0.0f;
+
+    // The slot of the frame is reused once the GPU finished the frame that used it before, only then its objects can be released.
+    frame_index = (frame_index + 1) % FRAMES_IN_FLIGHT;
+    FrameData& frame = frames[frame_index];
+    if (frame.fence != nullptr)
+    {
+        SDL_WaitForGPUFences(device, true, &frame.fence, 1);
+        SDL_ReleaseGPUFence(device, frame.fence);
+        frame.fence = nullptr;
+    }
+    frame.deletions.Flush(geometry_allocator);
+    upload_ring.ReleaseFrame(frame_index);
+    render_texture_pool.Update();
+
+    statistics.uploaded_bytes = upload_scheduler.Schedule(upload_budget);
+    statistics.pending_uploads = upload_scheduler.GetPendingCount();
+    statistics.pending_upload_bytes = upload_scheduler.GetPendingBytes();
     DataUploadPass();
 
     render_command_buffer = SDL_AcquireGPUCommandBuffer(device);
-    if (render_command_buffer == nullptr) { Log::Error("Failed to acquire render command buffer: {}", SDL_GetError()); }
+    if (render_command_buffer == nullptr)
+    {
+        Log::Error("Failed to acquire render command buffer: {}", SDL_GetError());
+        return;
+    }
+
+    // Submitted after the upload pass, so the base levels are complete before the mipmaps are generated from them.
+    upload_scheduler.GenerateMipmaps(render_command_buffer);
 }
 
 void SDL3GPURenderer::SwapBuffer()
 {
-    if (!SDL_SubmitGPUCommandBuffer(render_command_buffer)) { Log::Error("Failed to submit render command buffer: {}", SDL_GetError()); }
+    if (render_command_buffer == nullptr) return;
+
+    // Doesn't wait for the GPU, the next frame only waits when it reuses the slot of a frame that is still in flight.
+    frames[frame_index].fence = SDL_SubmitGPUCommandBufferAndAcquireFence(render_command_buffer);
+    if (frames[frame_index].fence == nullptr) { Log::Error("Failed to submit render command buffer: {}", SDL_GetError()); }
     render_command_buffer = nullptr;
 }
 
+void SDL3GPURenderer::WaitForSwapchain()
+{
+    if (!late_swapchain_acquire || device == nullptr) return;
+
+    // Afterwards acquiring the swapchain texture in the first pass drawing to the window returns right away.
+    const uint64 start = SDL_GetTicksNS();
+    auto* window = static_cast<SDL_Window*>(Window::GetHandle());
+    if (!SDL_WaitForGPUSwapchain(device, window)) Log::Error("Failed to wait for the swapchain: {}", SDL_GetError());
+
+    swapchain_wait_before_frame += GetMillisecondsSince(start);
+}
+
 void* SDL3GPURenderer::GetContext() { return device; }
 
 void SDL3GPURenderer::RenderMesh(const Mesh& mesh)
 {
-    const SDL_GPUBufferBinding vertex_binding{.buffer = static_cast<SDL_GPUBuffer*>(mesh.vertices_buffer.pointer)};
-    SDL_BindGPUVertexBuffers(active_render_pass, 0, &vertex_binding, 1);
+    if (!GeometryAllocator::IsAllocated(mesh)) return;
+    if (!mesh.resident)
+    {
+        upload_scheduler.Promote(&mesh);
+        return;
+    }
+
+    // All meshes share the buffers, they only need to be bound once per render pass.
+    if (geometry_bound) { statistics.skipped_state_changes++; }
+    else
+    {
+        // Passes with the position layout read the positions on their own instead of the interleaved vertices.
+        const bool positions = active_pass != nullptr && active_pass->pipeline_state.vertex_layout == PipelineState::VertexLayout::POSITION;
+        const SDL_GPUBufferBinding vertex_binding{.buffer = positions ? geometry_position_buffer : geometry_vertex_buffer};
+        SDL_BindGPUVertexBuffers(active_render_pass, 0, &vertex_binding, 1);
+
+        const SDL_GPUBufferBinding index_binding{.buffer = geometry_index_buffer};
+        SDL_BindGPUIndexBuffer(active_render_pass, &index_binding, SDL_GPU_INDEXELEMENTSIZE_32BIT);
+
+        geometry_bound = true;
+        statistics.state_changes++;
+    }
+
+    SDL_DrawGPUIndexedPrimitives(active_render_pass, mesh.GetIndicesCount(), 1, mesh.first_index, mesh.base_vertex, 0);
+    statistics.draw_calls++;
+}
+
+bool SDL3GPURenderer::RenderMeshesIndirectBuffer(
+    const GraphicsShaderPipeline& pipeline, const StorageBuffer& arguments, const uint32 offset, const uint32 draw_count,
+    const StorageBuffer& instances
+)
+{
+    if (active_render_pass == nullptr || active_pass == nullptr || draw_count == 0) return false;
+    if (arguments.buffer.pointer == nullptr || instances.buffer.pointer == nullptr) return false;
+
+    // Same state and target as the pass, only the vertex layout differs.
+    PipelineState state = active_pass->pipeline_state;
+    state.vertex_layout = PipelineState::VertexLayout::MESH_INSTANCED_MODEL;
+
+    bool stalled = false;
+    SDL_GPUGraphicsPipeline* indirect_pipeline = pipeline_cache.Get(DescribePipeline(pipeline, state, *active_pass->GetTarget()), stalled);
+    if (stalled) statistics.pipeline_stalls++;
+    if (indirect_pipeline == nullptr) return false;
+
+    SDL_BindGPUGraphicsPipeline(active_render_pass, indirect_pipeline);
 
-    const SDL_GPUBufferBinding index_binding{.buffer = static_cast<SDL_GPUBuffer*>(mesh.indices_buffer.pointer)};
+    const SDL_GPUBufferBinding vertex_bindings[2]{
+        {.buffer = geometry_vertex_buffer}, {.buffer = static_cast<SDL_GPUBuffer*>(instances.buffer.pointer)}
+    };
+    SDL_BindGPUVertexBuffers(active_render_pass, 0, vertex_bindings, 2);
+
+    const SDL_GPUBufferBinding index_binding{.buffer = geometry_index_buffer};
     SDL_BindGPUIndexBuffer(active_render_pass, &index_binding, SDL_GPU_INDEXELEMENTSIZE_32BIT);
+    // The interleaved vertices are bound now, passes with the position layout bind their buffer again for the next draw.
+    geometry_bound = active_pass->pipeline_state.vertex_layout != PipelineState::VertexLayout::POSITION;
+    statistics.state_changes++;
+
+    SDL_DrawGPUIndexedPrimitivesIndirect(active_render_pass, static_cast<SDL_GPUBuffer*>(arguments.buffer.pointer), offset, draw_count);
+    statistics.draw_calls++;
+
+    if (active_pipeline != nullptr) SDL_BindGPUGraphicsPipeline(active_render_pass, active_pipeline);
+    return true;
+}
 
-    SDL_DrawGPUIndexedPrimitives(active_render_pass, mesh.GetIndicesCount(), 1, 0, 0, 0);
+void SDL3GPURenderer::DefragmentGeometry()
+{
+    if (geometry_vertex_buffer != nullptr) DefragmentGeometryBuffers(geometry_allocator);
 }
 
 void SDL3GPURenderer::SetTextureSampler(const uint32 slot, const Texture& texture)
 {
-    const SDL_GPUTextureSamplerBinding binding{
-        .texture = static_cast<SDL_GPUTexture*>(texture.texture.pointer), .sampler = static_cast<SDL_GPUSampler*>(texture.sampler.pointer)
-    };
+    // Textures whose rows are still queued would be sampled half uploaded and without mipmaps, the fallback is drawn meanwhile.
+    auto* gpu_texture = static_cast<SDL_GPUTexture*>(texture.texture.pointer);
+    if (upload_scheduler.IsPending(gpu_texture))
+    {
+        upload_scheduler.Promote(gpu_texture);
+        gpu_texture = fallback_texture;
+    }
+
+    const SDL_GPUTextureSamplerBinding binding{.texture = gpu_texture, .sampler = static_cast<SDL_GPUSampler*>(texture.sampler.pointer)};
 
     SDL_BindGPUFragmentSamplers(active_render_pass, slot, &binding, 1);
 }
 
-void SDL3GPURenderer::SetUniform(const uint32 slot, const void* data, const usize size)
+void SDL3GPURenderer::Dispatch(
+    const ComputeShaderPipeline& pipeline, const std::span<const StorageBinding> bindings, const uint32 group_count_x,
+    const uint32 group_count_y, const uint32 group_count_z
+)
 {
-    SDL_PushGPUVertexUniformData(render_command_buffer, slot, data, static_cast<uint32>(size));
-    SDL_PushGPUFragmentUniformData(render_command_buffer, slot, data, static_cast<uint32>(size));
-    SDL_PushGPUComputeUniformData(render_command_buffer, slot, data, static_cast<uint32>(size));
+    if (render_command_buffer == nullptr || pipeline.compute_pipeline.pointer == nullptr) return;
+
+    SDL_GPUComputePass* compute_pass = BeginComputePass(pipeline, bindings, statistics.state_changes);
+    if (compute_pass == nullptr) return;
+
+    SDL_DispatchGPUCompute(compute_pass, group_count_x, group_count_y, group_count_z);
+    SDL_EndGPUComputePass(compute_pass);
+    statistics.dispatches++;
+}
+
+void SDL3GPURenderer::DispatchIndirect(
+    const ComputeShaderPipeline& pipeline, const std::span<const StorageBinding> bindings, const StorageBuffer& arguments,
+    const uint32 offset
+)
+{
+    if (render_command_buffer == nullptr || pipeline.compute_pipeline.pointer == nullptr) return;
+
+    SDL_GPUComputePass* compute_pass = BeginComputePass(pipeline, bindings, statistics.state_changes);
+    if (compute_pass == nullptr) return;
+
+    SDL_DispatchGPUComputeIndirect(compute_pass, static_cast<SDL_GPUBuffer*>(arguments.buffer.pointer), offset);
+    SDL_EndGPUComputePass(compute_pass);
+    statistics.dispatches++;
+}
+
+void SDL3GPURenderer::PushUniform(const uint32 slot, const void* data, const usize size, const ShaderStages stages)
+{
+    const auto data_size = static_cast<uint32>(size);
+
+    if (stages & VERTEX_STAGE) SDL_PushGPUVertexUniformData(render_command_buffer, slot, data, data_size);
+    if (stages & FRAGMENT_STAGE) SDL_PushGPUFragmentUniformData(render_command_buffer, slot, data, data_size);
+    if (stages & COMPUTE_STAGE) SDL_PushGPUComputeUniformData(render_command_buffer, slot, data, data_size);
 }
 
 SDL_GPUCommandBuffer* SDL3GPURenderer::GetCommandBuffer() { return render_command_buffer; }
 
 void SDL3GPURenderer::BeginRenderPass(const RenderPassInterface& render_pass)
 {
-    Handle<RenderTarget> render_target = render_pass.render_target;
+    const Handle<RenderTarget>& render_target = render_pass.GetTarget();
     std::vector<SDL_GPUColorTargetInfo> color_target_infos;
 
     if (render_target->render_buffers.empty())
@@ -203,11 +1542,13 @@ void SDL3GPURenderer::BeginRenderPass(const RenderPassInterface& render_pass)
         auto* window = static_cast<SDL_Window*>(Window::GetHandle());
 
         SDL_GPUTexture* swapchain_texture = nullptr;
+        const uint64 acquire_start = SDL_GetTicksNS();
         if (!SDL_WaitAndAcquireGPUSwapchainTexture(render_command_buffer, window, &swapchain_texture, nullptr, nullptr))
         {
             Log::Error("Failed to acquire swapchain texture: {}", SDL_GetError());
             return;
         }
+        statistics.swapchain_wait_milliseconds += GetMillisecondsSince(acquire_start);
 
         const SDL_GPUColorTargetInfo color_target_info{
             .texture = swapchain_texture,
@@ -230,15 +1571,16 @@ void SDL3GPURenderer::BeginRenderPass(const RenderPassInterface& render_pass)
                 .texture = static_cast<SDL_GPUTexture*>(render_buffer.GetTexture()->texture.pointer),
                 .layer_or_depth_plane = 0,
                 .clear_color = SDL_FColor{clear_color.x(), clear_color.y(), clear_color.z(), clear_color.w()},
-                .load_op = (render_pass.clear_render_targets ? SDL_GPU_LOADOP_CLEAR : SDL_GPU_LOADOP_LOAD),
-                .store_op = SDL_GPU_STOREOP_STORE
+                .load_op = static_cast<SDL_GPULoadOp>(render_buffer.load_op),
+                .store_op = static_cast<SDL_GPUStoreOp>(render_buffer.store_op)
             };
 
             color_target_infos.push_back(color_target_info);
         }
     }
 
-    const Handle<Texture> depth_texture = render_target->depth_buffer.GetTexture();
+    const RenderBuffer& depth_buffer = render_target->depth_buffer;
+    const Handle<Texture> depth_texture = depth_buffer.GetTexture();
     SDL_GPUDepthStencilTargetInfo* depth_stencil_target_info = nullptr;
 
     if (depth_texture != nullptr)
@@ -247,19 +1589,47 @@ void SDL3GPURenderer::BeginRenderPass(const RenderPassInterface& render_pass)
 
             .texture = static_cast<SDL_GPUTexture*>(depth_texture->texture.pointer),
             .clear_depth = 1.0f,
-            .load_op = (render_pass.clear_render_targets ? SDL_GPU_LOADOP_CLEAR : SDL_GPU_LOADOP_LOAD),
-            .store_op = SDL_GPU_STOREOP_STORE,
+            .load_op = static_cast<SDL_GPULoadOp>(depth_buffer.load_op),
+            .store_op = static_cast<SDL_GPUStoreOp>(depth_buffer.store_op),
         };
     }
 
+    geometry_bound = false;
     active_render_pass = SDL_BeginGPURenderPass(
         render_command_buffer, color_target_infos.data(), static_cast<uint32>(color_target_infos.size()), depth_stencil_target_info
     );
     delete depth_stencil_target_info;
 
-    SDL_BindGPUGraphicsPipeline(
-        active_render_pass, static_cast<SDL_GPUGraphicsPipeline*>(render_pass.graphics_pipeline->shader_pipeline.pointer)
-    );
+    // Targets with headroom are only rendered to in their top left, the viewport of a new pass covers the whole target.
+    if (active_render_pass != nullptr && (render_target->GetWidth() != render_target->GetAllocatedWidth() ||
+                                          render_target->GetHeight() != render_target->GetAllocatedHeight()))
+    {
+        const SDL_GPUViewport viewport{
+            .x = 0.0f,
+            .y = 0.0f,
+            .w = static_cast<float>(render_target->GetWidth()),
+            .h = static_cast<float>(render_target->GetHeight()),
+            .min_depth = 0.0f,
+            .max_depth = 1.0f
+        };
+        SDL_SetGPUViewport(active_render_pass, &viewport);
+    }
+
+    bool stalled = false;
+    SDL_GPUGraphicsPipeline* pipeline =
+        pipeline_cache.Get(DescribePipeline(*render_pass.graphics_pipeline, render_pass.pipeline_state, *render_target), stalled);
+    if (stalled) statistics.pipeline_stalls++;
+
+    if (pipeline != nullptr) SDL_BindGPUGraphicsPipeline(active_render_pass, pipeline);
+    active_pass = &render_pass;
+    active_pipeline = pipeline;
+}
+
+void SDL3GPURenderer::PrewarmPipeline(const RenderPassInterface& render_pass)
+{
+    if (render_pass.graphics_pipeline == nullptr || render_pass.render_target == nullptr) return;
+
+    pipeline_cache.Prewarm(DescribePipeline(*render_pass.graphics_pipeline, render_pass.pipeline_state, *render_pass.render_target));
 }
 
 void SDL3GPURenderer::EndRenderPass()
@@ -269,6 +1639,9 @@ void SDL3GPURenderer::EndRenderPass()
         SDL_EndGPURenderPass(active_render_pass);
         active_render_pass = nullptr;
     }
+
+    active_pass = nullptr;
+    active_pipeline = nullptr;
 }
 
 void SDL3GPURenderer::CreateTexture(Texture& texture, const uint8* data, const SamplerSettings& sampler_settings)
@@ -276,16 +1649,24 @@ void SDL3GPURenderer::CreateTexture(Texture& texture, const uint8* data, const S
     const uint32 width = texture.GetWidth();
     const uint32 height = texture.GetHeight();
 
-    const SDL_GPUTextureFormat format =
-        texture.GetFormat() == Texture::COLOR_RGBA_32 ? SDL_GPU_TEXTUREFORMAT_R8G8B8A8_UNORM : SDL_GPU_TEXTUREFORMAT_D24_UNORM;
+    // Sampled color textures get a full mip chain, render targets are only ever sampled at their own size.
+    const uint32 flags = texture.GetFlags();
+    const bool generate_mipmaps = data != nullptr && texture.GetFormat() == Texture::COLOR_RGBA_32 && (flags & Texture::SAMPLER) != 0 &&
+                                  (flags & (Texture::COLOR_TARGET | Texture::DEPTH_TARGET)) == 0;
+
+    // Mipmaps are generated with blits, which need the texture to be usable as a color target.
+    SDL_GPUTextureUsageFlags usage = ToUsageFlags(flags);
+    if (generate_mipmaps) usage |= SDL_GPU_TEXTUREUSAGE_COLOR_TARGET;
+
+    const SDL_GPUTextureFormat format = ToTextureFormat(texture.GetFormat());
     const SDL_GPUTextureCreateInfo texture_create_info{
         .type = SDL_GPU_TEXTURETYPE_2D,
         .format = format,
-        .usage = ToUsageFlags(texture.GetFlags()),
+        .usage = usage,
         .width = width,
         .height = height,
         .layer_count_or_depth = 1,
-        .num_levels = 1,
+        .num_levels = generate_mipmaps ? GetMipCount(width, height) : 1,
     };
 
     texture.texture.pointer = SDL_CreateGPUTexture(device, &texture_create_info);
@@ -295,41 +1676,20 @@ void SDL3GPURenderer::CreateTexture(Texture& texture, const uint8* data, const S
         return;
     }
 
-    const SDL_GPUSamplerCreateInfo sampler_info{
-        .min_filter = static_cast<SDL_GPUFilter>(sampler_settings.down_filter),
-        .mag_filter = static_cast<SDL_GPUFilter>(sampler_settings.up_filter),
-        .mipmap_mode = static_cast<SDL_GPUSamplerMipmapMode>(sampler_settings.mipmap_mode),
-        .address_mode_u = static_cast<SDL_GPUSamplerAddressMode>(sampler_settings.wrap_mode_u),
-        .address_mode_v = static_cast<SDL_GPUSamplerAddressMode>(sampler_settings.wrap_mode_v),
-        .address_mode_w = SDL_GPU_SAMPLERADDRESSMODE_CLAMP_TO_EDGE
-    };
-
-    texture.sampler.pointer = SDL_CreateGPUSampler(device, &sampler_info);
-    if (texture.sampler.pointer == nullptr) Log::Error("Error creating the texture sampler");
+    texture.sampler.pointer = sampler_cache.Get(sampler_settings);
 
     // If there is no data to upload, we return.
     if (data == nullptr) return;
 
     const uint32 data_size = SDL_CalculateGPUTextureFormatSize(format, width, height, 1);
-    SDL_GPUTransferBuffer* texture_transfer_buffer = CreateUploadTransferBuffer(data, data_size);
-
-    auto& [texture_transfer_info, texture_destination] = texture_copies.emplace_back();
-
-    texture_transfer_info.transfer_buffer = texture_transfer_buffer;
-    texture_transfer_info.offset = 0;
-    texture_transfer_info.pixels_per_row = width;
-    texture_transfer_info.rows_per_layer = height;
-
-    texture_destination.texture = static_cast<SDL_GPUTexture*>(texture.texture.pointer);
-    texture_destination.w = width;
-    texture_destination.h = height;
-    texture_destination.d = 1;
+    upload_scheduler.QueueTexture(
+        static_cast<SDL_GPUTexture*>(texture.texture.pointer), width, height, data, data_size, generate_mipmaps, upload_priority
+    );
 }
 
 void SDL3GPURenderer::ResizeTexture(Texture& texture, const sint32 new_width, const sint32 new_height)
 {
-    const SDL_GPUTextureFormat format =
-        texture.GetFormat() == Texture::COLOR_RGBA_32 ? SDL_GPU_TEXTUREFORMAT_R8G8B8A8_UNORM : SDL_GPU_TEXTUREFORMAT_D24_UNORM;
+    const SDL_GPUTextureFormat format = ToTextureFormat(texture.GetFormat());
     const SDL_GPUTextureCreateInfo texture_create_info{
         .type = SDL_GPU_TEXTURETYPE_2D,
         .format = format,
@@ -340,7 +1700,11 @@ void SDL3GPURenderer::ResizeTexture(Texture& texture, const sint32 new_width, co
         .num_levels = 1,
     };
 
-    SDL_GPUTexture* new_texture = SDL_CreateGPUTexture(device, &texture_create_info);
+    // Render targets are drawn again before they are read, they don't need their contents and can use pooled textures.
+    const bool render_target = (texture.GetFlags() & (Texture::COLOR_TARGET | Texture::DEPTH_TARGET)) != 0;
+
+    SDL_GPUTexture* new_texture = render_target ? render_texture_pool.Acquire(texture_create_info) : nullptr;
+    if (new_texture == nullptr) new_texture = SDL_CreateGPUTexture(device, &texture_create_info);
     if (new_texture == nullptr)
     {
         Log::Error("Failed to recreate GPU texture: {}", SDL_GetError());
@@ -348,10 +1712,24 @@ void SDL3GPURenderer::ResizeTexture(Texture& texture, const sint32 new_width, co
     }
 
     SDL_GPUTexture* texture_pointer = static_cast<SDL_GPUTexture*>(texture.texture.pointer);
-    if (texture_pointer != nullptr)
+    if (texture_pointer != nullptr && render_target)
+    {
+        GetDeletionQueue().pooled_textures.push_back(RenderTexturePool::Entry{
+            .texture = texture_pointer,
+            .format = format,
+            .usage = texture_create_info.usage,
+            .width = static_cast<uint32>(texture.GetWidth()),
+            .height = static_cast<uint32>(texture.GetHeight())
+        });
+    }
+    else if (texture_pointer != nullptr)
     {
         if (static_cast<uint32>(texture.GetFlags()) & Texture::COLOR_RGBA_32)
         {
+            // The rows that are still queued are sent first, so the new texture is blitted from the complete contents.
+            upload_scheduler.Flush(texture_pointer);
+            DataUploadPass();
+
             const SDL_GPUBlitRegion source_region{
                 .texture = texture_pointer,
                 .mip_level = 0,
@@ -382,7 +1760,8 @@ void SDL3GPURenderer::ResizeTexture(Texture& texture, const sint32 new_width, co
             SDL_SubmitGPUCommandBuffer(blit_command_buffer);
         }
 
-        SDL_ReleaseGPUTexture(device, texture_pointer);
+        upload_scheduler.Cancel(texture_pointer);
+        GetDeletionQueue().textures.push_back(texture_pointer);
     }
 
     texture.texture.pointer = new_texture;
@@ -390,83 +1769,48 @@ void SDL3GPURenderer::ResizeTexture(Texture& texture, const sint32 new_width, co
 
 void SDL3GPURenderer::DestroyTexture(Texture& texture)
 {
-    SDL_ReleaseGPUTexture(device, static_cast<SDL_GPUTexture*>(texture.texture.pointer));
-    SDL_ReleaseGPUSampler(device, static_cast<SDL_GPUSampler*>(texture.sampler.pointer));
+    upload_scheduler.Cancel(texture.texture.pointer);
+    GetDeletionQueue().textures.push_back(static_cast<SDL_GPUTexture*>(texture.texture.pointer));
 }
 
 void SDL3GPURenderer::CreateMesh(Mesh& mesh, const std::vector<Vertex>& vertices, const std::vector<uint32>& indices)
 {
-    const auto vertices_size = static_cast<uint32>(vertices.size() * sizeof(Vertex));
-    const auto indices_size = static_cast<uint32>(indices.size() * sizeof(uint32));
-
-    SDL_GPUBufferCreateInfo buffer_info{};
+    if (geometry_vertex_buffer == nullptr) return;
 
-    buffer_info.usage = SDL_GPU_BUFFERUSAGE_VERTEX;
-    buffer_info.size = vertices_size;
-    mesh.vertices_buffer.pointer = SDL_CreateGPUBuffer(device, &buffer_info);
-    if (mesh.vertices_buffer.pointer == nullptr)
+    if (!geometry_allocator.Allocate(mesh))
     {
-        Log::Error("Failed to create vertex buffer");
-        return;
-    }
+        // Packing the existing meshes is cheaper than growing when there is enough free space in total.
+        if (geometry_allocator.FitsAfterDefragment(mesh)) { DefragmentGeometryBuffers(geometry_allocator); }
+        else
+        {
+            const auto [vertex_capacity, index_capacity] = geometry_allocator.GetGrownCapacities(mesh);
+            ReserveGeometry(vertex_capacity, index_capacity);
+            if (geometry_vertex_capacity == vertex_capacity) geometry_allocator.Grow(vertex_capacity, index_capacity);
+        }
 
-    buffer_info.usage = SDL_GPU_BUFFERUSAGE_INDEX;
-    buffer_info.size = indices_size;
-    mesh.indices_buffer.pointer = SDL_CreateGPUBuffer(device, &buffer_info);
-    if (mesh.indices_buffer.pointer == nullptr)
-    {
-        Log::Error("Failed to create index buffer");
-        return;
+        if (!geometry_allocator.Allocate(mesh))
+        {
+            Log::Error("Failed to allocate {} vertices and {} indices", mesh.GetVerticesCount(), mesh.GetIndicesCount());
+            return;
+        }
     }
 
-    SDL_GPUTransferBuffer* vertex_transfer_buffer = CreateUploadTransferBuffer(vertices.data(), vertices_size);
-    SDL_GPUTransferBuffer* index_transfer_buffer = CreateUploadTransferBuffer(indices.data(), indices_size);
-
-    auto& [vertices_buffer_location, vertices_buffer_region] = buffer_copies.emplace_back();
-    vertices_buffer_location.transfer_buffer = vertex_transfer_buffer;
-    vertices_buffer_region.buffer = static_cast<SDL_GPUBuffer*>(mesh.vertices_buffer.pointer);
-    vertices_buffer_region.size = vertices_size;
-
-    auto& [indices_buffer_location, indices_buffer_region] = buffer_copies.emplace_back();
-    indices_buffer_location.transfer_buffer = index_transfer_buffer;
-    indices_buffer_region.buffer = static_cast<SDL_GPUBuffer*>(mesh.indices_buffer.pointer);
-    indices_buffer_region.size = indices_size;
+    upload_scheduler.QueueMesh(mesh, vertices, indices, upload_priority);
 }
 
 void SDL3GPURenderer::DestroyMesh(Mesh& mesh)
 {
-    SDL_ReleaseGPUBuffer(device, static_cast<SDL_GPUBuffer*>(mesh.vertices_buffer.pointer));
-    SDL_ReleaseGPUBuffer(device, static_cast<SDL_GPUBuffer*>(mesh.indices_buffer.pointer));
+    upload_scheduler.Cancel(&mesh);
+    GetDeletionQueue().geometry_ranges.push_back(geometry_allocator.Detach(mesh));
 }
 
 void SDL3GPURenderer::CreateShader(Shader& shader, const void* data, usize size)
 {
     const auto stage = static_cast<SDL_GPUShaderStage>(shader.type);
 
-    const SDL_GPUShaderFormat backendFormats = SDL_GetGPUShaderFormats(device);
     SDL_GPUShaderFormat format;
     const char* entrypoint;
-
-    if (backendFormats & SDL_GPU_SHADERFORMAT_SPIRV)
-    {
-        format = SDL_GPU_SHADERFORMAT_SPIRV;
-        entrypoint = "main";
-    }
-    else if (backendFormats & SDL_GPU_SHADERFORMAT_MSL)
-    {
-        format = SDL_GPU_SHADERFORMAT_MSL;
-        entrypoint = "main0";
-    }
-    else if (backendFormats & SDL_GPU_SHADERFORMAT_DXIL)
-    {
-        format = SDL_GPU_SHADERFORMAT_DXIL;
-        entrypoint = "main";
-    }
-    else
-    {
-        Log::Error("Unrecognized backend shader format!");
-        return;
-    }
+    if (!GetShaderFormat(format, entrypoint)) return;
 
     const SDL_GPUShaderCreateInfo shaderInfo{
         .code_size = size,
@@ -483,80 +1827,94 @@ void SDL3GPURenderer::CreateShader(Shader& shader, const void* data, usize size)
     if (shader.shader.pointer == nullptr) Log::Error("Failed to create shader: {}", SDL_GetError());
 }
 
-void SDL3GPURenderer::DestroyShader(Shader& shader) { SDL_ReleaseGPUShader(device, static_cast<SDL_GPUShader*>(shader.shader.pointer)); }
+void SDL3GPURenderer::DestroyShader(Shader& shader)
+{
+    auto* gpu_shader = static_cast<SDL_GPUShader*>(shader.shader.pointer);
 
-void SDL3GPURenderer::CreateShaderPipeline(
-    GraphicsShaderPipeline& pipeline, const Handle<Shader>& vertex_shader, const Handle<Shader>& fragment_shader
-)
+    // Pipelines keep their own copy of the shader code, only the cache entries need to go.
+    pipeline_cache.Evict(gpu_shader, GetDeletionQueue().pipelines);
+    SDL_ReleaseGPUShader(device, gpu_shader);
+}
+
+// The pipelines depend on the state of the pass and the formats of its target, they are created by the pipeline cache instead.
+void SDL3GPURenderer::CreateShaderPipeline(GraphicsShaderPipeline&, const Handle<Shader>&, const Handle<Shader>&) {}
+
+// The cached pipelines are released together with the shaders they were created from.
+void SDL3GPURenderer::DestroyShaderPipeline(GraphicsShaderPipeline&) {}
+
+void SDL3GPURenderer::CreateComputePipeline(ComputeShaderPipeline& pipeline, const void* data, const usize size)
 {
-    constexpr SDL_GPUColorTargetBlendState blend_state{
-        .src_color_blendfactor = SDL_GPU_BLENDFACTOR_SRC_ALPHA,
-        .dst_color_blendfactor = SDL_GPU_BLENDFACTOR_ONE_MINUS_SRC_ALPHA,
-        .color_blend_op = SDL_GPU_BLENDOP_ADD,
-        .src_alpha_blendfactor = SDL_GPU_BLENDFACTOR_SRC_ALPHA,
-        .dst_alpha_blendfactor = SDL_GPU_BLENDFACTOR_ONE_MINUS_SRC_ALPHA,
-        .alpha_blend_op = SDL_GPU_BLENDOP_ADD,
-        .enable_blend = true
-    };
+    SDL_GPUShaderFormat format;
+    const char* entrypoint;
+    if (!GetShaderFormat(format, entrypoint)) return;
 
-    static constexpr SDL_GPUColorTargetDescription color_target_description{
-        .format = SDL_GPU_TEXTUREFORMAT_R8G8B8A8_UNORM, .blend_state = blend_state
+    const ComputeShaderSettings& settings = pipeline.GetSettings();
+    const SDL_GPUComputePipelineCreateInfo pipeline_info{
+        .code_size = size,
+        .code = static_cast<const uint8*>(data),
+        .entrypoint = entrypoint,
+        .format = format,
+        .num_samplers = settings.sampler_count,
+        .num_readonly_storage_textures = 0,
+        .num_readonly_storage_buffers = settings.read_only_storage_count,
+        .num_readwrite_storage_textures = 0,
+        .num_readwrite_storage_buffers = settings.read_write_storage_count,
+        .num_uniform_buffers = settings.uniform_count,
+        .threadcount_x = settings.thread_count_x,
+        .threadcount_y = settings.thread_count_y,
+        .threadcount_z = settings.thread_count_z,
+        .props = 0
     };
 
-    constexpr SDL_GPUGraphicsPipelineTargetInfo target_info{
-        .color_target_descriptions = &color_target_description,
-        .num_color_targets = 1,
-        .depth_stencil_format = SDL_GPU_TEXTUREFORMAT_D24_UNORM,
-        .has_depth_stencil_target = true
-    };
+    pipeline.compute_pipeline.pointer = SDL_CreateGPUComputePipeline(device, &pipeline_info);
+    if (pipeline.compute_pipeline.pointer == nullptr) Log::Error("Failed to create compute pipeline: {}", SDL_GetError());
+}
 
-    static constexpr SDL_GPUVertexBufferDescription vertex_buffer_description{
-        .slot = 0, .pitch = sizeof(float) * 8, .input_rate = SDL_GPU_VERTEXINPUTRATE_VERTEX
-    };
+void SDL3GPURenderer::DestroyComputePipeline(ComputeShaderPipeline& pipeline)
+{
+    if (pipeline.compute_pipeline.pointer == nullptr) return;
 
-    // TODO: make this editable per shader pipeline created.
-    static constexpr SDL_GPUVertexAttribute vertex_attributes[3]{
-        {.location = 0, .buffer_slot = 0, .format = SDL_GPU_VERTEXELEMENTFORMAT_FLOAT3, .offset = 0                },
-        {.location = 1, .buffer_slot = 0, .format = SDL_GPU_VERTEXELEMENTFORMAT_FLOAT3, .offset = sizeof(float) * 3},
-        {.location = 2, .buffer_slot = 0, .format = SDL_GPU_VERTEXELEMENTFORMAT_FLOAT2, .offset = sizeof(float) * 6}
-    };
+    GetDeletionQueue().compute_pipelines.push_back(static_cast<SDL_GPUComputePipeline*>(pipeline.compute_pipeline.pointer));
+    pipeline.compute_pipeline.pointer = nullptr;
+}
 
-    constexpr SDL_GPUVertexInputState vertex_input_state{
-        .vertex_buffer_descriptions = &vertex_buffer_description,
-        .num_vertex_buffers = 1,
-        .vertex_attributes = vertex_attributes,
-        .num_vertex_attributes = sizeof(vertex_attributes) / sizeof(SDL_GPUVertexAttribute)
+void SDL3GPURenderer::CreateStorageBuffer(StorageBuffer& buffer, const void* data)
+{
+    const SDL_GPUBufferCreateInfo buffer_info{
+        .usage = ToBufferUsageFlags(buffer.GetFlags()), .size = static_cast<uint32>(buffer.GetSize()), .props = 0
     };
 
-    constexpr SDL_GPUDepthStencilState depth_stencil_state{
-        .compare_op = SDL_GPU_COMPAREOP_LESS,
-        .enable_depth_test = true,
-        .enable_depth_write = true,
-    };
-    constexpr SDL_GPURasterizerState rasterizer_state{
-        .fill_mode = SDL_GPU_FILLMODE_FILL,
-        .cull_mode = SDL_GPU_CULLMODE_BACK,
-        .front_face = SDL_GPU_FRONTFACE_COUNTER_CLOCKWISE,
-        .enable_depth_clip = true,
-    };
+    buffer.buffer.pointer = SDL_CreateGPUBuffer(device, &buffer_info);
+    if (buffer.buffer.pointer == nullptr)
+    {
+        Log::Error("Failed to create storage buffer: {}", SDL_GetError());
+        return;
+    }
 
-    const SDL_GPUGraphicsPipelineCreateInfo pipeline_create_info{
-        .vertex_shader = static_cast<SDL_GPUShader*>(vertex_shader->shader.pointer),
-        .fragment_shader = static_cast<SDL_GPUShader*>(fragment_shader->shader.pointer),
-        .vertex_input_state = vertex_input_state,
-        .primitive_type = SDL_GPU_PRIMITIVETYPE_TRIANGLELIST,
-        .rasterizer_state = rasterizer_state,
-        .multisample_state = {},
-        .depth_stencil_state = depth_stencil_state,
-        .target_info = target_info,
-        .props = 0
-    };
+    if (data != nullptr) UpdateStorageBuffer(buffer, data, buffer.GetSize(), 0);
+}
+
+// Sent right away instead of through the upload scheduler, so the dispatches and draws recorded after it read the new data.
+// Outside of a render pass the copy is recorded into the render command buffer of the frame, buffers updated every frame
+// don't cost a submit of their own. Before the frame started or inside a render pass it goes through a copy command buffer.
+void SDL3GPURenderer::UpdateStorageBuffer(StorageBuffer& buffer, const void* data, const usize size, const usize offset)
+{
+    if (buffer.buffer.pointer == nullptr) return;
 
-    pipeline.shader_pipeline.pointer = SDL_CreateGPUGraphicsPipeline(device, &pipeline_create_info);
-    if (pipeline.shader_pipeline.pointer == nullptr) Log::Error("Failed to create shader pipeline: {}", SDL_GetError());
+    QueueBufferUpload(static_cast<SDL_GPUBuffer*>(buffer.buffer.pointer), static_cast<uint32>(offset), data, static_cast<uint32>(size));
+    if (render_command_buffer != nullptr && active_render_pass == nullptr)
+    {
+        RecordUploads(render_command_buffer);
+        upload_ring.SubmitWithFrame(frame_index);
+    }
+    else { DataUploadPass(); }
+    statistics.uploaded_bytes += size;
 }
 
-void SDL3GPURenderer::DestroyShaderPipeline(GraphicsShaderPipeline& pipeline)
+void SDL3GPURenderer::DestroyStorageBuffer(StorageBuffer& buffer)
 {
-    SDL_ReleaseGPUGraphicsPipeline(device, static_cast<SDL_GPUGraphicsPipeline*>(pipeline.shader_pipeline.pointer));
+    if (buffer.buffer.pointer == nullptr) return;
+
+    GetDeletionQueue().buffers.push_back(static_cast<SDL_GPUBuffer*>(buffer.buffer.pointer));
+    buffer.buffer.pointer = nullptr;
 }
\ No newline at end of file
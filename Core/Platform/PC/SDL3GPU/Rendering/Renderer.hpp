@@ -17,12 +17,27 @@ class SDL3GPURenderer final : public Renderer
 
     void Update() override;
     void SwapBuffer() override;
+    void WaitForSwapchain() override;
 
     void* GetContext() override;
 
     void RenderMesh(const Mesh& mesh) override;
+    bool RenderMeshesIndirectBuffer(
+        const GraphicsShaderPipeline& pipeline, const StorageBuffer& arguments, uint32 offset, uint32 draw_count,
+        const StorageBuffer& instances
+    ) override;
+    void DefragmentGeometry() override;
     void SetTextureSampler(uint32 slot, const Texture& texture) override;
-    void SetUniform(uint32 slot, const void* data, usize size) override;
+    void PrewarmPipeline(const RenderPassInterface& render_pass) override;
+
+    [[nodiscard]] bool SupportsCompute() const override { return true; }
+    void Dispatch(
+        const ComputeShaderPipeline& pipeline, std::span<const StorageBinding> bindings, uint32 group_count_x, uint32 group_count_y,
+        uint32 group_count_z
+    ) override;
+    void DispatchIndirect(
+        const ComputeShaderPipeline& pipeline, std::span<const StorageBinding> bindings, const StorageBuffer& arguments, uint32 offset
+    ) override;
 
     static SDL_GPUCommandBuffer* GetCommandBuffer();
 
@@ -30,6 +45,8 @@ class SDL3GPURenderer final : public Renderer
     void BeginRenderPass(const RenderPassInterface& render_pass) override;
     void EndRenderPass() override;
 
+    void PushUniform(uint32 slot, const void* data, usize size, ShaderStages stages) override;
+
     void CreateTexture(Texture& texture, const uint8* data, const SamplerSettings& sampler_settings) override;
     void ResizeTexture(Texture& texture, sint32 new_width, sint32 new_height) override;
     void DestroyTexture(Texture& texture) override;
@@ -49,4 +66,11 @@ class SDL3GPURenderer final : public Renderer
     void CreateShaderPipeline(GraphicsShaderPipeline& pipeline, const Handle<Shader>& vertex_shader, const Handle<Shader>& fragment_shader)
         override;
     void DestroyShaderPipeline(GraphicsShaderPipeline& pipeline) override;
+
+    void CreateComputePipeline(ComputeShaderPipeline& pipeline, const void* data, usize size) override;
+    void DestroyComputePipeline(ComputeShaderPipeline& pipeline) override;
+
+    void CreateStorageBuffer(StorageBuffer& buffer, const void* data) override;
+    void UpdateStorageBuffer(StorageBuffer& buffer, const void* data, usize size, usize offset) override;
+    void DestroyStorageBuffer(StorageBuffer& buffer) override;
 };
\ No newline at end of file
@@ -0,0 +1,589 @@
+#include "Rasterizer.hpp"
+
+#include "Core/Jobs.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
+#if defined(__AVX__)
+    #include <immintrin.h>
+    #define RASTERIZER_AVX
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+    #include <emmintrin.h>
+    #define RASTERIZER_SSE
+#endif
+
+namespace
+{
+    using Clock = std::chrono::steady_clock;
+    using milliseconds = std::chrono::duration<float, std::milli>;
+
+    struct Color
+    {
+        float r, g, b, a;
+    };
+
+    // Texture coordinates are clamped to this many texels before converting them to integers, far beyond any texture size.
+    constexpr float MAX_TEXEL_COORDINATE = 16777216.0f;
+
+    Color Unpack(const uint32 pixel)
+    {
+        constexpr float scale = 1.0f / 255.0f;
+        return {
+            static_cast<float>(pixel & 0xFF) * scale, static_cast<float>((pixel >> 8) & 0xFF) * scale,
+            static_cast<float>((pixel >> 16) & 0xFF) * scale, static_cast<float>(pixel >> 24) * scale
+        };
+    }
+
+    uint32 Pack(const Color& color)
+    {
+        const auto channel = [](const float value) { return static_cast<uint32>(Math::Clamp(value, 0.0f, 1.0f) * 255.0f + 0.5f); };
+        return channel(color.r) | channel(color.g) << 8 | channel(color.b) << 16 | channel(color.a) << 24;
+    }
+
+    Color Lerp(const Color& a, const Color& b, const float t)
+    {
+        return {a.r + (b.r - a.r) * t, a.g + (b.g - a.g) * t, a.b + (b.b - a.b) * t, a.a + (b.a - a.a) * t};
+    }
+
+    sint32 Wrap(const sint32 coordinate, const sint32 size, const uint32 wrap_mode)
+    {
+        switch (wrap_mode)
+        {
+        case SamplerSettings::REPEAT:
+            return (coordinate % size + size) % size;
+        case SamplerSettings::MIRRORED_REPEAT:
+        {
+            const sint32 period = (coordinate % (2 * size) + 2 * size) % (2 * size);
+            return period < size ? period : 2 * size - 1 - period;
+        }
+        default:
+            return Math::Clamp(coordinate, 0, size - 1);
+        }
+    }
+
+    // Only the magnification filter is used, the software backend doesn't create mipmaps.
+    Color Sample(const SoftwareTexture& texture, float u, float v)
+    {
+        if (texture.color.empty()) return {1.0f, 1.0f, 1.0f, 1.0f};
+        if (!std::isfinite(u) || !std::isfinite(v)) u = v = 0.0f;
+
+        const SamplerSettings settings = texture.sampler != nullptr ? *texture.sampler : SamplerSettings{};
+        const auto texel = [&](const sint32 x, const sint32 y)
+        {
+            const sint32 wrapped_x = Wrap(x, texture.width, settings.wrap_mode_u);
+            const sint32 wrapped_y = Wrap(y, texture.height, settings.wrap_mode_v);
+            return Unpack(texture.color[static_cast<usize>(wrapped_y) * texture.width + wrapped_x]);
+        };
+
+        float x = Math::Clamp(u * static_cast<float>(texture.width), -MAX_TEXEL_COORDINATE, MAX_TEXEL_COORDINATE);
+        float y = Math::Clamp(v * static_cast<float>(texture.height), -MAX_TEXEL_COORDINATE, MAX_TEXEL_COORDINATE);
+
+        if (settings.up_filter != SamplerSettings::LINEAR)
+        {
+            return texel(static_cast<sint32>(std::floor(x)), static_cast<sint32>(std::floor(y)));
+        }
+
+        // Texel centers are at half coordinates, so the four texels around the sample are blended by its distance to them.
+        x -= 0.5f;
+        y -= 0.5f;
+        const float floor_x = std::floor(x);
+        const float floor_y = std::floor(y);
+        const auto texel_x = static_cast<sint32>(floor_x);
+        const auto texel_y = static_cast<sint32>(floor_y);
+
+        const Color top = Lerp(texel(texel_x, texel_y), texel(texel_x + 1, texel_y), x - floor_x);
+        const Color bottom = Lerp(texel(texel_x, texel_y + 1), texel(texel_x + 1, texel_y + 1), x - floor_x);
+        return Lerp(top, bottom, y - floor_y);
+    }
+
+    // Same blend factors as the SDL3GPU pipelines.
+    uint32 Blend(const Color& source, const uint32 destination_pixel, const PipelineState::BlendMode mode)
+    {
+        switch (mode)
+        {
+        case PipelineState::BlendMode::ALPHA:
+            return Pack(Lerp(Unpack(destination_pixel), source, source.a));
+        case PipelineState::BlendMode::ADDITIVE:
+        {
+            const Color destination = Unpack(destination_pixel);
+            return Pack({source.r + destination.r, source.g + destination.g, source.b + destination.b, source.a + destination.a});
+        }
+        default:
+            return Pack(source);
+        }
+    }
+
+    bool DepthPasses(const PipelineState::CompareOp compare, const float depth, const float stored_depth)
+    {
+        switch (compare)
+        {
+        case PipelineState::CompareOp::LESS:
+            return depth < stored_depth;
+        case PipelineState::CompareOp::LESS_OR_EQUAL:
+            return depth <= stored_depth;
+        case PipelineState::CompareOp::EQUAL:
+            return depth == stored_depth;
+        default:
+            return true;
+        }
+    }
+
+    bool InsideEdge(const float edge, const bool top_left) { return edge > 0.0f || (edge == 0.0f && top_left); }
+
+#if defined(RASTERIZER_AVX)
+    __m256 LoadPositions(const Vertex* vertices, const usize component)
+    {
+        return _mm256_set_ps(
+            vertices[7].position[component], vertices[6].position[component], vertices[5].position[component],
+            vertices[4].position[component], vertices[3].position[component], vertices[2].position[component],
+            vertices[1].position[component], vertices[0].position[component]
+        );
+    }
+#elif defined(RASTERIZER_SSE)
+    __m128 LoadPositions(const Vertex* vertices, const usize component)
+    {
+        return _mm_set_ps(
+            vertices[3].position[component], vertices[2].position[component], vertices[1].position[component],
+            vertices[0].position[component]
+        );
+    }
+#endif
+} // namespace
+
+void SoftwareTexture::Resize(const sint32 new_width, const sint32 new_height)
+{
+    width = new_width;
+    height = new_height;
+
+    const usize pixel_count = static_cast<usize>(Math::Max(width, 0)) * static_cast<usize>(Math::Max(height, 0));
+    if (format == Texture::DEPTH_24) depth.assign(pixel_count, 1.0f);
+    else color.assign(pixel_count, 0);
+
+    dirty = true;
+}
+
+void Rasterizer::Begin(
+    SoftwareTexture& color, SoftwareTexture* depth, const PipelineState& state, const sint32 new_viewport_width,
+    const sint32 new_viewport_height
+)
+{
+    color_target = &color;
+    pipeline_state = state;
+    viewport_width = Math::Min(new_viewport_width, color.width);
+    viewport_height = Math::Min(new_viewport_height, color.height);
+
+    // A depth buffer of another size can't be indexed with the pixels of the color target, draw without it instead.
+    const bool depth_matches = depth != nullptr && depth->width == color.width && depth->height == color.height;
+    depth_target = depth_matches ? depth : nullptr;
+
+    tiles_x = (viewport_width + TILE_SIZE - 1) / TILE_SIZE;
+    tiles_y = (viewport_height + TILE_SIZE - 1) / TILE_SIZE;
+    tile_bins.resize(static_cast<usize>(tiles_x) * tiles_y);
+
+    clear_color = false;
+    clear_depth = false;
+}
+
+void Rasterizer::Clear(const float4* color, const float* depth)
+{
+    clear_color = color != nullptr;
+    if (clear_color) clear_color_value = *color;
+
+    clear_depth = depth != nullptr && depth_target != nullptr;
+    if (clear_depth) clear_depth_value = *depth;
+}
+
+void Rasterizer::Draw(
+    const Vertex* vertices, const uint32 vertex_count, const uint32* indices, const uint32 index_count,
+    const Matrix4& model_view_projection, const SoftwareTexture* texture
+)
+{
+    if (color_target == nullptr) return;
+
+    const auto start = Clock::now();
+
+    TransformVertices(vertices, vertex_count, model_view_projection);
+    statistics.vertices += vertex_count;
+
+    for (uint32 i = 0; i + 3 <= index_count; i += 3)
+    {
+        statistics.triangles++;
+
+        ClipVertex triangle[3];
+        bool valid = true;
+        for (uint32 corner = 0; corner < 3; corner++)
+        {
+            const uint32 index = indices[i + corner];
+            if (index >= vertex_count)
+            {
+                valid = false;
+                break;
+            }
+
+            const Vertex& vertex = vertices[index];
+            triangle[corner] = {
+                clip_x[index], clip_y[index], clip_z[index], clip_w[index], vertex.tex_coord.x(), vertex.tex_coord.y(),
+                vertex.color.x(), vertex.color.y(), vertex.color.z()
+            };
+        }
+
+        if (valid) ClipTriangle(triangle, texture);
+        else statistics.culled_triangles++;
+    }
+
+    statistics.setup_milliseconds += milliseconds(Clock::now() - start).count();
+}
+
+void Rasterizer::Flush()
+{
+    if (color_target == nullptr) return;
+
+    const auto start = Clock::now();
+
+    std::vector<uint64> worker_pixels(Jobs::GetWorkerCount(), 0);
+    Jobs::ParallelFor(
+        tile_bins.size(), 1,
+        [&](const usize begin, const usize end, const uint32 worker)
+        {
+            uint64 shaded_pixels = 0;
+            for (usize tile = begin; tile < end; tile++) { RasterizeTile(static_cast<uint32>(tile), shaded_pixels); }
+            worker_pixels[worker] += shaded_pixels;
+        }
+    );
+    for (const uint64 shaded_pixels : worker_pixels) { statistics.shaded_pixels += shaded_pixels; }
+
+    for (std::vector<uint32>& bin : tile_bins) { bin.clear(); }
+    triangles.clear();
+
+    color_target->dirty = true;
+    if (depth_target != nullptr) depth_target->dirty = true;
+    clear_color = false;
+    clear_depth = false;
+
+    statistics.raster_milliseconds += milliseconds(Clock::now() - start).count();
+}
+
+void Rasterizer::TransformVertices(const Vertex* vertices, const uint32 vertex_count, const Matrix4& matrix)
+{
+    clip_x.resize(vertex_count);
+    clip_y.resize(vertex_count);
+    clip_z.resize(vertex_count);
+    clip_w.resize(vertex_count);
+
+    float* const outputs[4] = {clip_x.data(), clip_y.data(), clip_z.data(), clip_w.data()};
+    uint32 index = 0;
+
+    // With row vectors every clip space component is the position dotted with a matrix column, so the columns are broadcast
+    // and several vertices are transformed at once.
+#if defined(RASTERIZER_AVX)
+    __m256 columns[4][4];
+    for (usize column = 0; column < 4; column++)
+    {
+        for (usize row = 0; row < 4; row++) { columns[column][row] = _mm256_set1_ps(matrix(row, column)); }
+    }
+
+    for (; index + 8 <= vertex_count; index += 8)
+    {
+        const __m256 x = LoadPositions(vertices + index, 0);
+        const __m256 y = LoadPositions(vertices + index, 1);
+        const __m256 z = LoadPositions(vertices + index, 2);
+
+        for (usize column = 0; column < 4; column++)
+        {
+            __m256 result = _mm256_add_ps(_mm256_mul_ps(x, columns[column][0]), columns[column][3]);
+            result = _mm256_add_ps(_mm256_mul_ps(y, columns[column][1]), result);
+            result = _mm256_add_ps(_mm256_mul_ps(z, columns[column][2]), result);
+            _mm256_storeu_ps(outputs[column] + index, result);
+        }
+    }
+#elif defined(RASTERIZER_SSE)
+    __m128 columns[4][4];
+    for (usize column = 0; column < 4; column++)
+    {
+        for (usize row = 0; row < 4; row++) { columns[column][row] = _mm_set1_ps(matrix(row, column)); }
+    }
+
+    for (; index + 4 <= vertex_count; index += 4)
+    {
+        const __m128 x = LoadPositions(vertices + index, 0);
+        const __m128 y = LoadPositions(vertices + index, 1);
+        const __m128 z = LoadPositions(vertices + index, 2);
+
+        for (usize column = 0; column < 4; column++)
+        {
+            __m128 result = _mm_add_ps(_mm_mul_ps(x, columns[column][0]), columns[column][3]);
+            result = _mm_add_ps(_mm_mul_ps(y, columns[column][1]), result);
+            result = _mm_add_ps(_mm_mul_ps(z, columns[column][2]), result);
+            _mm_storeu_ps(outputs[column] + index, result);
+        }
+    }
+#endif
+
+    for (; index < vertex_count; index++)
+    {
+        const float3& position = vertices[index].position;
+        for (usize column = 0; column < 4; column++)
+        {
+            outputs[column][index] = position.x() * matrix(0, column) + position.y() * matrix(1, column) +
+                                     position.z() * matrix(2, column) + matrix(3, column);
+        }
+    }
+}
+
+void Rasterizer::ClipTriangle(const ClipVertex (&vertices)[3], const SoftwareTexture* texture)
+{
+    // Triangles completely outside one of the planes of the clip volume.
+    const auto outside = [&](const auto& test) { return test(vertices[0]) && test(vertices[1]) && test(vertices[2]); };
+    if (outside([](const ClipVertex& v) { return v.x < -v.w; }) || outside([](const ClipVertex& v) { return v.x > v.w; }) ||
+        outside([](const ClipVertex& v) { return v.y < -v.w; }) || outside([](const ClipVertex& v) { return v.y > v.w; }) ||
+        outside([](const ClipVertex& v) { return v.z < 0.0f; }) || outside([](const ClipVertex& v) { return v.z > v.w; }))
+    {
+        statistics.culled_triangles++;
+        return;
+    }
+
+    if (vertices[0].z >= 0.0f && vertices[1].z >= 0.0f && vertices[2].z >= 0.0f)
+    {
+        SetupTriangle(vertices[0], vertices[1], vertices[2], texture);
+        return;
+    }
+
+    // Behind the near plane the perspective divide flips the vertices, so the triangle is cut at z = 0 into up to four vertices.
+    statistics.clipped_triangles++;
+
+    ClipVertex polygon[4];
+    uint32 polygon_count = 0;
+    for (uint32 i = 0; i < 3; i++)
+    {
+        const ClipVertex& current = vertices[i];
+        const ClipVertex& next = vertices[(i + 1) % 3];
+
+        if (current.z >= 0.0f) polygon[polygon_count++] = current;
+        if ((current.z >= 0.0f) != (next.z >= 0.0f))
+        {
+            const float t = current.z / (current.z - next.z);
+            const auto lerp = [t](const float a, const float b) { return a + (b - a) * t; };
+            polygon[polygon_count++] = {
+                lerp(current.x, next.x), lerp(current.y, next.y), 0.0f,
+                lerp(current.w, next.w), lerp(current.u, next.u), lerp(current.v, next.v),
+                lerp(current.r, next.r), lerp(current.g, next.g), lerp(current.b, next.b)
+            };
+        }
+    }
+
+    for (uint32 i = 1; i + 1 < polygon_count; i++) { SetupTriangle(polygon[0], polygon[i], polygon[i + 1], texture); }
+}
+
+void Rasterizer::SetupTriangle(
+    const ClipVertex& vertex0, const ClipVertex& vertex1, const ClipVertex& vertex2, const SoftwareTexture* texture
+)
+{
+    const auto width = static_cast<float>(viewport_width);
+    const auto height = static_cast<float>(viewport_height);
+
+    const ClipVertex* vertices[3] = {&vertex0, &vertex1, &vertex2};
+    float screen_x[3];
+    float screen_y[3];
+    float inverse_w[3];
+    for (uint32 i = 0; i < 3; i++)
+    {
+        if (vertices[i]->w <= 0.0f)
+        {
+            statistics.culled_triangles++;
+            return;
+        }
+
+        inverse_w[i] = 1.0f / vertices[i]->w;
+        screen_x[i] = (vertices[i]->x * inverse_w[i] * 0.5f + 0.5f) * width;
+        screen_y[i] = (0.5f - vertices[i]->y * inverse_w[i] * 0.5f) * height;
+    }
+
+    float area = (screen_x[1] - screen_x[0]) * (screen_y[2] - screen_y[0]) - (screen_y[1] - screen_y[0]) * (screen_x[2] - screen_x[0]);
+
+    // Front faces are counter clockwise like in the SDL3GPU pipelines, which gives a negative area with y pointing down.
+    const bool front_facing = area < 0.0f;
+    const bool culled = (pipeline_state.cull == PipelineState::CullMode::BACK && !front_facing) ||
+                        (pipeline_state.cull == PipelineState::CullMode::FRONT && front_facing);
+    if (area == 0.0f || culled)
+    {
+        statistics.culled_triangles++;
+        return;
+    }
+
+    // The edge functions are set up for a positive area, so front faces swap two vertices.
+    uint32 order[3] = {0, 1, 2};
+    if (front_facing)
+    {
+        std::swap(order[1], order[2]);
+        area = -area;
+    }
+
+    Triangle triangle{};
+
+    // Pixels are covered when their center is inside, the bounds are clamped to the target before converting to integers.
+    const float min_x = Math::Min(screen_x[0], Math::Min(screen_x[1], screen_x[2])) - 0.5f;
+    const float min_y = Math::Min(screen_y[0], Math::Min(screen_y[1], screen_y[2])) - 0.5f;
+    const float max_x = Math::Max(screen_x[0], Math::Max(screen_x[1], screen_x[2])) - 0.5f;
+    const float max_y = Math::Max(screen_y[0], Math::Max(screen_y[1], screen_y[2])) - 0.5f;
+    triangle.min_x = static_cast<sint32>(std::ceil(Math::Clamp(min_x, 0.0f, width)));
+    triangle.min_y = static_cast<sint32>(std::ceil(Math::Clamp(min_y, 0.0f, height)));
+    triangle.max_x = static_cast<sint32>(std::floor(Math::Clamp(max_x, -1.0f, width - 1.0f)));
+    triangle.max_y = static_cast<sint32>(std::floor(Math::Clamp(max_y, -1.0f, height - 1.0f)));
+    if (triangle.min_x > triangle.max_x || triangle.min_y > triangle.max_y)
+    {
+        statistics.culled_triangles++;
+        return;
+    }
+
+    for (uint32 k = 0; k < 3; k++)
+    {
+        const uint32 a = order[(k + 1) % 3];
+        const uint32 b = order[(k + 2) % 3];
+
+        triangle.edge_a[k] = screen_y[a] - screen_y[b];
+        triangle.edge_b[k] = screen_x[b] - screen_x[a];
+        triangle.edge_c[k] = -(triangle.edge_a[k] * screen_x[a] + triangle.edge_b[k] * screen_y[a]);
+        // With y pointing down and a positive area, left edges go up and top edges go right.
+        triangle.top_left[k] = triangle.edge_a[k] > 0.0f || (triangle.edge_a[k] == 0.0f && triangle.edge_b[k] > 0.0f);
+
+        const uint32 source = order[k];
+        const ClipVertex& vertex = *vertices[source];
+        triangle.inverse_w[k] = inverse_w[source];
+        triangle.depth[k] = vertex.z * inverse_w[source];
+        triangle.u[k] = vertex.u * inverse_w[source];
+        triangle.v[k] = vertex.v * inverse_w[source];
+        triangle.r[k] = vertex.r * inverse_w[source];
+        triangle.g[k] = vertex.g * inverse_w[source];
+        triangle.b[k] = vertex.b * inverse_w[source];
+    }
+
+    triangle.inverse_area = 1.0f / area;
+    triangle.texture = texture;
+
+    triangles.push_back(triangle);
+    BinTriangle(static_cast<uint32>(triangles.size() - 1));
+}
+
+void Rasterizer::BinTriangle(const uint32 index)
+{
+    const Triangle& triangle = triangles[index];
+
+    const sint32 first_tile_x = triangle.min_x / TILE_SIZE;
+    const sint32 first_tile_y = triangle.min_y / TILE_SIZE;
+    const sint32 last_tile_x = triangle.max_x / TILE_SIZE;
+    const sint32 last_tile_y = triangle.max_y / TILE_SIZE;
+
+    for (sint32 tile_y = first_tile_y; tile_y <= last_tile_y; tile_y++)
+    {
+        for (sint32 tile_x = first_tile_x; tile_x <= last_tile_x; tile_x++)
+        {
+            const float left = static_cast<float>(tile_x * TILE_SIZE) + 0.5f;
+            const float top = static_cast<float>(tile_y * TILE_SIZE) + 0.5f;
+            const float right = left + static_cast<float>(TILE_SIZE - 1);
+            const float bottom = top + static_cast<float>(TILE_SIZE - 1);
+
+            // Large triangles overlap many tiles of their bounds only partially or not at all, a tile is skipped when the pixel
+            // center furthest inside an edge is still outside of it.
+            bool overlaps = true;
+            for (uint32 k = 0; k < 3 && overlaps; k++)
+            {
+                const float x = triangle.edge_a[k] >= 0.0f ? right : left;
+                const float y = triangle.edge_b[k] >= 0.0f ? bottom : top;
+                overlaps = triangle.edge_a[k] * x + triangle.edge_b[k] * y + triangle.edge_c[k] >= 0.0f;
+            }
+            if (!overlaps) continue;
+
+            tile_bins[static_cast<usize>(tile_y) * tiles_x + tile_x].push_back(index);
+            statistics.binned_triangles++;
+        }
+    }
+}
+
+void Rasterizer::RasterizeTile(const uint32 tile, uint64& shaded_pixels)
+{
+    const sint32 width = color_target->width;
+    const sint32 tile_left = static_cast<sint32>(tile % tiles_x) * TILE_SIZE;
+    const sint32 tile_top = static_cast<sint32>(tile / tiles_x) * TILE_SIZE;
+    const sint32 tile_right = Math::Min(tile_left + TILE_SIZE, viewport_width) - 1;
+    const sint32 tile_bottom = Math::Min(tile_top + TILE_SIZE, viewport_height) - 1;
+
+    uint32* colors = color_target->color.data();
+    float* depths = depth_target != nullptr ? depth_target->depth.data() : nullptr;
+
+    if (clear_color || clear_depth)
+    {
+        const Color color{clear_color_value.x(), clear_color_value.y(), clear_color_value.z(), clear_color_value.w()};
+        const uint32 packed_clear_color = Pack(color);
+        for (sint32 y = tile_top; y <= tile_bottom; y++)
+        {
+            const usize row = static_cast<usize>(y) * width;
+            if (clear_color) std::fill(colors + row + tile_left, colors + row + tile_right + 1, packed_clear_color);
+            if (clear_depth) std::fill(depths + row + tile_left, depths + row + tile_right + 1, clear_depth_value);
+        }
+    }
+
+    const bool depth_test = depths != nullptr && pipeline_state.depth_test;
+
+    for (const uint32 index : tile_bins[tile])
+    {
+        const Triangle& triangle = triangles[index];
+
+        const sint32 min_x = Math::Max(triangle.min_x, tile_left);
+        const sint32 min_y = Math::Max(triangle.min_y, tile_top);
+        const sint32 max_x = Math::Min(triangle.max_x, tile_right);
+        const sint32 max_y = Math::Min(triangle.max_y, tile_bottom);
+
+        for (sint32 y = min_y; y <= max_y; y++)
+        {
+            const float center_x = static_cast<float>(min_x) + 0.5f;
+            const float center_y = static_cast<float>(y) + 0.5f;
+
+            // The edge functions are linear, so they are evaluated once per row and stepped by their x factor per pixel.
+            float edges[3];
+            for (uint32 k = 0; k < 3; k++)
+            {
+                edges[k] = triangle.edge_a[k] * center_x + triangle.edge_b[k] * center_y + triangle.edge_c[k];
+            }
+
+            for (sint32 x = min_x; x <= max_x;
+                 x++, edges[0] += triangle.edge_a[0], edges[1] += triangle.edge_a[1], edges[2] += triangle.edge_a[2])
+            {
+                if (!InsideEdge(edges[0], triangle.top_left[0]) || !InsideEdge(edges[1], triangle.top_left[1]) ||
+                    !InsideEdge(edges[2], triangle.top_left[2]))
+                {
+                    continue;
+                }
+
+                const float weights[3] = {
+                    edges[0] * triangle.inverse_area, edges[1] * triangle.inverse_area, edges[2] * triangle.inverse_area
+                };
+                const auto interpolate = [&weights](const float (&values)[3])
+                { return weights[0] * values[0] + weights[1] * values[1] + weights[2] * values[2]; };
+
+                const float depth = interpolate(triangle.depth);
+                if (depth < 0.0f || depth > 1.0f) continue;
+
+                const usize pixel = static_cast<usize>(y) * width + x;
+                if (depth_test)
+                {
+                    if (!DepthPasses(pipeline_state.depth_compare, depth, depths[pixel])) continue;
+                    if (pipeline_state.depth_write) depths[pixel] = depth;
+                }
+                // Depth only passes skip the shading, so pixels that pass are only shaded by the pass that writes the colors.
+                if (!pipeline_state.color_write) continue;
+
+                const float w = 1.0f / interpolate(triangle.inverse_w);
+                Color source{interpolate(triangle.r) * w, interpolate(triangle.g) * w, interpolate(triangle.b) * w, 1.0f};
+                if (triangle.texture != nullptr)
+                {
+                    source = Sample(*triangle.texture, interpolate(triangle.u) * w, interpolate(triangle.v) * w);
+                }
+
+                colors[pixel] = Blend(source, colors[pixel], pipeline_state.blend);
+                shaded_pixels++;
+            }
+        }
+    }
+}
\ No newline at end of file
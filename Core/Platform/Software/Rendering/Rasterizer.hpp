@@ -0,0 +1,131 @@
+#pragma once
+
+#include "Core/Math.hpp"
+#include "Core/Rendering/Renderer.hpp"
+
+#include <vector>
+
+// Texture of the software backend, color textures store one RGBA8 pixel per uint32 with red in the lowest byte.
+struct SoftwareTexture
+{
+    void Resize(sint32 new_width, sint32 new_height);
+
+    sint32 width{0};
+    sint32 height{0};
+    Texture::ColorFormat format{Texture::COLOR_RGBA_32};
+
+    std::vector<uint32> color{};
+    // Only used by depth textures, in [0, 1] like the ZO projection.
+    std::vector<float> depth{};
+
+    // Owned by the sampler cache of the backend.
+    const SamplerSettings* sampler{nullptr};
+
+    // Set when the pixels change, so the SDL texture the editor displays is only updated when needed.
+    bool dirty{true};
+    void* display_texture{nullptr};
+};
+
+// Draws triangles on the CPU, shaded like TestShader.slang: the texture sampled at the texture coordinate, or the vertex color
+// when no texture is set. Draw() transforms the vertices with SIMD and bins the triangles into screen tiles, Flush() then
+// rasterizes the tiles on all job workers. Tiles don't share pixels and draw their triangles in order, so every run of the same
+// frame produces the same image no matter how many workers there are.
+class Rasterizer
+{
+  public:
+    static constexpr sint32 TILE_SIZE = 64;
+
+    struct Statistics
+    {
+        uint32 vertices{0};
+        uint32 triangles{0};
+        // Outside the frustum, back facing or too small to cover a pixel center.
+        uint32 culled_triangles{0};
+        // Crossing the near plane, each one is drawn as one or two clipped triangles.
+        uint32 clipped_triangles{0};
+        // Triangles added to a tile, counted once per tile they overlap.
+        uint32 binned_triangles{0};
+        uint64 shaded_pixels{0};
+
+        // Time spent in Draw() and Flush().
+        float setup_milliseconds{0.0f};
+        float raster_milliseconds{0.0f};
+    };
+
+    // Starts drawing into the top left viewport_width x viewport_height of the textures, the depth texture is optional.
+    // Clears are done by the tile workers in Flush().
+    void Begin(SoftwareTexture& color, SoftwareTexture* depth, const PipelineState& state, sint32 viewport_width, sint32 viewport_height);
+    void Clear(const float4* color, const float* depth);
+
+    // The indices are relative to the vertices, the texture is sampled like texture_diffuse0.
+    void Draw(
+        const Vertex* vertices, uint32 vertex_count, const uint32* indices, uint32 index_count, const Matrix4& model_view_projection,
+        const SoftwareTexture* texture
+    );
+    // Rasterizes all triangles drawn since Begin().
+    void Flush();
+
+    [[nodiscard]] const Statistics& GetStatistics() const { return statistics; }
+    void ResetStatistics() { statistics = {}; }
+
+  private:
+    // Vertex in clip space after the transform, before the perspective divide.
+    struct ClipVertex
+    {
+        float x, y, z, w;
+        float u, v;
+        float r, g, b;
+    };
+
+    // Edge functions and perspective divided attributes of a triangle, set up once and evaluated per pixel.
+    struct Triangle
+    {
+        // Edge k is opposite vertex k and positive inside the triangle, evaluated as a * x + b * y + c.
+        float edge_a[3];
+        float edge_b[3];
+        float edge_c[3];
+        // Pixel centers exactly on a top or left edge are inside, so pixels on shared edges are only drawn once.
+        bool top_left[3];
+        float inverse_area;
+
+        float depth[3];
+        float inverse_w[3];
+        // Attributes divided by w, interpolated linearly in screen space and multiplied by the interpolated w per pixel.
+        float u[3], v[3];
+        float r[3], g[3], b[3];
+
+        sint32 min_x, min_y, max_x, max_y;
+        const SoftwareTexture* texture;
+    };
+
+    void TransformVertices(const Vertex* vertices, uint32 vertex_count, const Matrix4& matrix);
+    // Clips against the near plane, everything else is handled by the bounds and the depth range.
+    void ClipTriangle(const ClipVertex (&vertices)[3], const SoftwareTexture* texture);
+    void SetupTriangle(const ClipVertex& vertex0, const ClipVertex& vertex1, const ClipVertex& vertex2, const SoftwareTexture* texture);
+    void BinTriangle(uint32 index);
+
+    void RasterizeTile(uint32 tile, uint64& shaded_pixels);
+
+    SoftwareTexture* color_target{nullptr};
+    SoftwareTexture* depth_target{nullptr};
+    PipelineState pipeline_state;
+    sint32 viewport_width{0};
+    sint32 viewport_height{0};
+
+    bool clear_color{false};
+    bool clear_depth{false};
+    float4 clear_color_value{};
+    float clear_depth_value{1.0f};
+
+    sint32 tiles_x{0};
+    sint32 tiles_y{0};
+
+    // Clip space positions of the vertices of the current draw, stored per component so they can be written with SIMD.
+    std::vector<float> clip_x, clip_y, clip_z, clip_w;
+
+    std::vector<Triangle> triangles;
+    // Indices of the triangles overlapping each tile, in draw order.
+    std::vector<std::vector<uint32>> tile_bins;
+
+    Statistics statistics;
+};
\ No newline at end of file
@@ -0,0 +1,337 @@
+#include "Core/Rendering/Renderer.hpp"
+#include "Renderer.hpp"
+
+#include "Tools/Logging.hpp"
+#include "Core/Window.hpp"
+#include "Core/Rendering/RenderPassInterface.hpp"
+
+#include <SDL3/SDL_render.h>
+#include <SDL3/SDL_timer.h>
+#include <algorithm>
+#include <cstring>
+#include <string_view>
+#include <unordered_set>
+
+namespace
+{
+    SDL_Renderer* sdl_renderer = nullptr;
+
+    Rasterizer rasterizer;
+
+    // Shared vertex and index buffers, the geometry allocator decides where every mesh lives in them.
+    std::vector<Vertex> vertex_buffer;
+    std::vector<uint32> index_buffer;
+
+    // Model, view and projection matrices in uniform slots 0 to 2 like TestShader.slang, other uniforms are ignored.
+    constexpr uint32 MATRIX_SLOTS = 3;
+    Matrix4 matrices[MATRIX_SLOTS] = {Matrix4::Identity(), Matrix4::Identity(), Matrix4::Identity()};
+
+    // Only texture_diffuse0 is sampled.
+    const SoftwareTexture* bound_texture = nullptr;
+
+    // Rendered to by passes targeting the window, presented after the last pass of the frame.
+    SoftwareTexture backbuffer{.format = Texture::COLOR_RGBA_32};
+    SoftwareTexture backbuffer_depth{.format = Texture::DEPTH_24};
+    bool backbuffer_drawn = false;
+
+    // The rasterizer runs while the pass is recorded, so the time of a pass is measured on the CPU from its begin to its flush.
+    std::string_view active_pass_name;
+    uint64 pass_start = 0;
+
+    // Textures point to the settings they are sampled with, elements of an unordered set keep their address.
+    std::unordered_set<SamplerSettings> sampler_cache;
+
+    Renderer::PresentMode applied_present_mode = Renderer::PresentMode::VSYNC;
+
+    // The SDL renderer only knows v-sync intervals, MAILBOX uses adaptive v-sync like the OpenGL backend.
+    void ApplyPresentMode(const Renderer::PresentMode mode)
+    {
+        applied_present_mode = mode;
+        if (sdl_renderer == nullptr) return;
+
+        bool applied = false;
+        switch (mode)
+        {
+        case Renderer::PresentMode::IMMEDIATE: applied = SDL_SetRenderVSync(sdl_renderer, SDL_RENDERER_VSYNC_DISABLED); break;
+        case Renderer::PresentMode::MAILBOX: applied = SDL_SetRenderVSync(sdl_renderer, SDL_RENDERER_VSYNC_ADAPTIVE); break;
+        case Renderer::PresentMode::VSYNC:
+        default: break;
+        }
+
+        if (!applied) SDL_SetRenderVSync(sdl_renderer, 1);
+    }
+
+    SoftwareTexture* GetTexture(const Texture& texture) { return static_cast<SoftwareTexture*>(texture.texture.pointer); }
+
+    void DestroyDisplayTexture(SoftwareTexture& texture)
+    {
+        SDL_DestroyTexture(static_cast<SDL_Texture*>(texture.display_texture));
+        texture.display_texture = nullptr;
+    }
+
+    SDL_Texture* UpdateDisplayTexture(SoftwareTexture& texture)
+    {
+        if (sdl_renderer == nullptr || texture.color.empty()) return nullptr;
+
+        auto* display_texture = static_cast<SDL_Texture*>(texture.display_texture);
+        if (display_texture == nullptr)
+        {
+            display_texture =
+                SDL_CreateTexture(sdl_renderer, SDL_PIXELFORMAT_RGBA32, SDL_TEXTUREACCESS_STREAMING, texture.width, texture.height);
+            if (display_texture == nullptr)
+            {
+                Log::Error("Failed to create display texture: {}", SDL_GetError());
+                return nullptr;
+            }
+
+            texture.display_texture = display_texture;
+            texture.dirty = true;
+        }
+
+        if (texture.dirty)
+        {
+            SDL_UpdateTexture(display_texture, nullptr, texture.color.data(), texture.width * static_cast<sint32>(sizeof(uint32)));
+            texture.dirty = false;
+        }
+
+        return display_texture;
+    }
+} // namespace
+
+SoftwareRenderer::SoftwareRenderer() : Renderer{}
+{
+    // The shaders are never compiled, but are still loaded from the files the OpenGL backend uses.
+    backend_shader_info = {
+        .file_extension = ".glsl", .binary = false, .profile = "glsl_150", .invert_y = true, .compute_profile = "glsl_430"
+    };
+}
+
+void SoftwareRenderer::InitBackend()
+{
+    geometry_allocator.Reset();
+    vertex_buffer.resize(geometry_allocator.GetVertices().GetCapacity());
+    index_buffer.resize(geometry_allocator.GetIndices().GetCapacity());
+
+    // Rendering doesn't need the SDL renderer, without it the frames just aren't shown.
+    auto* window = static_cast<SDL_Window*>(Window::GetHandle());
+    sdl_renderer = SDL_CreateRenderer(window, SDL_SOFTWARE_RENDERER);
+    if (sdl_renderer == nullptr) Log::Error("Failed to create the software SDL renderer: {}", SDL_GetError());
+    ApplyPresentMode(present_mode);
+
+    Resource::Load<GraphicsShaderPipeline>(
+        "Assets/Shaders/TestShader.slang", ShaderSettings{Shader::VERTEX, 0, 0, 3}, ShaderSettings{Shader::FRAGMENT, 1, 0, 0}
+    );
+}
+
+void SoftwareRenderer::ExitBackend()
+{
+    DestroyDisplayTexture(backbuffer);
+    SDL_DestroyRenderer(sdl_renderer);
+    sdl_renderer = nullptr;
+
+    vertex_buffer.clear();
+    vertex_buffer.shrink_to_fit();
+    index_buffer.clear();
+    index_buffer.shrink_to_fit();
+    sampler_cache.clear();
+}
+
+void SoftwareRenderer::Update()
+{
+    if (present_mode != applied_present_mode) ApplyPresentMode(present_mode);
+
+    rasterizer.ResetStatistics();
+    backbuffer_drawn = false;
+
+    if (sdl_renderer != nullptr)
+    {
+        SDL_SetRenderDrawColor(sdl_renderer, 0, 0, 0, 255);
+        SDL_RenderClear(sdl_renderer);
+    }
+}
+
+void SoftwareRenderer::EndFrame()
+{
+    if (!backbuffer_drawn || sdl_renderer == nullptr) return;
+
+    // Drawn before the editor UI, which is rendered on top of it before presenting.
+    SDL_RenderTexture(sdl_renderer, UpdateDisplayTexture(backbuffer), nullptr, nullptr);
+}
+
+void SoftwareRenderer::SwapBuffer()
+{
+    if (sdl_renderer != nullptr) SDL_RenderPresent(sdl_renderer);
+}
+
+void* SoftwareRenderer::GetContext() { return sdl_renderer; }
+
+void SoftwareRenderer::RenderMesh(const Mesh& mesh)
+{
+    if (!GeometryAllocator::IsAllocated(mesh)) return;
+
+    const Matrix4 model_view_projection = matrices[0] * matrices[1] * matrices[2];
+    rasterizer.Draw(
+        vertex_buffer.data() + mesh.base_vertex, mesh.GetVerticesCount(), index_buffer.data() + mesh.first_index, mesh.GetIndicesCount(),
+        model_view_projection, bound_texture
+    );
+    statistics.draw_calls++;
+}
+
+void SoftwareRenderer::SetTextureSampler(const uint32 slot, const Texture& texture)
+{
+    if (slot != 0) return;
+
+    if (bound_texture == GetTexture(texture))
+    {
+        statistics.skipped_state_changes++;
+        return;
+    }
+
+    bound_texture = GetTexture(texture);
+    statistics.state_changes++;
+}
+
+std::span<const uint32> SoftwareRenderer::GetPixels(const Texture& texture)
+{
+    const SoftwareTexture* software_texture = GetTexture(texture);
+    if (software_texture == nullptr) return {};
+
+    return software_texture->color;
+}
+
+SDL_Texture* SoftwareRenderer::GetDisplayTexture(const Texture& texture)
+{
+    SoftwareTexture* software_texture = GetTexture(texture);
+    if (software_texture == nullptr) return nullptr;
+
+    return UpdateDisplayTexture(*software_texture);
+}
+
+const Rasterizer::Statistics& SoftwareRenderer::GetRasterizerStatistics() { return rasterizer.GetStatistics(); }
+
+void SoftwareRenderer::BeginRenderPass(const RenderPassInterface& render_pass)
+{
+    const Handle<RenderTarget>& render_target = render_pass.GetTarget();
+
+    active_pass_name = render_pass.GetName();
+    pass_start = SDL_GetTicksNS();
+
+    bound_texture = nullptr;
+    statistics.state_changes++;
+
+    if (render_target->render_buffers.empty())
+    {
+        // The window is cleared by the first pass drawing to it, like acquiring a swapchain texture.
+        const sint32 width = Window::GetWidth();
+        const sint32 height = Window::GetHeight();
+        if (backbuffer.width != width || backbuffer.height != height)
+        {
+            DestroyDisplayTexture(backbuffer);
+            backbuffer.Resize(width, height);
+            backbuffer_depth.Resize(width, height);
+        }
+
+        rasterizer.Begin(backbuffer, &backbuffer_depth, render_pass.pipeline_state, width, height);
+        if (!backbuffer_drawn)
+        {
+            constexpr float clear_depth = 1.0f;
+            const float4 clear_color{0.0f, 0.0f, 0.0f, 1.0f};
+            rasterizer.Clear(&clear_color, &clear_depth);
+        }
+
+        backbuffer_drawn = true;
+        return;
+    }
+
+    const RenderBuffer& color_buffer = render_target->render_buffers[0];
+    const RenderBuffer& depth_buffer = render_target->depth_buffer;
+    SoftwareTexture* depth_texture = depth_buffer.GetTexture() != nullptr ? GetTexture(*depth_buffer.GetTexture()) : nullptr;
+
+    rasterizer.Begin(
+        *GetTexture(*color_buffer.GetTexture()), depth_texture, render_pass.pipeline_state, render_target->GetWidth(),
+        render_target->GetHeight()
+    );
+
+    constexpr float clear_depth = 1.0f;
+    rasterizer.Clear(
+        color_buffer.load_op == RenderBuffer::LoadOp::CLEAR ? &color_buffer.clear_color : nullptr,
+        depth_buffer.load_op == RenderBuffer::LoadOp::CLEAR ? &clear_depth : nullptr
+    );
+}
+
+void SoftwareRenderer::EndRenderPass()
+{
+    rasterizer.Flush();
+    AddPassTiming(active_pass_name, static_cast<float>(SDL_GetTicksNS() - pass_start) / 1e6f);
+}
+
+void SoftwareRenderer::PushUniform(const uint32 slot, const void* data, const usize size, const ShaderStages stages)
+{
+    if (slot >= MATRIX_SLOTS || size != sizeof(Matrix4) || (stages & VERTEX_STAGE) == 0) return;
+
+    std::memcpy(matrices[slot].data(), data, size);
+}
+
+void SoftwareRenderer::CreateTexture(Texture& texture, const uint8* data, const SamplerSettings& sampler_settings)
+{
+    auto* software_texture = new SoftwareTexture{.format = texture.GetFormat()};
+    software_texture->Resize(texture.GetWidth(), texture.GetHeight());
+    software_texture->sampler = &*sampler_cache.insert(sampler_settings).first;
+
+    // Texture data is loaded as RGBA8, the same layout the pixels are stored in.
+    if (data != nullptr && texture.GetFormat() == Texture::COLOR_RGBA_32)
+    {
+        std::memcpy(software_texture->color.data(), data, software_texture->color.size() * sizeof(uint32));
+    }
+
+    texture.texture.pointer = software_texture;
+}
+
+void SoftwareRenderer::ResizeTexture(Texture& texture, const sint32 new_width, const sint32 new_height)
+{
+    SoftwareTexture* software_texture = GetTexture(texture);
+    if (software_texture == nullptr) return;
+
+    DestroyDisplayTexture(*software_texture);
+    software_texture->Resize(new_width, new_height);
+}
+
+void SoftwareRenderer::DestroyTexture(Texture& texture)
+{
+    SoftwareTexture* software_texture = GetTexture(texture);
+    if (software_texture == nullptr) return;
+
+    if (bound_texture == software_texture) bound_texture = nullptr;
+
+    DestroyDisplayTexture(*software_texture);
+    delete software_texture;
+    texture.texture.pointer = nullptr;
+}
+
+void SoftwareRenderer::CreateMesh(Mesh& mesh, const std::vector<Vertex>& vertices, const std::vector<uint32>& indices)
+{
+    // The buffers are only resized when the allocator grows, so meshes never need to be moved.
+    if (!geometry_allocator.Allocate(mesh))
+    {
+        const auto [vertex_capacity, index_capacity] = geometry_allocator.GetGrownCapacities(mesh);
+        geometry_allocator.Grow(vertex_capacity, index_capacity);
+        vertex_buffer.resize(vertex_capacity);
+        index_buffer.resize(index_capacity);
+
+        if (!geometry_allocator.Allocate(mesh))
+        {
+            Log::Error("Failed to allocate {} vertices and {} indices", mesh.GetVerticesCount(), mesh.GetIndicesCount());
+            return;
+        }
+    }
+
+    std::ranges::copy(vertices, vertex_buffer.begin() + mesh.base_vertex);
+    std::ranges::copy(indices, index_buffer.begin() + mesh.first_index);
+}
+
+void SoftwareRenderer::DestroyMesh(Mesh& mesh)
+{
+    if (!GeometryAllocator::IsAllocated(mesh)) return;
+
+    geometry_allocator.Free(mesh);
+}
\ No newline at end of file
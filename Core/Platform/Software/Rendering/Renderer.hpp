@@ -0,0 +1,74 @@
+#pragma once
+
+#include "Core/Rendering/Renderer.hpp"
+#include "Rasterizer.hpp"
+
+struct SDL_Texture;
+
+// Backend that renders on the CPU with the tile rasterizer, every shader is drawn like TestShader.slang.
+// Gives reference images that are the same on every machine and an editor viewport without a GPU,
+// the window and the editor UI are presented with the software SDL_Renderer.
+class SoftwareRenderer final : public Renderer
+{
+  public:
+    SoftwareRenderer();
+    ~SoftwareRenderer() override = default;
+
+    constexpr usize WindowFlags() override { return 0; }
+
+    void InitBackend() override;
+    void ExitBackend() override;
+
+    void Update() override;
+    void SwapBuffer() override;
+
+    // The SDL_Renderer the frames are presented with, nullptr when it couldn't be created.
+    void* GetContext() override;
+
+    void RenderMesh(const Mesh& mesh) override;
+    void SetTextureSampler(uint32 slot, const Texture& texture) override;
+
+    // Pixels of a color texture, RGBA8 with red in the lowest byte, rows from top to bottom.
+    [[nodiscard]] static std::span<const uint32> GetPixels(const Texture& texture);
+    // SDL texture with the current pixels of the texture, updated when they changed since the last call.
+    [[nodiscard]] static SDL_Texture* GetDisplayTexture(const Texture& texture);
+    // Counters and timings of the rasterizer for the current frame.
+    [[nodiscard]] static const Rasterizer::Statistics& GetRasterizerStatistics();
+
+  private:
+    void EndFrame() override;
+
+    void BeginRenderPass(const RenderPassInterface& render_pass) override;
+    void EndRenderPass() override;
+
+    void PushUniform(uint32 slot, const void* data, usize size, ShaderStages stages) override;
+
+    void CreateTexture(Texture& texture, const uint8* data, const SamplerSettings& sampler_settings) override;
+    void ResizeTexture(Texture& texture, sint32 new_width, sint32 new_height) override;
+    void DestroyTexture(Texture& texture) override;
+
+    void CreateRenderTarget(RenderTarget& target) override {}
+    void UpdateRenderBuffer(const RenderTarget& target, usize index) override {}
+    void UpdateDepthBuffer(const RenderTarget& target) override {}
+    void DestroyRenderTarget(RenderTarget& target) override {}
+
+    void CreateMesh(Mesh& mesh, const std::vector<Vertex>& vertices, const std::vector<uint32>& indices) override;
+    void DestroyMesh(Mesh& mesh) override;
+
+    void CreateShader(Shader& shader, const void* data, usize size) override {}
+    void DestroyShader(Shader& shader) override {}
+
+    void CreateShaderPipeline(GraphicsShaderPipeline& pipeline, const Handle<Shader>& vertex_shader, const Handle<Shader>& fragment_shader)
+        override
+    {
+    }
+    void DestroyShaderPipeline(GraphicsShaderPipeline& pipeline) override {}
+
+    // Compute shaders can't run on the rasterizer, SupportsCompute() stays false and dispatches do nothing.
+    void CreateComputePipeline(ComputeShaderPipeline& pipeline, const void* data, usize size) override {}
+    void DestroyComputePipeline(ComputeShaderPipeline& pipeline) override {}
+
+    void CreateStorageBuffer(StorageBuffer& buffer, const void* data) override {}
+    void UpdateStorageBuffer(StorageBuffer& buffer, const void* data, usize size, usize offset) override {}
+    void DestroyStorageBuffer(StorageBuffer& buffer) override {}
+};
\ No newline at end of file
@@ -0,0 +1,44 @@
+#pragma once
+
+#include "Types.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+// Bump allocator over a single block of memory, everything is freed at once by Reset().
+// Allocations are referenced by offset, so they stay valid when the block grows.
+class LinearAllocator
+{
+  public:
+    explicit LinearAllocator(const usize capacity = 0) : memory(capacity) {}
+
+    // Returns the offset of size bytes aligned to alignment (a power of two), grows the block when it is full.
+    usize Allocate(const usize size, const usize alignment = 16)
+    {
+        const usize offset = (used + alignment - 1) & ~(alignment - 1);
+        if (offset + size > memory.size()) memory.resize(std::max(memory.size() * 2, offset + size));
+
+        used = offset + size;
+        return offset;
+    }
+
+    usize Push(const void* data, const usize size, const usize alignment = 16)
+    {
+        const usize offset = Allocate(size, alignment);
+        std::memcpy(memory.data() + offset, data, size);
+        return offset;
+    }
+
+    void Reset() { used = 0; }
+
+    [[nodiscard]] uint8* GetData(const usize offset) { return memory.data() + offset; }
+    [[nodiscard]] const uint8* GetData(const usize offset) const { return memory.data() + offset; }
+
+    [[nodiscard]] usize GetUsed() const { return used; }
+    [[nodiscard]] usize GetCapacity() const { return memory.size(); }
+
+  private:
+    std::vector<uint8> memory;
+    usize used{0};
+};
\ No newline at end of file
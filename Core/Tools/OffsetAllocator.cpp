@@ -0,0 +1,275 @@
+#include "OffsetAllocator.hpp"
+
+#include <algorithm>
+#include <bit>
+
+OffsetAllocator::OffsetAllocator(const uint32 capacity) { Reset(capacity); }
+
+OffsetAllocator::Allocation OffsetAllocator::Allocate(uint32 size)
+{
+    size = std::max(size, 1u);
+
+    const uint32 node = FindFreeRange(size);
+    if (node == NONE) return {};
+    RemoveFreeRange(node);
+
+    const uint32 remainder = nodes[node].size - size;
+    nodes[node].size = size;
+    nodes[node].used = true;
+
+    if (remainder > 0)
+    {
+        const uint32 split = CreateNode(nodes[node].offset + size, remainder);
+        const uint32 next = nodes[node].neighbor_next;
+
+        nodes[split].neighbor_previous = node;
+        nodes[split].neighbor_next = next;
+        if (next != NONE) { nodes[next].neighbor_previous = split; }
+        else { last_node = split; }
+        nodes[node].neighbor_next = split;
+
+        InsertFreeRange(split);
+    }
+
+    used_size += size;
+    allocation_count++;
+
+    return Allocation{nodes[node].offset, node};
+}
+
+uint32 OffsetAllocator::FindFreeRange(const uint32 size) const
+{
+    // Every range in the bins at or above the rounded up bin is large enough, so the first one found can be used.
+    const uint32 min_bin = BinRoundUp(size);
+    const uint32 top_bin = min_bin >> MANTISSA_BITS;
+
+    const uint32 leaf_mask = used_leaf_bins[top_bin] & (0xFFu << (min_bin & (LEAF_BIN_COUNT - 1)));
+    if (leaf_mask != 0) return bin_heads[(top_bin << MANTISSA_BITS) | std::countr_zero(leaf_mask)];
+
+    const uint32 top_mask = top_bin + 1 < TOP_BIN_COUNT ? used_top_bins & (~0u << (top_bin + 1)) : 0;
+    if (top_mask != 0)
+    {
+        const uint32 found_top_bin = std::countr_zero(top_mask);
+        return bin_heads[(found_top_bin << MANTISSA_BITS) | std::countr_zero(static_cast<uint32>(used_leaf_bins[found_top_bin]))];
+    }
+
+    // The bin the size rounds down to can still contain a range that is large enough, like the single range left by Defragment().
+    for (uint32 node = bin_heads[BinRoundDown(size)]; node != NONE; node = nodes[node].bin_next)
+    {
+        if (nodes[node].size >= size) return node;
+    }
+
+    return NONE;
+}
+
+void OffsetAllocator::Free(const uint32 node)
+{
+    used_size -= nodes[node].size;
+    allocation_count--;
+    nodes[node].used = false;
+
+    const uint32 previous = nodes[node].neighbor_previous;
+    if (previous != NONE && !nodes[previous].used)
+    {
+        RemoveFreeRange(previous);
+
+        nodes[node].offset = nodes[previous].offset;
+        nodes[node].size += nodes[previous].size;
+        nodes[node].neighbor_previous = nodes[previous].neighbor_previous;
+        if (nodes[node].neighbor_previous != NONE) nodes[nodes[node].neighbor_previous].neighbor_next = node;
+
+        ReleaseNode(previous);
+    }
+
+    const uint32 next = nodes[node].neighbor_next;
+    if (next != NONE && !nodes[next].used)
+    {
+        RemoveFreeRange(next);
+
+        nodes[node].size += nodes[next].size;
+        nodes[node].neighbor_next = nodes[next].neighbor_next;
+        if (nodes[node].neighbor_next != NONE) { nodes[nodes[node].neighbor_next].neighbor_previous = node; }
+        else { last_node = node; }
+
+        ReleaseNode(next);
+    }
+
+    InsertFreeRange(node);
+}
+
+void OffsetAllocator::Grow(const uint32 new_capacity)
+{
+    if (new_capacity <= capacity) return;
+
+    const uint32 added_size = new_capacity - capacity;
+    if (last_node != NONE && !nodes[last_node].used)
+    {
+        RemoveFreeRange(last_node);
+        nodes[last_node].size += added_size;
+        InsertFreeRange(last_node);
+    }
+    else
+    {
+        const uint32 node = CreateNode(capacity, added_size);
+        nodes[node].neighbor_previous = last_node;
+        if (last_node != NONE) nodes[last_node].neighbor_next = node;
+
+        last_node = node;
+        InsertFreeRange(node);
+    }
+
+    capacity = new_capacity;
+}
+
+void OffsetAllocator::Defragment(std::vector<Relocation>& relocations)
+{
+    std::vector<uint32> allocations;
+    allocations.reserve(allocation_count);
+    for (uint32 node = 0; node < nodes.size(); node++)
+    {
+        if (nodes[node].used) allocations.push_back(node);
+    }
+    std::ranges::sort(allocations, {}, [this](const uint32 node) { return nodes[node].offset; });
+
+    // The free ranges disappear, their nodes can be reused.
+    std::ranges::fill(bin_heads, NONE);
+    std::ranges::fill(used_leaf_bins, 0);
+    used_top_bins = 0;
+    free_range_count = 0;
+
+    unused_nodes.clear();
+    for (uint32 node = 0; node < nodes.size(); node++)
+    {
+        if (!nodes[node].used) unused_nodes.push_back(node);
+    }
+
+    // Moving every allocation towards the start in offset order never overwrites an allocation that still has to be moved.
+    uint32 offset = 0;
+    uint32 previous = NONE;
+    for (const uint32 node : allocations)
+    {
+        if (nodes[node].offset != offset) relocations.push_back(Relocation{node, nodes[node].offset, offset, nodes[node].size});
+
+        nodes[node].offset = offset;
+        nodes[node].neighbor_previous = previous;
+        nodes[node].neighbor_next = NONE;
+        if (previous != NONE) nodes[previous].neighbor_next = node;
+
+        offset += nodes[node].size;
+        previous = node;
+    }
+    last_node = previous;
+
+    const uint32 full_capacity = capacity;
+    capacity = offset;
+    Grow(full_capacity);
+}
+
+void OffsetAllocator::Reset(const uint32 new_capacity)
+{
+    nodes.clear();
+    unused_nodes.clear();
+
+    std::ranges::fill(bin_heads, NONE);
+    std::ranges::fill(used_leaf_bins, 0);
+    used_top_bins = 0;
+
+    last_node = NONE;
+    capacity = 0;
+    used_size = 0;
+    allocation_count = 0;
+    free_range_count = 0;
+
+    Grow(new_capacity);
+}
+
+uint32 OffsetAllocator::BinRoundUp(const uint32 size)
+{
+    uint32 bin = BinRoundDown(size);
+    if (size < LEAF_BIN_COUNT) return bin;
+
+    // Sizes between two bins belong to the next one, the bits below the mantissa are lost otherwise.
+    const uint32 mantissa_shift = std::bit_width(size) - 1 - MANTISSA_BITS;
+    if ((size & ((1u << mantissa_shift) - 1)) != 0) bin++;
+
+    return bin;
+}
+
+uint32 OffsetAllocator::BinRoundDown(const uint32 size)
+{
+    // Small sizes map to their own bin.
+    if (size < LEAF_BIN_COUNT) return size;
+
+    const uint32 mantissa_shift = std::bit_width(size) - 1 - MANTISSA_BITS;
+    const uint32 exponent = mantissa_shift + 1;
+    const uint32 mantissa = (size >> mantissa_shift) & (LEAF_BIN_COUNT - 1);
+
+    return (exponent << MANTISSA_BITS) | mantissa;
+}
+
+uint32 OffsetAllocator::CreateNode(const uint32 offset, const uint32 size)
+{
+    uint32 node;
+    if (unused_nodes.empty())
+    {
+        node = static_cast<uint32>(nodes.size());
+        nodes.emplace_back();
+    }
+    else
+    {
+        node = unused_nodes.back();
+        unused_nodes.pop_back();
+        nodes[node] = Node{};
+    }
+
+    nodes[node].offset = offset;
+    nodes[node].size = size;
+    return node;
+}
+
+void OffsetAllocator::ReleaseNode(const uint32 node)
+{
+    nodes[node] = Node{};
+    unused_nodes.push_back(node);
+}
+
+void OffsetAllocator::InsertFreeRange(const uint32 node)
+{
+    const uint32 bin = BinRoundDown(nodes[node].size);
+    const uint32 top_bin = bin >> MANTISSA_BITS;
+
+    nodes[node].bin_previous = NONE;
+    nodes[node].bin_next = bin_heads[bin];
+    if (bin_heads[bin] != NONE) nodes[bin_heads[bin]].bin_previous = node;
+    bin_heads[bin] = node;
+
+    used_top_bins |= 1u << top_bin;
+    used_leaf_bins[top_bin] |= static_cast<uint8>(1u << (bin & (LEAF_BIN_COUNT - 1)));
+    free_range_count++;
+}
+
+void OffsetAllocator::RemoveFreeRange(const uint32 node)
+{
+    const uint32 previous = nodes[node].bin_previous;
+    const uint32 next = nodes[node].bin_next;
+
+    if (next != NONE) nodes[next].bin_previous = previous;
+    if (previous != NONE) { nodes[previous].bin_next = next; }
+    else
+    {
+        const uint32 bin = BinRoundDown(nodes[node].size);
+        bin_heads[bin] = next;
+
+        // The bin was emptied, clear its bit and the bit of the top bin when it was its last leaf bin.
+        if (next == NONE)
+        {
+            const uint32 top_bin = bin >> MANTISSA_BITS;
+            used_leaf_bins[top_bin] &= static_cast<uint8>(~(1u << (bin & (LEAF_BIN_COUNT - 1))));
+            if (used_leaf_bins[top_bin] == 0) used_top_bins &= ~(1u << top_bin);
+        }
+    }
+
+    nodes[node].bin_previous = NONE;
+    nodes[node].bin_next = NONE;
+    free_range_count--;
+}
\ No newline at end of file
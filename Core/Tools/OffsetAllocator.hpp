@@ -0,0 +1,104 @@
+#pragma once
+
+#include "Types.hpp"
+
+#include <vector>
+
+// Two level segregated fit (TLSF) allocator of ranges inside a block of memory it doesn't own, like a GPU buffer.
+// Free ranges are sorted into bins by size, so allocating and freeing are constant time, and freed ranges are merged with their neighbours.
+// Allocations are identified by a node that stays the same when the allocator is grown or defragmented, only the offset changes.
+class OffsetAllocator
+{
+  public:
+    static constexpr uint32 NONE = ~0u;
+
+    struct Allocation
+    {
+        uint32 offset{NONE};
+        uint32 node{NONE};
+    };
+
+    // Range of an allocation moved by Defragment(), the data needs to be copied from source to destination.
+    struct Relocation
+    {
+        uint32 node;
+        uint32 source;
+        uint32 destination;
+        uint32 size;
+    };
+
+    explicit OffsetAllocator(uint32 capacity = 0);
+
+    // Returns an allocation with the offset NONE when there is no free range large enough.
+    Allocation Allocate(uint32 size);
+    void Free(uint32 node);
+
+    // Adds the space up to new_capacity as a free range at the end.
+    void Grow(uint32 new_capacity);
+    // Packs all allocations to the start so the free space is a single range at the end, moved allocations are added to relocations.
+    void Defragment(std::vector<Relocation>& relocations);
+    // Frees all allocations.
+    void Reset(uint32 new_capacity);
+
+    [[nodiscard]] uint32 GetOffset(const uint32 node) const { return nodes[node].offset; }
+    [[nodiscard]] uint32 GetSize(const uint32 node) const { return nodes[node].size; }
+
+    [[nodiscard]] uint32 GetCapacity() const { return capacity; }
+    [[nodiscard]] uint32 GetUsed() const { return used_size; }
+    [[nodiscard]] uint32 GetAllocationCount() const { return allocation_count; }
+    [[nodiscard]] uint32 GetFreeRangeCount() const { return free_range_count; }
+
+  private:
+    // Sizes are stored as small floats with 3 mantissa bits, every power of two is split into 8 bins.
+    static constexpr uint32 MANTISSA_BITS = 3;
+    static constexpr uint32 LEAF_BIN_COUNT = 1 << MANTISSA_BITS;
+    static constexpr uint32 TOP_BIN_COUNT = 32;
+    static constexpr uint32 BIN_COUNT = TOP_BIN_COUNT * LEAF_BIN_COUNT;
+
+    struct Node
+    {
+        uint32 offset{0};
+        uint32 size{0};
+
+        // Free ranges in the same bin.
+        uint32 bin_previous{NONE};
+        uint32 bin_next{NONE};
+
+        // Ranges directly before and after this one.
+        uint32 neighbor_previous{NONE};
+        uint32 neighbor_next{NONE};
+
+        bool used{false};
+    };
+
+    // Smallest bin whose ranges are all at least size large, used to find a free range.
+    static uint32 BinRoundUp(uint32 size);
+    // Largest bin whose ranges are at most size large, used to store a free range.
+    static uint32 BinRoundDown(uint32 size);
+
+    // Free range of at least size, or NONE.
+    [[nodiscard]] uint32 FindFreeRange(uint32 size) const;
+
+    uint32 CreateNode(uint32 offset, uint32 size);
+    void ReleaseNode(uint32 node);
+
+    // Adds the free range to the bin of its size.
+    void InsertFreeRange(uint32 node);
+    void RemoveFreeRange(uint32 node);
+
+    std::vector<Node> nodes;
+    std::vector<uint32> unused_nodes;
+
+    uint32 bin_heads[BIN_COUNT]{};
+    // One bit per top bin that has any free range, and per top bin one bit for each of its leaf bins.
+    uint32 used_top_bins{0};
+    uint8 used_leaf_bins[TOP_BIN_COUNT]{};
+
+    // Range with the highest offset, extended by Grow().
+    uint32 last_node{NONE};
+
+    uint32 capacity{0};
+    uint32 used_size{0};
+    uint32 allocation_count{0};
+    uint32 free_range_count{0};
+};
\ No newline at end of file
@@ -0,0 +1,139 @@
+#include "Profiler.hpp"
+
+#include "Files.hpp"
+#include "Logging.hpp"
+
+#include <algorithm>
+#include <format>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace
+{
+    using Clock = std::chrono::steady_clock;
+
+    // Reference points the ticks are converted to time with, the tick rate is measured between them and the export.
+    const uint64 start_ticks = Profiler::GetTicks();
+    const Clock::time_point start_time = Clock::now();
+
+    // The events of threads that ended are kept, so they are still part of the trace.
+    std::mutex threads_mutex;
+    std::vector<std::unique_ptr<Profiler::ThreadEvents>> threads;
+
+    void AppendEscaped(std::string& json, const std::string_view text)
+    {
+        for (const char character : text)
+        {
+            if (character == '"' || character == '\\') json += '\\';
+            json += character;
+        }
+    }
+} // namespace
+
+namespace Profiler
+{
+    ThreadEvents& RegisterThread()
+    {
+        std::lock_guard lock{threads_mutex};
+
+        thread_events = threads.emplace_back(std::make_unique<ThreadEvents>()).get();
+        thread_events->thread_id = static_cast<uint32>(threads.size() - 1);
+        return *thread_events;
+    }
+
+    void SetThreadName(const char* name)
+    {
+        ThreadEvents& events = thread_events != nullptr ? *thread_events : RegisterThread();
+        events.thread_name.store(name, std::memory_order_relaxed);
+    }
+
+    bool ExportChromeTrace(const std::string& path)
+    {
+        const uint64 end_ticks = GetTicks();
+        const auto elapsed = std::chrono::duration<double, std::micro>(Clock::now() - start_time).count();
+        const double microseconds_per_tick = elapsed / static_cast<double>(std::max<uint64>(end_ticks - start_ticks, 1));
+
+        std::string json = "{\"traceEvents\":[\n";
+        std::vector<Event> events;
+        usize event_count = 0;
+        {
+            std::lock_guard lock{threads_mutex};
+            for (const auto& thread : threads)
+            {
+                const uint64 count = thread->count.load(std::memory_order_acquire);
+                const uint64 first = count > ThreadEvents::CAPACITY ? count - ThreadEvents::CAPACITY : 0;
+
+                events.clear();
+                for (uint64 i = first; i < count; i++) { events.push_back(thread->events[i % ThreadEvents::CAPACITY]); }
+
+                // The thread kept recording while the events were copied, the oldest ones may have been overwritten meanwhile.
+                // The slot of the next event is written before the count is published, so it can be half written as well.
+                const uint64 new_count = thread->count.load(std::memory_order_acquire) + 1;
+                const uint64 overwritten = new_count > ThreadEvents::CAPACITY ? new_count - ThreadEvents::CAPACITY : 0;
+                const usize skipped = overwritten > first ? static_cast<usize>(std::min(overwritten - first, count - first)) : 0;
+
+                const char* thread_name = thread->thread_name.load(std::memory_order_relaxed);
+                if (thread_name != nullptr)
+                {
+                    json += std::format(R"({{"name":"thread_name","ph":"M","pid":0,"tid":{},"args":{{"name":")", thread->thread_id);
+                    AppendEscaped(json, thread_name);
+                    json += "\"}},\n";
+                }
+
+                for (usize i = skipped; i < events.size(); i++)
+                {
+                    const Event& event = events[i];
+                    const double begin = static_cast<double>(event.begin - start_ticks) * microseconds_per_tick;
+                    const double duration = static_cast<double>(event.end - event.begin) * microseconds_per_tick;
+
+                    json += R"({"name":")";
+                    AppendEscaped(json, event.name);
+                    json += std::format(R"(","ph":"X","pid":0,"tid":{},"ts":{:.3f},"dur":{:.3f})", thread->thread_id, begin, duration);
+                    if (!event.detail.empty())
+                    {
+                        json += R"(,"args":{"detail":")";
+                        AppendEscaped(json, event.detail);
+                        json += "\"}";
+                    }
+                    json += "},\n";
+                    event_count++;
+                }
+            }
+        }
+
+        // The trailing comma is replaced by the end of the array.
+        if (json.ends_with(",\n")) json.resize(json.size() - 2);
+        json += "\n]}\n";
+
+        if (!Files::WriteText(path, json)) return false;
+
+        Log::Log("Profiler: exported {} events to {}", event_count, path);
+        return true;
+    }
+
+    void RunBenchmark(const uint32 zone_count)
+    {
+        // Recorded into separate events, so the benchmark doesn't overwrite the events of the calling thread.
+        ThreadEvents* const previous_events = thread_events;
+        const auto benchmark_events = std::make_unique<ThreadEvents>();
+        thread_events = benchmark_events.get();
+
+        const auto start = Clock::now();
+        for (uint32 i = 0; i < zone_count; i++) { const Zone zone{"Benchmark"}; }
+        const auto nanoseconds = std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+
+        thread_events = previous_events;
+
+        // The two ticks of a zone on their own, the rest of the cost is recording the event.
+        volatile uint64 ticks = 0;
+        const auto ticks_start = Clock::now();
+        for (uint32 i = 0; i < zone_count; i++) { ticks = GetTicks() - GetTicks(); }
+        const auto ticks_nanoseconds = std::chrono::duration<double, std::nano>(Clock::now() - ticks_start).count();
+
+        Log::Log(
+            "Profiler benchmark: {} zones, {:.1f} ns per zone of which {:.1f} ns reading the ticks", zone_count,
+            nanoseconds / static_cast<double>(zone_count), ticks_nanoseconds / static_cast<double>(zone_count)
+        );
+    }
+} // namespace Profiler
\ No newline at end of file
@@ -0,0 +1,113 @@
+#pragma once
+
+#include "Types.hpp"
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <string_view>
+
+#if defined(_M_X64) || defined(__x86_64__)
+    #ifdef _MSC_VER
+        #include <intrin.h>
+    #else
+        #include <x86intrin.h>
+    #endif
+#endif
+
+// Scoped CPU zones, exported as a Chrome trace (chrome://tracing or ui.perfetto.dev) with Profiler::ExportChromeTrace().
+// The zones compile to nothing when the engine is built without ENGINE_PROFILING.
+#ifdef ENGINE_PROFILING
+    #define PROFILE_CONCAT_INNER(a, b) a##b
+    #define PROFILE_CONCAT(a, b) PROFILE_CONCAT_INNER(a, b)
+    // Measures the rest of the scope, the name needs to outlive the profiler (a string literal).
+    #define PROFILE_ZONE(name) const Profiler::Zone PROFILE_CONCAT(profile_zone_, __LINE__){name}
+    // Same as PROFILE_ZONE(), with a detail shown in the arguments of the event, which needs to outlive the profiler as well.
+    #define PROFILE_ZONE_DETAIL(name, detail) const Profiler::Zone PROFILE_CONCAT(profile_zone_, __LINE__){name, detail}
+    // Names the calling thread in the trace, the name needs to outlive the profiler.
+    #define PROFILE_THREAD(name) Profiler::SetThreadName(name)
+#else
+    #define PROFILE_ZONE(name)
+    #define PROFILE_ZONE_DETAIL(name, detail)
+    #define PROFILE_THREAD(name)
+#endif
+
+namespace Profiler
+{
+#ifdef ENGINE_PROFILING
+    constexpr bool ENABLED = true;
+#else
+    constexpr bool ENABLED = false;
+#endif
+
+    struct Event
+    {
+        std::string_view name;
+        std::string_view detail;
+        uint64 begin;
+        uint64 end;
+    };
+
+    // Events recorded by one thread. Only the owning thread writes them, so recording doesn't need locks: the event is written
+    // first and the count is published afterwards. Once the buffer is full the oldest events are overwritten.
+    struct ThreadEvents
+    {
+        static constexpr uint64 CAPACITY = 32 * 1024;
+
+        std::array<Event, CAPACITY> events;
+        std::atomic<uint64> count{0};
+        std::atomic<const char*> thread_name{nullptr};
+        uint32 thread_id{0};
+    };
+
+    // Ticks of the timestamp counter, converted to time when the trace is exported.
+    inline uint64 GetTicks()
+    {
+#if defined(_M_X64) || defined(__x86_64__)
+        return __rdtsc();
+#else
+        return static_cast<uint64>(std::chrono::steady_clock::now().time_since_epoch().count());
+#endif
+    }
+
+    // Creates the events of the calling thread the first time it records a zone.
+    ThreadEvents& RegisterThread();
+
+    inline thread_local ThreadEvents* thread_events = nullptr;
+
+    inline void Record(const std::string_view name, const std::string_view detail, const uint64 begin, const uint64 end)
+    {
+        ThreadEvents& events = thread_events != nullptr ? *thread_events : RegisterThread();
+
+        const uint64 count = events.count.load(std::memory_order_relaxed);
+        events.events[count % ThreadEvents::CAPACITY] = Event{name, detail, begin, end};
+        events.count.store(count + 1, std::memory_order_release);
+    }
+
+    class Zone
+    {
+      public:
+        explicit Zone(const std::string_view name, const std::string_view detail = {}) : name{name}, detail{detail}, begin{GetTicks()} {}
+        ~Zone() { Record(name, detail, begin, GetTicks()); }
+
+        Zone(const Zone&) = delete;
+        Zone& operator=(const Zone&) = delete;
+
+      private:
+        std::string_view name;
+        std::string_view detail;
+        uint64 begin;
+    };
+
+    // Name the thread is shown with in the trace, needs to outlive the profiler.
+    void SetThreadName(const char* name);
+
+    /// @brief Writes the events every thread recorded so far to a JSON file in the Chrome trace event format.
+    /// Can be called while other threads are recording, zones that haven't ended yet aren't part of the trace.
+    /// @return If the file was written.
+    bool ExportChromeTrace(const std::string& path);
+
+    // Logs the time it takes to record a zone.
+    void RunBenchmark(uint32 zone_count = 1'000'000);
+} // namespace Profiler
\ No newline at end of file
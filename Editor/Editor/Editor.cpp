@@ -6,16 +6,22 @@
 #include "ShaderCompiler.hpp"
 
 #include <Core/Input.hpp>
+#include <Core/Jobs.hpp>
 #include <Core/Rendering/Renderer.hpp>
+#include <Core/Rendering/RenderGraph.hpp>
 #include <Core/Rendering/RenderPassInterface.hpp>
 #include <Core/Resource.hpp>
+#include <Core/Spatial.hpp>
 #include <Core/Time.hpp>
 #include <Core/Window.hpp>
 #include <Core/Physics/Physics.hpp>
+#include <Platform/Software/Rendering/Renderer.hpp>
+#include <Tools/Profiler.hpp>
 
 #include <SDL3/SDL_mouse.h>
 
 #include <imgui.h>
+#include <algorithm>
 #include <numeric>
 
 namespace
@@ -30,6 +36,46 @@ namespace
     ECS::Entity backpack_entity;
     ECS::Entity camera_entity;
 
+    Handle<DefaultRenderPass> default_render_pass;
+    Handle<DepthPrepassRenderPass> depth_prepass_render_pass;
+
+    ECS::Entity selected_entity;
+
+    // Selects the closest entity under the cursor, position is relative to the top left of the viewport.
+    void PickEntity(const float2& position, const float2& viewport_size)
+    {
+        const auto& camera_transform = camera_entity.GetComponent<Transform>();
+        const auto& camera = camera_entity.GetComponent<Camera>();
+
+        const Matrix4 view_projection = Math::Inverse(camera_transform.GetMatrix()) * camera.GetProjection(*Renderer::main_target);
+
+        // The far plane is at depth 1 for both clip space conventions, the ray starts at the camera position.
+        const float4 clip{position.x() / viewport_size.x() * 2.0f - 1.0f, 1.0f - position.y() / viewport_size.y() * 2.0f, 1.0f, 1.0f};
+        const float4 far_point = clip * Math::Inverse(view_projection);
+
+        const float3 origin = camera_transform.GetPosition();
+        const float3 direction = (far_point.head<3>() / far_point.w() - origin).normalized();
+
+        Spatial::RayHit hit;
+        selected_entity = Spatial::RayCast(origin, direction, hit, camera.far) ? hit.entity : ECS::Entity{};
+    }
+
+    // Adds the pre-pass right before the default pass, passes render to the targets they share in the order they were added.
+    void SetDepthPrepass(const bool enabled)
+    {
+        std::vector<Handle<RenderPassInterface>>& render_passes = Renderer::render_passes;
+        std::erase_if(render_passes, [](const Handle<RenderPassInterface>& pass) { return pass == depth_prepass_render_pass; });
+        if (enabled)
+        {
+            const auto default_pass =
+                std::ranges::find_if(render_passes, [](const Handle<RenderPassInterface>& pass) { return pass == default_render_pass; });
+            render_passes.insert(default_pass, depth_prepass_render_pass);
+        }
+
+        DepthPrepassRenderPass::SetupShadingPass(default_render_pass->pipeline_state, enabled);
+        Renderer::Instance().PrewarmPipeline(*default_render_pass);
+    }
+
     void CreateDefaultEntities()
     {
         Handle<Mesh> handle = Resource::Load<Mesh>("Assets/Backpack/backpack.obj", 0);
@@ -46,34 +92,74 @@ namespace
 
 int main(int, char* args[])
 {
+    PROFILE_THREAD("Main");
     Renderer::SetupBackend(args[1]);
+    Jobs::Init();
     Window::Init(&ImGui::PlatformProcessEvent);
     ShaderCompiler::Init();
     ShaderCompiler::CompileShader("Assets/Shaders/TestShader.slang"); 
     ShaderCompiler::CompileShader("Assets/Shaders/PhysicsDebug.slang");
+    ShaderCompiler::CompileShader("Assets/Shaders/TestShaderIndirect.slang");
+    ShaderCompiler::CompileShader("Assets/Shaders/GpuCulling.slang");
+    ShaderCompiler::CompileShader("Assets/Shaders/DepthPrepass.slang");
     Renderer::Init();
 
     Editor::Init();
     Handle<GraphicsShaderPipeline> graphics_pipeline = Resource::GetResources<GraphicsShaderPipeline>()[0];
-    Renderer::render_passes.emplace_back(std::make_shared<DefaultRenderPass>(graphics_pipeline, Renderer::main_target));
+    default_render_pass = std::make_shared<DefaultRenderPass>(graphics_pipeline, Renderer::main_target);
+    if (Renderer::Instance().SupportsIndirectDraws() || Renderer::Instance().SupportsCompute())
+    {
+        default_render_pass->indirect_pipeline = Resource::Load<GraphicsShaderPipeline>(
+            "Assets/Shaders/TestShaderIndirect.slang", ShaderSettings{Shader::VERTEX, 0, 0, 2}, ShaderSettings{Shader::FRAGMENT, 1, 0, 0}
+        );
+    }
+    if (Renderer::Instance().SupportsCompute())
+    {
+        default_render_pass->culling_pipeline = Resource::Load<ComputeShaderPipeline>(
+            "Assets/Shaders/GpuCulling.slang",
+            ComputeShaderSettings{.read_only_storage_count = 2, .read_write_storage_count = 2, .uniform_count = 1}
+        );
+    }
+    Renderer::render_passes.emplace_back(default_render_pass);
+    Renderer::Instance().PrewarmPipeline(*default_render_pass);
+
+    depth_prepass_render_pass = std::make_shared<DepthPrepassRenderPass>(
+        Resource::Load<GraphicsShaderPipeline>(
+            "Assets/Shaders/DepthPrepass.slang", ShaderSettings{Shader::VERTEX, 0, 0, 3}, ShaderSettings{Shader::FRAGMENT, 0, 0, 0}
+        ),
+        Renderer::main_target
+    );
+    Renderer::Instance().PrewarmPipeline(*depth_prepass_render_pass);
     graphics_pipeline.reset();
 
     Physics::Init();
     ECS::Init();
+    Spatial::Init();
 
     CreateDefaultEntities();
 
     while (!Window::PollEvents())
     {
+        PROFILE_ZONE("Frame");
         Time::Update();
 
         Physics::Update(Time::GetDeltaTime());
+        Spatial::Update();
 
         Editor::Update();
         Renderer::Instance().SwapBuffer();
+
+        // Both waits happen before the next frame reads its input, so the input is as recent as possible when the frame is shown.
+        PROFILE_ZONE("Frame wait");
+        Time::WaitForNextFrame();
+        Renderer::Instance().WaitForSwapchain();
     }
 
+    default_render_pass.reset();
+    depth_prepass_render_pass.reset();
+
     ECS::Exit();
+    Spatial::Exit();
     Physics::Exit();
 
     Resource::CleanResources(true);
@@ -81,6 +167,7 @@ int main(int, char* args[])
     ImGui::PlatformExit();
     Renderer::Exit();
     Window::Exit();
+    Jobs::Exit();
 
     return 0;
 }
@@ -127,6 +214,18 @@ namespace Editor
                 }
                 else if (ImGui::IsMouseReleased(ImGuiMouseButton_Right)) { ImGui::LockMouse(false); }
 
+                if (ImGui::IsMouseClicked(ImGuiMouseButton_Left))
+                {
+                    const ImVec2 viewport_position{ImGui::GetWindowPos().x, ImGui::GetWindowPos().y + ImGui::GetFrameHeight()};
+                    const ImVec2 viewport_size{ImGui::GetWindowSize().x, ImGui::GetWindowSize().y - ImGui::GetFrameHeight()};
+                    const ImVec2 mouse_position = ImGui::GetMousePos();
+
+                    PickEntity(
+                        float2{mouse_position.x - viewport_position.x, mouse_position.y - viewport_position.y},
+                        float2{viewport_size.x, viewport_size.y}
+                    );
+                }
+
                 if (ImGui::IsMouseDown(ImGuiMouseButton_Right))
                 {
                     ImGui::SetNextFrameWantCaptureMouse(false);
@@ -161,8 +260,14 @@ namespace Editor
             ImGui::PlatformRescaleGameWindow(window_content_area);
             Renderer::Render();
 
+            // The target renders to the top left of its textures, which are larger while the viewport is resized.
+            const RenderTarget& main_target = *Renderer::main_target;
+            const ImVec2 rendered_uv{
+                static_cast<float>(main_target.GetWidth()) / static_cast<float>(main_target.GetAllocatedWidth()),
+                static_cast<float>(main_target.GetHeight()) / static_cast<float>(main_target.GetAllocatedHeight())
+            };
             ImGui::SetCursorPos(ImVec2{0.0f, ImGui::GetFrameHeight()});
-            ImGui::Image(ImGui::GetPlatformTextureID(*Renderer::main_target), window_content_area);
+            ImGui::Image(ImGui::GetPlatformTextureID(*Renderer::main_target), window_content_area, ImVec2{0.0f, 0.0f}, rendered_uv);
         }
         ImGui::End();
 
@@ -171,10 +276,12 @@ namespace Editor
             const auto query = ECS::GetWorld().query_builder<Transform>().build();
 
             query.each([](const ECS::Entity entity, const Transform&) {
-                constexpr ImGuiTreeNodeFlags flags =
+                ImGuiTreeNodeFlags flags =
                     ImGuiTreeNodeFlags_SpanAvailWidth | ImGuiTreeNodeFlags_NoTreePushOnOpen | ImGuiTreeNodeFlags_Bullet;
+                if (selected_entity.IsValid() && selected_entity.GetID() == entity.GetID()) flags |= ImGuiTreeNodeFlags_Selected;
 
                 ImGui::TreeNodeEx(entity.Name().data(), flags);
+                if (ImGui::IsItemClicked()) selected_entity = entity;
             });
         }
         ImGui::End();
@@ -190,6 +297,120 @@ namespace Editor
             ImGui::Text("Delta time: %f", Time::GetDeltaTime());
             const sint32 frame_rate = static_cast<int>(1.0f / Time::GetDeltaTime());
             ImGui::Text("Frame rate: %i", frame_rate);
+
+            constexpr const char* present_modes[] = {"VSync", "Mailbox", "Immediate"};
+            auto present_mode = static_cast<int>(Renderer::present_mode);
+            if (ImGui::Combo("Present mode", &present_mode, present_modes, IM_ARRAYSIZE(present_modes)))
+            {
+                Renderer::present_mode = static_cast<Renderer::PresentMode>(present_mode);
+            }
+            ImGui::Checkbox("Late swapchain acquire", &Renderer::late_swapchain_acquire);
+            float frame_limit = Time::GetFrameLimit();
+            if (ImGui::SliderFloat("Frame limit", &frame_limit, 0.0f, 480.0f, frame_limit == 0.0f ? "Off" : "%.0f"))
+            {
+                Time::SetFrameLimit(frame_limit);
+            }
+
+            const Time::FrameStatistics& frame_statistics = Time::GetFrameStatistics();
+            ImGui::Text("Frame time: %.2f ms", frame_statistics.frame_milliseconds);
+            ImGui::Text("Submit latency: %.2f ms", frame_statistics.submit_latency_milliseconds);
+            ImGui::Text(
+                "Limiter: %.2f ms sleep, %.2f ms spin (%.3f ms late)", frame_statistics.sleep_milliseconds,
+                frame_statistics.spin_milliseconds, frame_statistics.limiter_error_milliseconds
+            );
+            ImGui::Text("Swapchain wait: %.2f ms", Renderer::GetStatistics().swapchain_wait_milliseconds);
+            ImGui::NewLine();
+
+            const Culling::Statistics& culling_statistics = default_render_pass->GetCullingStatistics();
+            constexpr const char* culling_modes[] = {"None", "Frustum", "Hierarchical"};
+            auto culling_mode = static_cast<int>(default_render_pass->culling_mode);
+            if (ImGui::Combo("Culling", &culling_mode, culling_modes, IM_ARRAYSIZE(culling_modes)))
+            {
+                default_render_pass->culling_mode = static_cast<DefaultRenderPass::CullingMode>(culling_mode);
+            }
+            ImGui::Text("Visible meshes: %u", culling_statistics.visible);
+            ImGui::Text("Culled meshes: %u", culling_statistics.culled);
+            ImGui::Text("Bounds tests: %u", culling_statistics.tests);
+
+            ImGui::Checkbox("GPU culling", &default_render_pass->gpu_culling);
+            const GpuCulling& gpu_culling = default_render_pass->GetGpuCulling();
+            ImGui::Text("GPU instances: %u (%u draws)", gpu_culling.GetInstanceCount(), gpu_culling.GetDrawCount());
+            ImGui::Checkbox("Occlusion culling", &default_render_pass->occlusion_culling);
+            const OcclusionBuffer::Statistics& occlusion_statistics = default_render_pass->GetOcclusionStatistics();
+            ImGui::Text("Occluded meshes: %u", culling_statistics.occluded);
+            ImGui::Text("Occluders: %u (%u triangles)", occlusion_statistics.occluders, occlusion_statistics.triangles);
+            ImGui::Text("Hierarchy height: %i", Spatial::GetHierarchy().GetHeight());
+            bool depth_prepass = std::ranges::find(Renderer::render_passes, depth_prepass_render_pass) != Renderer::render_passes.end();
+            if (ImGui::Checkbox("Depth pre-pass", &depth_prepass)) SetDepthPrepass(depth_prepass);
+            ImGui::Checkbox("Multithreaded draw lists", &default_render_pass->multithreaded);
+            ImGui::SameLine();
+            ImGui::Text("(%u workers)", Jobs::GetWorkerCount());
+            ImGui::Text("Selected: %s", selected_entity.IsValid() ? selected_entity.Name().data() : "none");
+            if (selected_entity.IsValid() && selected_entity.HasComponent<Handle<Mesh>>())
+            {
+                // The occluder covers the whole bounding box, so it should only be enabled for meshes that fill their bounds.
+                bool occluder = selected_entity.HasComponent<Occluder>();
+                if (ImGui::Checkbox("Occluder (bounding box)", &occluder))
+                {
+                    const BoundingBox& bounds = selected_entity.GetComponent<Handle<Mesh>>()->GetBoundingBox();
+                    if (occluder) selected_entity.AddComponent<Occluder>(Occluder::FromBox(bounds));
+                    else selected_entity.RemoveComponent<Occluder>();
+                }
+            }
+
+            const RenderGraph::Statistics& graph_statistics = Renderer::GetRenderGraph().GetStatistics();
+            ImGui::Text("Render passes: %u (%u culled)", graph_statistics.passes, graph_statistics.culled_passes);
+            ImGui::Text("Transient resources: %u", graph_statistics.transient_resources);
+            ImGui::Text("Transient textures: %u (%u pooled)", graph_statistics.transient_textures, graph_statistics.pooled_textures);
+            for (const Renderer::PassTiming& timing : Renderer::GetPassTimings())
+            {
+                ImGui::Text("GPU %s: %.3f ms (last %.3f ms)", timing.name.c_str(), timing.average_milliseconds, timing.last_milliseconds);
+            }
+
+            const Renderer::Statistics& renderer_statistics = Renderer::GetStatistics();
+            ImGui::Text("Uniform pushes: %u (%u skipped)", renderer_statistics.uniform_pushes, renderer_statistics.skipped_uniform_pushes);
+            ImGui::Text("Uniform bytes: %llu", static_cast<unsigned long long>(renderer_statistics.uniform_bytes));
+            ImGui::Text("Draw calls: %u", renderer_statistics.draw_calls);
+            ImGui::Text("Dispatches: %u", renderer_statistics.dispatches);
+            ImGui::Text("State changes: %u (%u skipped)", renderer_statistics.state_changes, renderer_statistics.skipped_state_changes);
+            ImGui::Text("Pipeline stalls: %u", renderer_statistics.pipeline_stalls);
+            ImGui::Text("Uploaded bytes: %llu", static_cast<unsigned long long>(renderer_statistics.uploaded_bytes));
+            ImGui::Text(
+                "Pending uploads: %u (%llu bytes)", renderer_statistics.pending_uploads,
+                static_cast<unsigned long long>(renderer_statistics.pending_upload_bytes)
+            );
+
+            if (Renderer::GetBackendName() == "Software")
+            {
+                const Rasterizer::Statistics& raster_statistics = SoftwareRenderer::GetRasterizerStatistics();
+                ImGui::Text(
+                    "Triangles: %u (%u culled, %u clipped)", raster_statistics.triangles, raster_statistics.culled_triangles,
+                    raster_statistics.clipped_triangles
+                );
+                ImGui::Text("Binned triangles: %u", raster_statistics.binned_triangles);
+                ImGui::Text("Shaded pixels: %llu", static_cast<unsigned long long>(raster_statistics.shaded_pixels));
+                ImGui::Text("Setup: %.2f ms, raster: %.2f ms", raster_statistics.setup_milliseconds, raster_statistics.raster_milliseconds);
+            }
+
+            int upload_budget_mb = static_cast<int>(Renderer::upload_budget / (1024 * 1024));
+            if (ImGui::SliderInt("Upload budget (MB)", &upload_budget_mb, 1, 256))
+            {
+                Renderer::upload_budget = static_cast<usize>(upload_budget_mb) * 1024 * 1024;
+            }
+
+            const GeometryAllocator& geometry = Renderer::GetGeometryAllocator();
+            ImGui::Text("Geometry vertices: %u / %u", geometry.GetVertices().GetUsed(), geometry.GetVertices().GetCapacity());
+            ImGui::Text("Geometry indices: %u / %u", geometry.GetIndices().GetUsed(), geometry.GetIndices().GetCapacity());
+            ImGui::Text("Geometry free ranges: %u", geometry.GetVertices().GetFreeRangeCount() + geometry.GetIndices().GetFreeRangeCount());
+            ImGui::Text("Geometry defragmentations: %u", geometry.GetStatistics().defragmentations);
+            if (ImGui::Button("Defragment geometry")) Renderer::Instance().DefragmentGeometry();
+            if (ImGui::Button("Run culling benchmark"))
+            {
+                Culling::RunBenchmark(100'000);
+                Culling::RunBenchmark(1'000'000);
+            }
+            if (ImGui::Button("Run profiler benchmark")) Profiler::RunBenchmark();
+            if (Profiler::ENABLED && ImGui::Button("Export profiler trace")) Profiler::ExportChromeTrace("trace.json");
             ImGui::NewLine();
 
             ImGui::Text("Camera");
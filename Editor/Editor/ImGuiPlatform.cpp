@@ -7,8 +7,10 @@
 #include "Core/Rendering/Renderer.hpp"
 #include "Core/Window.hpp"
 
+#include "Implementation/Null/ImGuiPlatform.hpp"
 #include "Implementation/OpenGL/ImGuiPlatform.hpp"
 #include "Implementation/SDL3GPU/ImGuiPlatform.hpp"
+#include "Implementation/Software/ImGuiPlatform.hpp"
 
 #include "Core/Input.hpp"
 
@@ -26,6 +28,8 @@ namespace ImGui
     {
         if (backend_name == "OpenGL") platform = new PlatformOpenGL;
         else if (backend_name == "SDL3GPU") platform = new PlatformSDL3GPU;
+        else if (backend_name == "Null") platform = new PlatformNull;
+        else if (backend_name == "Software") platform = new PlatformSoftware;
 
         Renderer::main_target = Resource::Load<RenderTarget>("EditorWindow");
 
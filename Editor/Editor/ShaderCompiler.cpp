@@ -3,6 +3,7 @@
 #include <Core/Rendering/Renderer.hpp>
 #include <Tools/Logging.hpp>
 #include <Tools/Files.hpp>
+#include <Tools/Profiler.hpp>
 #include <slang.h>
 #include <slang-com-ptr.h>
 
@@ -15,6 +16,7 @@ namespace
     Slang::ComPtr<IGlobalSession> global_session;
     Slang::ComPtr<ISession> vertex_session;
     Slang::ComPtr<ISession> fragment_session;
+    Slang::ComPtr<ISession> compute_session;
 
     bool TryLog(const Slang::ComPtr<IBlob>& diagnostic)
     {
@@ -31,87 +33,44 @@ namespace
         return std::memcmp(stored_hash.data(), hash->getBufferPointer(), stored_hash.size()) == 0;
     }
 
-} // namespace
-
-namespace ShaderCompiler
-{
-    void Init()
-    {
-        SlangGlobalSessionDesc description{.enableGLSL = true};
-        createGlobalSession(&description, global_session.writeRef());
-
-        const Renderer::BackendShaderInfo& backend_shader_info = Renderer::GetBackendShaderInfo();
-        const std::string& backend_name = Renderer::GetBackendName();
-
-        std::array<CompilerOptionEntry, 1> compiler_options{
-            {{CompilerOptionName::VulkanInvertY, {.intValue0 = backend_shader_info.invert_y}}}
-        };
-        const SlangProfileID profile = global_session->findProfile(backend_shader_info.profile);
-        const std::array<TargetDesc, 1> targets{
-            {{.format = (backend_name == "SDL3GPU" ? SLANG_SPIRV : SLANG_GLSL),
-              .profile = profile,
-              .compilerOptionEntries = compiler_options.data(),
-              .compilerOptionEntryCount = compiler_options.size()}}
-        };
-
-        constexpr std::array<const char*, 1> search_paths{{"Assets/Shaders/"}};
-
-        std::array<PreprocessorMacroDesc, 2> preprocessor_macros{
-            {{backend_name.data(), ""}, {"VERTEX", ""}}
-        };
-
-        const SessionDesc default_session_description{
-            .targets = targets.data(),
-            .targetCount = targets.size(),
-
-            .searchPaths = search_paths.data(),
-            .searchPathCount = search_paths.size(),
-
-            .preprocessorMacros = preprocessor_macros.data(),
-            .preprocessorMacroCount = preprocessor_macros.size(),
-        };
-        global_session->createSession(default_session_description, vertex_session.writeRef());
-
-        preprocessor_macros[1] = {"FRAGMENT", ""};
-        global_session->createSession(default_session_description, fragment_session.writeRef());
-    }
-
-    void CompileShader(const std::string& path)
+    /// @brief Compiles the first entry point of the stage in the shader file, unless it didn't change since it was last compiled.
+    /// @param stage_extension Added to the path of the shader file without its extension, before the extension of the backend.
+    /// @return False when the shader failed to compile.
+    bool CompileStage(ISession* session, const std::string& path, const SlangStage stage, const char* stage_extension)
     {
         Slang::ComPtr<IBlob> diagnostics;
 
-        Slang::ComPtr module{vertex_session->loadModule(path.c_str(), diagnostics.writeRef())};
-        if (TryLog(diagnostics)) return;
+        Slang::ComPtr module{session->loadModule(path.c_str(), diagnostics.writeRef())};
+        if (TryLog(diagnostics)) return false;
 
         const Renderer::BackendShaderInfo& backend_shader_info = Renderer::GetBackendShaderInfo();
-        const std::string new_path = path.substr(0, path.find_last_of('.'));
+        const std::string stage_path = path.substr(0, path.find_last_of('.')) + stage_extension + backend_shader_info.file_extension;
 
-        const std::string vertex_path = new_path + ".vert" + Renderer::GetBackendShaderInfo().file_extension;
-        const SlangInt32 vertex_session_entry_points = module->getDefinedEntryPointCount();
-        for (SlangInt32 i = 0; i < vertex_session_entry_points; i++)
+        const SlangInt32 entry_point_count = module->getDefinedEntryPointCount();
+        for (SlangInt32 i = 0; i < entry_point_count; i++)
         {
             // Get the entry point.
             Slang::ComPtr<IEntryPoint> entry_point;
             module->getDefinedEntryPoint(i, entry_point.writeRef());
 
             EntryPointReflection* entry_point_reflection = entry_point->getLayout()->getEntryPointByIndex(0);
-            if (entry_point_reflection->getStage() != SLANG_STAGE_VERTEX) continue;
+            if (entry_point_reflection->getStage() != stage) continue;
 
-            const std::string hash_file_path = vertex_path + ".hash";
+            const std::string hash_file_path = stage_path + ".hash";
 
             // Create a composite type to correctly compute the hash later.
             Slang::ComPtr<IComponentType> composite;
             IComponentType* components[2]{module, entry_point};
-            vertex_session->createCompositeComponentType(components, 2, composite.writeRef());
+            session->createCompositeComponentType(components, 2, composite.writeRef());
 
             // Compute hash.
             Slang::ComPtr<IBlob> hash;
             composite->getEntryPointHash(
                 0, 0, hash.writeRef()
             ); // We use entry point index 0 because the composite was only made with 1 entry point.
-            if (CompareShaderHash(hash_file_path, hash)) break;
+            if (CompareShaderHash(hash_file_path, hash)) return true;
 
-            Log::Log("Recompiling shader: {}", vertex_path);
+            Log::Log("Recompiling shader: {}", stage_path);
 
             const uint8* hash_data = static_cast<const uint8*>(hash->getBufferPointer());
             Files::WriteBinary(hash_file_path, {hash_data, hash->getBufferSize()});
@@ -119,84 +78,95 @@ namespace ShaderCompiler
             // Link/compile the shader.
             Slang::ComPtr<IComponentType> linked_entry_point;
             entry_point->link(linked_entry_point.writeRef(), diagnostics.writeRef());
-            if (TryLog(diagnostics)) return;
+            if (TryLog(diagnostics)) return false;
 
             // Get the shader data.
             Slang::ComPtr<IBlob> shader_stage_data;
             linked_entry_point->getEntryPointCode(0, 0, shader_stage_data.writeRef(), diagnostics.writeRef());
-            if (TryLog(diagnostics)) return;
+            if (TryLog(diagnostics)) return false;
 
             // Write the shader stage data to the file.
             if (backend_shader_info.binary)
             {
                 const uint8* shader_data = static_cast<const uint8*>(shader_stage_data->getBufferPointer());
-                Files::WriteBinary(vertex_path, {shader_data, shader_stage_data->getBufferSize()});
+                Files::WriteBinary(stage_path, {shader_data, shader_stage_data->getBufferSize()});
             }
             else
             {
                 const char* shader_text = static_cast<const char*>(shader_stage_data->getBufferPointer());
-                Files::WriteText(vertex_path, {shader_text, shader_stage_data->getBufferSize()});
+                Files::WriteText(stage_path, {shader_text, shader_stage_data->getBufferSize()});
             }
 
-            break;
+            return true;
         }
 
-        module = Slang::ComPtr{fragment_session->loadModule(path.c_str(), diagnostics.writeRef())};
-        if (diagnostics) Log::Log(static_cast<const char*>(diagnostics->getBufferPointer()));
+        return true;
+    }
 
-        const std::string fragment_path = new_path + ".frag" + Renderer::GetBackendShaderInfo().file_extension;
-        const SlangInt32 fragment_session_entry_points = module->getDefinedEntryPointCount();
-        for (SlangInt32 i = 0; i < fragment_session_entry_points; i++)
-        {
-            // Get the entry point.
-            Slang::ComPtr<IEntryPoint> entry_point;
-            module->getDefinedEntryPoint(i, entry_point.writeRef());
+} // namespace
 
-            EntryPointReflection* entry_point_reflection = entry_point->getLayout()->getEntryPointByIndex(0);
-            if (entry_point_reflection->getStage() != SLANG_STAGE_FRAGMENT) continue;
+namespace ShaderCompiler
+{
+    void Init()
+    {
+        SlangGlobalSessionDesc description{.enableGLSL = true};
+        createGlobalSession(&description, global_session.writeRef());
 
-            const std::string hash_file_path = fragment_path + ".hash";
+        const Renderer::BackendShaderInfo& backend_shader_info = Renderer::GetBackendShaderInfo();
+        const std::string& backend_name = Renderer::GetBackendName();
 
-            // Create a composite type to correctly compute the hash later.
-            Slang::ComPtr<IComponentType> composite;
-            IComponentType* components[2]{module, entry_point};
-            vertex_session->createCompositeComponentType(components, 2, composite.writeRef());
+        std::array<CompilerOptionEntry, 1> compiler_options{
+            {{CompilerOptionName::VulkanInvertY, {.intValue0 = backend_shader_info.invert_y}}}
+        };
+        const SlangProfileID profile = global_session->findProfile(backend_shader_info.profile);
+        const std::array<TargetDesc, 1> targets{
+            {{.format = (backend_name == "SDL3GPU" ? SLANG_SPIRV : SLANG_GLSL),
+              .profile = profile,
+              .compilerOptionEntries = compiler_options.data(),
+              .compilerOptionEntryCount = compiler_options.size()}}
+        };
 
-            // Compute hash.
-            Slang::ComPtr<IBlob> hash;
-            composite->getEntryPointHash(
-                0, 0, hash.writeRef()
-            ); // We use entry point index 0 because the composite was only made with 1 entry point.
-            if (CompareShaderHash(hash_file_path, hash)) break;
+        constexpr std::array<const char*, 1> search_paths{{"Assets/Shaders/"}};
 
-            Log::Log("Recompiling shader: {}", fragment_path);
+        std::array<PreprocessorMacroDesc, 2> preprocessor_macros{
+            {{backend_name.data(), ""}, {"VERTEX", ""}}
+        };
 
-            const uint8* hash_data = static_cast<const uint8*>(hash->getBufferPointer());
-            Files::WriteBinary(hash_file_path, {hash_data, hash->getBufferSize()});
+        const SessionDesc default_session_description{
+            .targets = targets.data(),
+            .targetCount = targets.size(),
 
-            // Link/compile the shader.
-            Slang::ComPtr<IComponentType> linked_entry_point;
-            entry_point->link(linked_entry_point.writeRef(), diagnostics.writeRef());
-            if (TryLog(diagnostics)) return;
+            .searchPaths = search_paths.data(),
+            .searchPathCount = search_paths.size(),
 
-            // Get the shader data.
-            Slang::ComPtr<IBlob> shader_stage_data;
-            linked_entry_point->getEntryPointCode(0, 0, shader_stage_data.writeRef(), diagnostics.writeRef());
-            if (TryLog(diagnostics)) return;
+            .preprocessorMacros = preprocessor_macros.data(),
+            .preprocessorMacroCount = preprocessor_macros.size(),
+        };
+        global_session->createSession(default_session_description, vertex_session.writeRef());
 
-            // Write the shader stage data to the file.
-            if (backend_shader_info.binary)
-            {
-                const uint8* shader_data = static_cast<const uint8*>(shader_stage_data->getBufferPointer());
-                Files::WriteBinary(fragment_path, {shader_data, shader_stage_data->getBufferSize()});
-            }
-            else
-            {
-                const char* shader_text = static_cast<const char*>(shader_stage_data->getBufferPointer());
-                Files::WriteText(fragment_path, {shader_text, shader_stage_data->getBufferSize()});
-            }
+        preprocessor_macros[1] = {"FRAGMENT", ""};
+        global_session->createSession(default_session_description, fragment_session.writeRef());
 
-            break;
-        }
+        // Compute shaders are compiled with their own profile, OpenGL only supports them from GLSL 4.30.
+        const std::array<TargetDesc, 1> compute_targets{
+            {{.format = targets[0].format,
+              .profile = global_session->findProfile(backend_shader_info.compute_profile),
+              .compilerOptionEntries = compiler_options.data(),
+              .compilerOptionEntryCount = compiler_options.size()}}
+        };
+
+        SessionDesc compute_session_description = default_session_description;
+        compute_session_description.targets = compute_targets.data();
+
+        preprocessor_macros[1] = {"COMPUTE", ""};
+        global_session->createSession(compute_session_description, compute_session.writeRef());
+    }
+
+    void CompileShader(const std::string& path)
+    {
+        PROFILE_ZONE("ShaderCompiler::CompileShader");
+        if (!CompileStage(vertex_session, path, SLANG_STAGE_VERTEX, ".vert")) return;
+        if (!CompileStage(fragment_session, path, SLANG_STAGE_FRAGMENT, ".frag")) return;
+        CompileStage(compute_session, path, SLANG_STAGE_COMPUTE, ".comp");
     }
 } // namespace ShaderCompiler
\ No newline at end of file
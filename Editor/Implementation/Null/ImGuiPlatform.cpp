@@ -0,0 +1,25 @@
+#include "ImGuiPlatform.hpp"
+
+#include "Core/Rendering/Renderer.hpp"
+#include "Core/Window.hpp"
+
+#include <SDL3/SDL_video.h>
+#include <backends/imgui_impl_sdl3.h>
+
+namespace ImGui
+{
+    PlatformNull::PlatformNull()
+    {
+        auto* window = static_cast<SDL_Window*>(Window::GetHandle());
+        ImGui_ImplSDL3_InitForOther(window);
+    }
+
+    PlatformNull::~PlatformNull() { ImGui_ImplSDL3_Shutdown(); }
+
+    void PlatformNull::NewFrame() {}
+
+    // Without a renderer backend ImGui doesn't create platform windows, so only the main viewport needs to be ended.
+    void PlatformNull::EndFrame() { Render(); }
+
+    ImTextureID PlatformNull::GetTextureID(RenderTarget& target) { return target.render_buffers[0].GetTexture()->texture.id; }
+} // namespace ImGui
\ No newline at end of file
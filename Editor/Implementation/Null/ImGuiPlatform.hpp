@@ -0,0 +1,19 @@
+#pragma once
+
+#include "Editor/ImGuiPlatform.hpp"
+
+namespace ImGui
+{
+    // Builds the UI every frame without drawing it, so the editor runs the same code as with a GPU backend.
+    class PlatformNull final : public Platform
+    {
+      public:
+        PlatformNull();
+        ~PlatformNull() override;
+
+        void NewFrame() override;
+        void EndFrame() override;
+
+        ImTextureID GetTextureID(RenderTarget& target) override;
+    };
+} // namespace ImGui
\ No newline at end of file
@@ -0,0 +1,42 @@
+#include "ImGuiPlatform.hpp"
+
+#include <Core/Rendering/Renderer.hpp>
+#include <Core/Window.hpp>
+#include <Platform/Software/Rendering/Renderer.hpp>
+
+#include <SDL3/SDL_render.h>
+
+#include <backends/imgui_impl_sdl3.h>
+#include <backends/imgui_impl_sdlrenderer3.h>
+
+namespace ImGui
+{
+    PlatformSoftware::PlatformSoftware()
+    {
+        auto* window = static_cast<SDL_Window*>(Window::GetHandle());
+        auto* renderer = static_cast<SDL_Renderer*>(Renderer::Instance().GetContext());
+
+        ImGui_ImplSDL3_InitForSDLRenderer(window, renderer);
+        ImGui_ImplSDLRenderer3_Init(renderer);
+    }
+
+    PlatformSoftware::~PlatformSoftware()
+    {
+        ImGui_ImplSDLRenderer3_Shutdown();
+        ImGui_ImplSDL3_Shutdown();
+    }
+
+    void PlatformSoftware::NewFrame() { ImGui_ImplSDLRenderer3_NewFrame(); }
+
+    // The SDL_Renderer backend doesn't support platform windows, so only the main viewport is drawn.
+    void PlatformSoftware::EndFrame()
+    {
+        Render();
+        ImGui_ImplSDLRenderer3_RenderDrawData(GetDrawData(), static_cast<SDL_Renderer*>(Renderer::Instance().GetContext()));
+    }
+
+    ImTextureID PlatformSoftware::GetTextureID(RenderTarget& target)
+    {
+        return reinterpret_cast<ImTextureID>(SoftwareRenderer::GetDisplayTexture(*target.render_buffers[0].GetTexture()));
+    }
+} // namespace ImGui
\ No newline at end of file
@@ -0,0 +1,19 @@
+#pragma once
+
+#include "Editor/ImGuiPlatform.hpp"
+
+namespace ImGui
+{
+    // Draws the UI with the software SDL_Renderer of the software backend, on top of the frame it presents.
+    class PlatformSoftware final : public Platform
+    {
+      public:
+        PlatformSoftware();
+        ~PlatformSoftware() override;
+
+        void NewFrame() override;
+        void EndFrame() override;
+
+        ImTextureID GetTextureID(RenderTarget& target) override;
+    };
+} // namespace ImGui
\ No newline at end of file